@@ -0,0 +1,64 @@
+#include "parser/facade.h"
+#include "synthesis/compiler.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Like what a judge gets: lots of tiny programs, each a bit different
+std::vector<std::string> make_submissions(int count) {
+  std::vector<std::string> submissions;
+
+  for (int i = 0; i < count; ++i) {
+    auto n = std::to_string(i % 97);
+    submissions.push_back("int n; read n;\n"
+                          "int total = 0;\n"
+                          "while (n > 0) { total += n * " +
+                          n +
+                          "; n -= 1; }\n"
+                          "write total;\n");
+  }
+
+  return submissions;
+}
+
+template <typename F> double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  const int count = 50000;
+  auto submissions = make_submissions(count);
+  std::size_t instructions = 0;
+
+  // A parser and a compiler for each
+  auto fresh_ms = time_ms([&]() {
+    for (auto &source : submissions) {
+      parser p(source);
+      auto result = p.parse();
+
+      compiler c;
+      instructions += c.compile(result.ast).code.size();
+    }
+  });
+
+  // The same ones for all
+  parser p("");
+  compiler c;
+
+  auto reused_ms = time_ms([&]() {
+    for (auto &source : submissions) {
+      p.reset(source);
+      auto result = p.parse();
+      instructions += c.compile(result.ast).code.size();
+    }
+  });
+
+  std::cout << count << " submissions, " << instructions / 2
+            << " instructions each time\n";
+  std::cout << "fresh:  " << fresh_ms * 1e3 / count << " us/submission\n";
+  std::cout << "reused: " << reused_ms * 1e3 / count << " us/submission\n";
+}
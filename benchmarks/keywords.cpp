@@ -0,0 +1,119 @@
+#include "parser/lex/keyword_table.h"
+#include "parser/lex/scanner.hpp"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Identifier-heavy source: lots of declarations and assignments, few keywords
+std::string make_source(int statements) {
+  std::string source;
+
+  for (int i = 0; i < statements; ++i) {
+    auto name = "value_" + std::to_string(i % 500);
+    source += "int " + name + "_" + std::to_string(i) + " = " + name +
+              " + other_" + std::to_string(i % 37) + ";\n";
+
+    if (i % 10 == 0) {
+      source += "while (" + name + " < limit) " + name + " += step;\n";
+    }
+  }
+
+  return source;
+}
+
+template <typename F> double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  auto source = make_source(100000);
+
+  // Every identifier and keyword, as the scanner sees them
+  std::vector<std::string> words;
+  {
+    yy::scanner scanner(source);
+    scanner.source = source;
+    scanner.init_default_keywords();
+
+    while (true) {
+      auto token = scanner.yylex();
+      auto kind = token.type_get();
+
+      if (kind == yy::parser::symbol_kind_type::S_YYEOF) {
+        break;
+      }
+
+      if (kind == yy::parser::symbol_kind_type::S_IDENTIFIER) {
+        words.emplace_back(token.value.as<symbol>().text());
+      } else if (kind == yy::parser::symbol_kind_type::S_WHILE) {
+        words.emplace_back("while");
+      }
+    }
+  }
+
+  std::map<std::string, keyword, std::less<>> old_map = {
+      {"if", keyword::IF},         {"else", keyword::ELSE},
+      {"while", keyword::WHILE},   {"return", keyword::RETURN},
+      {"goto", keyword::GOTO},     {"write", keyword::WRITE},
+      {"read", keyword::READ},     {"true", keyword::TRUE},
+      {"false", keyword::FALSE},
+  };
+
+  keyword_table table;
+  for (auto &[name, value] : old_map) {
+    table.set(symbol(name), value);
+  }
+
+  const int rounds = 20;
+  std::size_t map_found = 0;
+  std::size_t table_found = 0;
+
+  auto map_ms = time_ms([&]() {
+    for (int round = 0; round < rounds; ++round) {
+      for (auto &word : words) {
+        map_found += old_map.find(std::string_view(word)) != old_map.end();
+      }
+    }
+  });
+
+  // From the text too, so finding the name's symbol counts, as in the scanner
+  auto table_ms = time_ms([&]() {
+    for (int round = 0; round < rounds; ++round) {
+      for (auto &word : words) {
+        table_found += table.find(std::string_view(word)).has_value();
+      }
+    }
+  });
+
+  auto lookups = double(words.size()) * rounds;
+  std::cout << words.size() << " names\n";
+  std::cout << "std::map:      " << map_ms * 1e6 / lookups << " ns/lookup, "
+            << map_found << " keywords\n";
+  std::cout << "keyword_table: " << table_ms * 1e6 / lookups << " ns/lookup, "
+            << table_found << " keywords\n";
+
+  // And what it means for the whole scanner
+  std::size_t tokens = 0;
+  auto scan_ms = time_ms([&]() {
+    yy::scanner scanner(source);
+    scanner.source = source;
+    scanner.init_default_keywords();
+
+    while (scanner.yylex().type_get() !=
+           yy::parser::symbol_kind_type::S_YYEOF) {
+      ++tokens;
+    }
+  });
+
+  std::cout << "scanning:      " << tokens << " tokens in " << scan_ms
+            << " ms (" << source.size() / scan_ms / 1e3 << " MB/s)\n";
+
+  // How long changing a keyword takes
+  auto set_ms =
+      time_ms([&]() { table.set(symbol("enquanto"), keyword::WHILE); });
+  std::cout << "set_keyword:   " << set_ms * 1e3 << " us\n";
+}
@@ -0,0 +1,73 @@
+#include "parser/facade.h"
+#include "parser/literals.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename F> double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  // Like the generated data tables: numbers of every size
+  std::mt19937_64 random(7);
+  std::vector<std::string> integers;
+  std::vector<std::string> floats;
+
+  for (int i = 0; i < 1000000; ++i) {
+    integers.push_back(std::to_string(random() >> (1 + random() % 63)));
+    floats.push_back(std::to_string(double(random() % 100000) / 7.0));
+  }
+
+  std::uint64_t int_sum = 0;
+  double float_sum = 0;
+
+  auto stoll_ms = time_ms([&]() {
+    for (auto &text : integers) {
+      int_sum += std::stoll(text);
+    }
+  });
+
+  auto parse_int_ms = time_ms([&]() {
+    for (auto &text : integers) {
+      int_sum += parse_int(text).value();
+    }
+  });
+
+  auto stod_ms = time_ms([&]() {
+    for (auto &text : floats) {
+      float_sum += std::stod(text);
+    }
+  });
+
+  auto parse_float_ms = time_ms([&]() {
+    for (auto &text : floats) {
+      float_sum += parse_float(text).value();
+    }
+  });
+
+  auto per = 1e6 / integers.size();
+  std::cout << "(" << int_sum << ", " << float_sum << ")\n";
+  std::cout << "std::stoll:  " << stoll_ms * per << " ns/literal\n";
+  std::cout << "parse_int:   " << parse_int_ms * per << " ns/literal\n";
+  std::cout << "std::stod:   " << stod_ms * per << " ns/literal\n";
+  std::cout << "parse_float: " << parse_float_ms * per << " ns/literal\n";
+
+  // A whole table. Not too long, since statements nest
+  std::string source = "int x;\n";
+  for (int i = 0; i < 20000; ++i) {
+    source += "x = " + integers[i] + ";\n";
+  }
+
+  parser p(source);
+  bool success = false;
+  auto parse_ms = time_ms([&]() { success = p.parse().success; });
+
+  std::cout << "table:       " << source.size() / parse_ms / 1e3
+            << " MB/s parsed" << (success ? "" : " (failed)") << "\n";
+}
@@ -0,0 +1,122 @@
+#include "common/interner.h"
+#include <mutex>
+#include <stdexcept>
+
+interner::interner() { this->intern(""); }
+
+symbol_id interner::intern(std::string_view name) {
+  {
+    std::shared_lock lock(this->mutex);
+    auto found = this->ids.find(name);
+
+    if (found != this->ids.end()) {
+      return found->second;
+    }
+  }
+
+  std::unique_lock lock(this->mutex);
+
+  // Someone else may have added it in between
+  auto found = this->ids.find(name);
+  if (found != this->ids.end()) {
+    return found->second;
+  }
+
+  if (this->names.size() > UINT32_MAX) {
+    throw std::length_error("Too many names to intern.");
+  }
+
+  symbol_id id = this->names.size();
+  auto &stored = this->names.emplace_back(name);
+  this->ids.emplace(stored, id);
+  return id;
+}
+
+std::optional<symbol_id> interner::find(std::string_view name) const {
+  std::shared_lock lock(this->mutex);
+  auto found = this->ids.find(name);
+
+  if (found == this->ids.end()) {
+    return std::nullopt;
+  }
+
+  return found->second;
+}
+
+std::string_view interner::name(symbol_id id) const {
+  std::shared_lock lock(this->mutex);
+
+  if (id >= this->names.size()) {
+    throw std::out_of_range("No name interned as " + std::to_string(id));
+  }
+
+  return this->names[id];
+}
+
+std::size_t interner::size() const {
+  std::shared_lock lock(this->mutex);
+  return this->names.size();
+}
+
+interner &interner::global() {
+  static interner instance;
+  return instance;
+}
+
+symbol::symbol() : id(0) {}
+// Names the thread already saw, so that threads scanning at once don't all take
+// the global lock for every identifier. Views point into the global interner,
+// which never forgets them
+static std::unordered_map<std::string_view, symbol_id> &seen_by_thread() {
+  thread_local std::unordered_map<std::string_view, symbol_id> seen;
+  return seen;
+}
+
+symbol::symbol(std::string_view name) {
+  auto &seen = seen_by_thread();
+
+  auto found = seen.find(name);
+  if (found != seen.end()) {
+    this->id = found->second;
+    return;
+  }
+
+  auto &names = interner::global();
+  this->id = names.intern(name);
+  seen.emplace(names.name(this->id), this->id);
+}
+symbol::symbol(const std::string &name) : symbol(std::string_view(name)) {}
+symbol::symbol(const char *name) : symbol(std::string_view(name)) {}
+
+symbol symbol::from_id(symbol_id id) {
+  symbol s;
+  s.id = id;
+  return s;
+}
+
+std::optional<symbol> symbol::find(std::string_view name) {
+  auto &seen = seen_by_thread();
+
+  auto found = seen.find(name);
+  if (found != seen.end()) {
+    return from_id(found->second);
+  }
+
+  auto &names = interner::global();
+  auto id = names.find(name);
+
+  if (!id.has_value()) {
+    return std::nullopt;
+  }
+
+  seen.emplace(names.name(id.value()), id.value());
+  return from_id(id.value());
+}
+
+std::string_view symbol::text() const {
+  return interner::global().name(this->id);
+}
+
+std::ostream &operator<<(std::ostream &o, const symbol &a) {
+  return o << a.text();
+}
@@ -0,0 +1,78 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+typedef std::uint32_t symbol_id;
+
+// Gives every distinct name a small number, once, so that everything after the
+// scanner compares and looks up integers instead of strings. Names are never
+// forgotten. Safe to share between threads
+class interner {
+private:
+  mutable std::shared_mutex mutex;
+
+  // Views into `names`, which doesn't move its strings when it grows
+  std::unordered_map<std::string_view, symbol_id> ids;
+  std::deque<std::string> names;
+
+public:
+  interner();
+
+  symbol_id intern(std::string_view name);
+
+  // Empty if never interned
+  std::optional<symbol_id> find(std::string_view name) const;
+  std::string_view name(symbol_id id) const;
+
+  std::size_t size() const;
+
+  // The one used by `symbol`
+  static interner &global();
+};
+
+// A name interned in the global interner. Compares by id, so maps of symbols
+// are ordered by when each name was first seen, not alphabetically.
+//
+// The global interner is never freed, so every name made into a symbol stays
+// for as long as the process does. Lookups of names that may not be anywhere,
+// like keywords or variables, should go through `find`, which adds nothing
+class symbol {
+private:
+  symbol_id id;
+
+public:
+  // The empty name
+  symbol();
+  explicit symbol(std::string_view name);
+  explicit symbol(const std::string &name);
+  explicit symbol(const char *name);
+
+  static symbol from_id(symbol_id id);
+  // Empty if never interned, in which case nothing can be named it
+  static std::optional<symbol> find(std::string_view name);
+
+  symbol_id get_id() const { return this->id; }
+  std::string_view text() const;
+
+  bool operator==(const symbol &other) const = default;
+  auto operator<=>(const symbol &other) const = default;
+
+  friend std::ostream &operator<<(std::ostream &o, const symbol &a);
+};
+
+template <> struct std::hash<symbol> {
+  std::size_t operator()(const symbol &s) const noexcept {
+    return std::hash<symbol_id>()(s.get_id());
+  }
+};
+
+#endif /* INTERNER_H */
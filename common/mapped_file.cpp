@@ -0,0 +1,96 @@
+#include "common/mapped_file.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+static std::system_error last_error(const std::string &what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+static std::string read_all(int fd) {
+  std::string contents;
+  char buffer[65536];
+
+  while (true) {
+    auto count = read(fd, buffer, sizeof(buffer));
+
+    if (count == 0) {
+      return contents;
+    }
+
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throw last_error("Couldn't read file");
+    }
+
+    contents.append(buffer, count);
+  }
+}
+
+mapped_file::mapped_file(int fd) : data(nullptr), size(0), mapped(false) {
+  struct stat info;
+
+  if (fstat(fd, &info) != 0) {
+    throw last_error("Couldn't look at file");
+  }
+
+  // Their size is 0, or not there at all
+  if (!S_ISREG(info.st_mode)) {
+    this->contents = read_all(fd);
+    this->data = this->contents.data();
+    this->size = this->contents.size();
+    return;
+  }
+
+  this->size = info.st_size;
+
+  // Can't map nothing. Not null either, which RE-flex would read stdin for
+  if (this->size == 0) {
+    this->data = "";
+    return;
+  }
+
+  auto mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (mapped == MAP_FAILED) {
+    throw last_error("Couldn't map file");
+  }
+
+  // It's read from start to end, once
+  madvise(mapped, this->size, MADV_SEQUENTIAL);
+
+  this->data = static_cast<const char *>(mapped);
+  this->mapped = true;
+}
+
+// Closed once the mapping is done with it
+struct opened_file {
+  int fd;
+
+  opened_file(const std::string &path) : fd(open(path.c_str(), O_RDONLY)) {
+    if (this->fd < 0) {
+      throw last_error("Couldn't open " + path);
+    }
+  }
+
+  ~opened_file() { close(this->fd); }
+};
+
+mapped_file::mapped_file(const std::string &path)
+    : mapped_file(opened_file(path).fd) {}
+
+mapped_file::~mapped_file() {
+  if (this->mapped) {
+    munmap(const_cast<char *>(this->data), this->size);
+  }
+}
+
+std::string_view mapped_file::view() const {
+  return std::string_view(this->data, this->size);
+}
@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// A whole file mapped read-only into memory, for reading big sources without
+// copying them. Throws `std::system_error` if the file can't be mapped.
+//
+// Pipes, terminals and the like can't be mapped, and don't know their size
+// up front, so those are read until their end instead
+class mapped_file {
+private:
+  const char *data;
+  std::size_t size;
+  // What was read, when it couldn't be mapped
+  std::string contents;
+  bool mapped;
+
+public:
+  mapped_file(const std::string &path);
+  // Doesn't take ownership of `fd`, which can be closed right after
+  mapped_file(int fd);
+  ~mapped_file();
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  std::string_view view() const;
+};
+
+#endif /* MAPPED_FILE_H */
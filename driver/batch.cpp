@@ -0,0 +1,98 @@
+#include "driver/batch.h"
+#include "common/mapped_file.h"
+#include "parser/facade.h"
+#include "synthesis/compiler.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+
+batch_compiler::batch_compiler(std::size_t thread_count)
+    : pool(thread_count) {}
+
+// `reset` gives `p` the source to compile
+template <typename F>
+static void compile_one(parser &p, compiler &c, compile_result &result,
+                        F reset) {
+  try {
+    reset();
+    auto parsed = p.parse();
+
+    result.success = parsed.success;
+    result.message = parsed.message;
+
+    if (parsed.success) {
+      result.prog = c.compile(parsed.ast);
+    }
+  } catch (std::exception &e) {
+    result.success = false;
+    result.message = e.what();
+  }
+}
+
+// Instead of a task per source, one per thread, each taking the next source
+// until there's none left, so that parsers and compilers are made only once
+template <typename F>
+static void for_each_index(work_stealing_pool &pool, std::size_t count,
+                           F compile) {
+  std::atomic<std::size_t> next = 0;
+  auto workers = std::min(pool.thread_count() + 1, count);
+
+  for (std::size_t i = 0; i < workers; ++i) {
+    pool.submit([&next, count, &compile]() {
+      parser p("");
+      compiler c;
+
+      for (auto at = next++; at < count; at = next++) {
+        compile(p, c, at);
+      }
+    });
+  }
+
+  pool.wait();
+}
+
+std::vector<compile_result>
+batch_compiler::compile(const std::vector<std::string> &sources) {
+  std::vector<compile_result> results(sources.size());
+
+  for_each_index(this->pool, sources.size(),
+                 [&](parser &p, compiler &c, std::size_t i) {
+                   compile_one(p, c, results[i],
+                               [&]() { p.reset(sources[i]); });
+                 });
+
+  return results;
+}
+
+std::vector<compile_result>
+batch_compiler::compile_files(const std::vector<std::string> &paths) {
+  std::vector<compile_result> results(paths.size());
+
+  // Files that can't be mapped fail like any other source
+  for_each_index(this->pool, paths.size(),
+                 [&](parser &p, compiler &c, std::size_t i) {
+                   compile_one(p, c, results[i], [&]() {
+                     p.reset(std::make_unique<mapped_file>(paths[i]),
+                             paths[i]);
+                   });
+                 });
+
+  return results;
+}
+
+std::size_t batch_compiler::thread_count() {
+  return this->pool.thread_count();
+}
+
+std::vector<std::string> files_in(const std::string &directory) {
+  std::vector<std::string> paths;
+
+  for (auto &entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.is_regular_file()) {
+      paths.push_back(entry.path().string());
+    }
+  }
+
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
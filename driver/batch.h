@@ -0,0 +1,39 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "synthesis/program.h"
+#include "vm/thread_pool.h"
+#include <string>
+#include <vector>
+
+struct compile_result {
+  bool success;
+  // Why it failed, from the parser or the compiler
+  std::string message;
+  program prog;
+};
+
+// Parses and compiles many sources at once over a pool of threads, such as
+// every submission to a problem. Each thread keeps one parser and one compiler
+// and reuses them for every source it takes
+class batch_compiler {
+private:
+  work_stealing_pool pool;
+
+public:
+  batch_compiler(std::size_t thread_count = default_thread_count());
+
+  // One result for each source, in the same order
+  std::vector<compile_result> compile(const std::vector<std::string> &sources);
+  // Same, reading each file on the thread that compiles it. Locations refer to
+  // the paths
+  std::vector<compile_result>
+  compile_files(const std::vector<std::string> &paths);
+
+  std::size_t thread_count();
+};
+
+// The regular files in `directory`, sorted by path
+std::vector<std::string> files_in(const std::string &directory);
+
+#endif /* BATCH_H */
@@ -8,6 +8,8 @@ std::ostream &operator<<(std::ostream &o, const ast_node_kind &a) {
   return o << static_cast<std::underlying_type_t<ast_node_kind>>(a);
 }
 
+static type_context &types() { return type_context::global(); }
+
 std::string name_of_ast_node_kind(ast_node_kind kind) {
   return ast_kind_names[(size_t)kind];
 }
@@ -17,12 +19,13 @@ ast_node::ast_node(ast_node_kind kind, std::shared_ptr<type> typ,
     : kind(kind), typ(typ), location(location) {}
 
 ast_node::ast_node(ast_node_kind kind, yy::location location)
-    : kind(kind), typ(std::make_shared<type_void>()), location(location) {}
+    : kind(kind), typ(types().void_type()), location(location) {}
 
+// Up to the children, or all of it if there are none
 std::ostream &ast_node::extract(std::ostream &o) const {
   o << ast_kind_names[(size_t)this->kind];
 
-  if (!std::make_shared<type_void>()->matches(*this->typ)) {
+  if (!this->typ->matches(*types().void_type())) {
     o << "[" << *this->typ << "]";
   }
 
@@ -30,51 +33,74 @@ std::ostream &ast_node::extract(std::ostream &o) const {
 
   if (this->children.size() == 0) {
     o << ")";
-    return o;
-  }
-
-  auto first = this->children[0];
-  o << *first;
-
-  for (auto child = this->children.begin() + 1; child < this->children.end();
-       ++child) {
-    o << ", " << **child;
   }
 
-  o << ")";
   return o;
 }
 
+// Only the node itself, the children are compared by `operator==`
 bool ast_node::equals(const ast_node &other) const {
-  if (this->kind != other.kind) {
-    return false;
-  }
+  return this->kind == other.kind && this->typ->kind == other.typ->kind;
+}
 
-  if (this->typ->kind != other.typ->kind) {
-    return false;
-  }
+// Both of these go through a stack of their own rather than recursing, since
+// trees can be as deep as the source nests
+bool ast_node::operator==(const ast_node &other) const {
+  std::vector<std::pair<const ast_node *, const ast_node *>> pending{
+      {this, &other}};
 
-  if (this->children.size() != other.children.size()) {
-    return false;
-  }
+  while (!pending.empty()) {
+    auto [a, b] = pending.back();
+    pending.pop_back();
 
-  for (size_t i = 0; i < this->children.size(); ++i) {
-    auto this_child = *this->children[i];
-    auto that_child = *other.children[i];
-
-    if (this_child != that_child) {
+    if (a->children.size() != b->children.size() || !a->equals(*b)) {
       return false;
     }
+
+    for (size_t i = 0; i < a->children.size(); ++i) {
+      pending.push_back({a->children[i], b->children[i]});
+    }
   }
 
   return true;
 }
 
-bool ast_node::operator==(const ast_node &other) const { return equals(other); }
-
 // `extract` is virtual so the correct implementatian will be chosen at runtime
 std::ostream &operator<<(std::ostream &o, const ast_node &a) {
-  return a.extract(o);
+  struct pending {
+    const ast_node *node;
+    // How many children are printed already
+    size_t printed;
+  };
+
+  std::vector<pending> stack{{&a, 0}};
+
+  while (!stack.empty()) {
+    auto &top = stack.back();
+    auto node = top.node;
+
+    if (top.printed == 0) {
+      node->extract(o);
+    }
+
+    if (top.printed == node->children.size()) {
+      if (top.printed > 0) {
+        o << ")";
+      }
+
+      stack.pop_back();
+      continue;
+    }
+
+    if (top.printed > 0) {
+      o << ", ";
+    }
+
+    auto child = node->children[top.printed++];
+    stack.push_back({child, 0});
+  }
+
+  return o;
 }
 
 #define AST_NODE_IMPL_EXPR_LEAF(Name, Kind, Type, Member1Type, Member1Name)    \
@@ -99,21 +125,20 @@ std::ostream &operator<<(std::ostream &o, const ast_node &a) {
   }
 
 #define AST_NODE_IMPL_EXPR_1(Name, Kind, Type)                                 \
-  Name::Name(std::shared_ptr<ast_node> child1, yy::location location)          \
+  Name::Name(ast_node *child1, yy::location location)                          \
       : ast_node(ast_node_kind::Kind, location) {                              \
     this->children.push_back(child1);                                          \
     this->typ = Type;                                                          \
   }
 
 #define AST_NODE_IMPL_STMT_1(Name, Kind)                                       \
-  Name::Name(std::shared_ptr<ast_node> child1, yy::location location)          \
+  Name::Name(ast_node *child1, yy::location location)                          \
       : ast_node(ast_node_kind::Kind, location) {                              \
     this->children.push_back(child1);                                          \
   }
 
 #define AST_NODE_IMPL_EXPR_2(Name, Kind, Type)                                 \
-  Name::Name(std::shared_ptr<ast_node> child1,                                 \
-             std::shared_ptr<ast_node> child2, yy::location location)          \
+  Name::Name(ast_node *child1, ast_node *child2, yy::location location)        \
       : ast_node(ast_node_kind::Kind, location) {                              \
     this->children.push_back(child1);                                          \
     this->children.push_back(child2);                                          \
@@ -121,17 +146,15 @@ std::ostream &operator<<(std::ostream &o, const ast_node &a) {
   }
 
 #define AST_NODE_IMPL_STMT_2(Name, Kind)                                       \
-  Name::Name(std::shared_ptr<ast_node> child1,                                 \
-             std::shared_ptr<ast_node> child2, yy::location location)          \
+  Name::Name(ast_node *child1, ast_node *child2, yy::location location)        \
       : ast_node(ast_node_kind::Kind, location) {                              \
     this->children.push_back(child1);                                          \
     this->children.push_back(child2);                                          \
   }
 
 #define AST_NODE_IMPL_STMT_3(Name, Kind)                                       \
-  Name::Name(std::shared_ptr<ast_node> child1,                                 \
-             std::shared_ptr<ast_node> child2,                                 \
-             std::shared_ptr<ast_node> child3, yy::location location)          \
+  Name::Name(ast_node *child1, ast_node *child2, ast_node *child3,             \
+             yy::location location)                                            \
       : ast_node(ast_node_kind::Kind, location) {                              \
     this->children.push_back(child1);                                          \
     this->children.push_back(child2);                                          \
@@ -139,7 +162,7 @@ std::ostream &operator<<(std::ostream &o, const ast_node &a) {
   }
 
 noop_node::noop_node(yy::location location)
-    : ast_node(ast_node_kind::NOOP, std::make_shared<type_void>(), location) {}
+    : ast_node(ast_node_kind::NOOP, types().void_type(), location) {}
 
 AST_NODE_IMPL_EXPR_LEAF(var_identifier_node, VAR_IDENTIFIER, entry->type->value,
                         var_table_entry *, entry);
@@ -164,58 +187,56 @@ AST_NODE_IMPL_EXTRACT(type_identifier_node, "TYPE_IDENTIFIER("
 AST_NODE_IMPL_EQUALS(type_identifier_node, entry->name == other.entry->name);
 
 AST_NODE_IMPL_EXPR_LEAF(int_literal_node, INT_LITERAL,
-                        std::make_shared<type_int>(), std::int64_t, value);
+                        types().int_type(), std::int64_t, value);
 AST_NODE_IMPL_EXTRACT(int_literal_node,
                       "INT_LITERAL[" << *typ << "](" << value << ")");
 AST_NODE_IMPL_EQUALS(int_literal_node, value == other.value);
 
 AST_NODE_IMPL_EXPR_LEAF(float_literal_node, FLOAT_LITERAL,
-                        std::make_shared<type_float>(), double, value);
+                        types().float_type(), double, value);
 AST_NODE_IMPL_EXTRACT(float_literal_node,
                       "FLOAT_LITERAL[" << *typ << "](" << value << ")");
 AST_NODE_IMPL_EQUALS(float_literal_node, value == other.value);
 
 AST_NODE_IMPL_EXPR_LEAF(boolean_literal_node, BOOLEAN_LITERAL,
-                        std::make_shared<type_boolean>(), bool, value);
+                        types().boolean_type(), bool, value);
 AST_NODE_IMPL_EXTRACT(boolean_literal_node,
                       "BOOLEAN_LITERAL[" << *typ << "](" << value << ")");
 AST_NODE_IMPL_EQUALS(boolean_literal_node, value == other.value);
 
 AST_NODE_IMPL_EXPR_LEAF(char_literal_node, CHAR_LITERAL,
-                        std::make_shared<type_char>(), char, value);
+                        types().char_type(), char, value);
 AST_NODE_IMPL_EXTRACT(char_literal_node,
                       "CHAR_LITERAL[" << *typ << "](" << value << ")");
 AST_NODE_IMPL_EQUALS(char_literal_node, value == other.value);
 
-AST_NODE_IMPL_EXPR_LEAF(
-    string_literal_node, STRING_LITERAL,
-    std::make_shared<type_pointer>(std::make_shared<type_char>()), std::string,
-    value);
+AST_NODE_IMPL_EXPR_LEAF(string_literal_node, STRING_LITERAL,
+                        types().pointer_to(types().char_type()), std::string,
+                        value);
 AST_NODE_IMPL_EXTRACT(string_literal_node,
                       "CHAR_LITERAL[" << *typ << "](" << value << ")");
 AST_NODE_IMPL_EQUALS(string_literal_node, value == other.value);
 
 AST_NODE_IMPL_EXPR_1(int_to_float_coercion_node, INT_TO_FLOAT_COERCION,
-                     std::make_shared<type_float>());
+                     types().float_type());
 
 AST_NODE_IMPL_EXPR_1(int_to_boolean_coercion_node, INT_TO_BOOLEAN_COERCION,
-                     std::make_shared<type_boolean>());
+                     types().boolean_type());
 
 AST_NODE_IMPL_EXPR_1(boolean_to_int_coercion_node, BOOLEAN_TO_INT_COERCION,
-                     std::make_shared<type_int>());
+                     types().int_type());
 
 AST_NODE_IMPL_EXPR_1(pointer_to_boolean_coercion_node,
                      POINTER_TO_BOOLEAN_COERCION,
-                     std::make_shared<type_boolean>());
+                     types().boolean_type());
 
-std::shared_ptr<type>
-determine_unary_op_type_arithmetic(std::shared_ptr<ast_node> operand) {
+std::shared_ptr<type> determine_unary_op_type_arithmetic(ast_node *operand) {
   return operand->typ;
 }
 
-std::shared_ptr<type> determine_unary_op_type_integral_then_boolean(
-    std::shared_ptr<ast_node> operand) {
-  return std::make_shared<type_boolean>();
+std::shared_ptr<type>
+determine_unary_op_type_integral_then_boolean(ast_node *operand) {
+  return types().boolean_type();
 }
 
 AST_NODE_IMPL_EXPR_1(unary_minus_node, UNARY_MINUS,
@@ -226,8 +247,8 @@ AST_NODE_IMPL_EXPR_1(unary_plus_node, UNARY_PLUS,
 AST_NODE_IMPL_EXPR_1(not_node, NOT,
                      determine_unary_op_type_integral_then_boolean(child1));
 
-block_node::block_node(std::shared_ptr<symbol_table> table,
-                       std::shared_ptr<ast_node> body, yy::location location)
+block_node::block_node(std::shared_ptr<symbol_table> table, ast_node *body,
+                       yy::location location)
     : table(table), ast_node(ast_node_kind::BLOCK, location) {
   this->children.push_back(body);
 }
@@ -235,23 +256,21 @@ block_node::block_node(std::shared_ptr<symbol_table> table,
 std::ostream &block_node::extract(std::ostream &o) const {
   return o << "BLOCK("
            << "<" << table->size() << " SYMBOLS>"
-           << ", " << *this->children[0] << ")";
+           << ", ";
 }
 
 bool block_node::equals(const ast_node &other) const {
   // Does not check the symbol table, again for convenience.
-  return *this->children[0] == *other.children[0];
+  return other.kind == this->kind;
 }
 
-std::shared_ptr<type>
-determine_bin_op_type_arithmetic(std::shared_ptr<ast_node> left,
-                                 std::shared_ptr<ast_node> right) {
+std::shared_ptr<type> determine_bin_op_type_arithmetic(ast_node *left,
+                                                       ast_node *right) {
   return left->typ;
 }
 
-std::shared_ptr<type>
-determine_bin_op_type_integral(std::shared_ptr<ast_node> left,
-                               std::shared_ptr<ast_node> right) {
+std::shared_ptr<type> determine_bin_op_type_integral(ast_node *left,
+                                                     ast_node *right) {
   return left->typ;
 }
 
@@ -266,14 +285,14 @@ AST_NODE_IMPL_EXPR_2(division_node, DIVISION,
 AST_NODE_IMPL_EXPR_2(modulo_node, MODULO,
                      determine_bin_op_type_integral(child1, child2));
 
-AST_NODE_IMPL_EXPR_2(lt_node, LT, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(gt_node, GT, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(lteq_node, LTEQ, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(gteq_node, GTEQ, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(equals_node, EQUALS, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(nequals_node, NEQUALS, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(and_node, AND, std::make_shared<type_boolean>());
-AST_NODE_IMPL_EXPR_2(or_node, OR, std::make_shared<type_boolean>());
+AST_NODE_IMPL_EXPR_2(lt_node, LT, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(gt_node, GT, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(lteq_node, LTEQ, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(gteq_node, GTEQ, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(equals_node, EQUALS, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(nequals_node, NEQUALS, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(and_node, AND, types().boolean_type());
+AST_NODE_IMPL_EXPR_2(or_node, OR, types().boolean_type());
 
 AST_NODE_IMPL_EXPR_2(assignment_node, ASSIGNMENT, child2->typ);
 AST_NODE_IMPL_EXPR_2(sum_assignment_node, SUM_ASSIGNMENT, child2->typ);
@@ -295,11 +314,11 @@ AST_NODE_IMPL_STMT_1(statement_node, STATEMENT);
 AST_NODE_IMPL_STMT_3(conditional_node, CONDITIONAL);
 AST_NODE_IMPL_STMT_2(while_loop_node, WHILE);
 
-AST_NODE_IMPL_STMT_LEAF(label_node, LABEL, std::string, value);
+AST_NODE_IMPL_STMT_LEAF(label_node, LABEL, symbol, value);
 AST_NODE_IMPL_EXTRACT(label_node, "LABEL(" << this->value << ")");
 AST_NODE_IMPL_EQUALS(label_node, this->value == other.value);
 
-AST_NODE_IMPL_STMT_LEAF(goto_node, GOTO, std::string, value);
+AST_NODE_IMPL_STMT_LEAF(goto_node, GOTO, symbol, value);
 AST_NODE_IMPL_EXTRACT(goto_node, "GOTO(" << this->value << ")");
 AST_NODE_IMPL_EQUALS(goto_node, this->value == other.value);
 
@@ -3,6 +3,7 @@
 
 #include "parser/symbol_table.h"
 #include "parser/types.h"
+#include <array>
 #include <cstdint>
 #include <iostream>
 #include <memory>
@@ -73,20 +74,42 @@ std::string name_of_ast_node_kind(ast_node_kind kind);
 
 std::ostream &operator<<(std::ostream &o, const ast_node_kind &a);
 
+class ast_node;
+
+// No node has more than three, so they fit in the node itself
+class ast_children {
+private:
+  std::array<ast_node *, 3> nodes;
+  std::size_t count = 0;
+
+public:
+  void push_back(ast_node *child) { this->nodes[this->count++] = child; }
+  void set(std::size_t i, ast_node *child) { this->nodes[i] = child; }
+  std::size_t size() const { return this->count; }
+  ast_node *operator[](std::size_t i) const { return this->nodes[i]; }
+
+  ast_node *const *begin() const { return this->nodes.data(); }
+  ast_node *const *end() const { return this->nodes.data() + this->count; }
+};
+
+// Nodes are made in an `ast_arena` (see parser/ast_arena.h), which owns them.
+// They only point to each other
 class ast_node {
 private:
+  // Each only for the node itself. The operators below do the children
   virtual std::ostream &extract(std::ostream &o) const;
   virtual bool equals(const ast_node &other) const;
 
 public:
   const ast_node_kind kind;
   std::shared_ptr<type> typ;
-  std::vector<std::shared_ptr<ast_node>> children;
+  ast_children children;
   yy::location location;
 
   ast_node(ast_node_kind kind, std::shared_ptr<type> typ,
            yy::location location);
   ast_node(ast_node_kind kind, yy::location location);
+  virtual ~ast_node() = default;
 
   bool operator==(const ast_node &other) const;
   friend std::ostream &operator<<(std::ostream &o, const ast_node &a);
@@ -112,21 +135,20 @@ public:
 #define AST_NODE_1(Name)                                                       \
   class Name : public ast_node {                                               \
   public:                                                                      \
-    Name(std::shared_ptr<ast_node> child1, yy::location location);             \
+    Name(ast_node *child1, yy::location location);                             \
   }
 
 #define AST_NODE_2(Name)                                                       \
   class Name : public ast_node {                                               \
   public:                                                                      \
-    Name(std::shared_ptr<ast_node> child1, std::shared_ptr<ast_node> child2,   \
-         yy::location location);                                               \
+    Name(ast_node *child1, ast_node *child2, yy::location location);           \
   }
 
 #define AST_NODE_3(Name)                                                       \
   class Name : public ast_node {                                               \
   public:                                                                      \
-    Name(std::shared_ptr<ast_node> child1, std::shared_ptr<ast_node> child2,   \
-         std::shared_ptr<ast_node> child3, yy::location location);             \
+    Name(ast_node *child1, ast_node *child2, ast_node *child3,                 \
+         yy::location location);                                               \
   }
 
 AST_NODE_0(noop_node);
@@ -158,8 +180,8 @@ private:
 public:
   std::shared_ptr<symbol_table> table;
 
-  block_node(std::shared_ptr<symbol_table> table,
-             std::shared_ptr<ast_node> body, yy::location location);
+  block_node(std::shared_ptr<symbol_table> table, ast_node *body,
+             yy::location location);
 };
 
 AST_NODE_2(sum_node);
@@ -193,8 +215,8 @@ AST_NODE_1(statement_node);
 AST_NODE_2(while_loop_node);
 AST_NODE_3(conditional_node);
 
-AST_NODE_LEAF(label_node, std::string value);
-AST_NODE_LEAF(goto_node, std::string value);
+AST_NODE_LEAF(label_node, symbol value);
+AST_NODE_LEAF(goto_node, symbol value);
 
 AST_NODE_1(write_node);
 AST_NODE_1(read_node);
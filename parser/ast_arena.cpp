@@ -0,0 +1,56 @@
+#include "parser/ast_arena.h"
+#include <algorithm>
+#include <cstdint>
+
+const std::size_t first_block_size = 64 * 1024;
+const std::size_t max_block_size = 16 * 1024 * 1024;
+
+ast_arena::ast_arena()
+    : next(nullptr), left(0), next_block_size(first_block_size) {}
+
+ast_arena::~ast_arena() { this->clear(); }
+
+void ast_arena::clear() {
+  // Nodes don't own each other, so the order doesn't matter and there's no
+  // recursion, however deep the tree
+  for (auto node : this->nodes) {
+    node->~ast_node();
+  }
+
+  this->nodes.clear();
+
+  if (this->blocks.empty()) {
+    return;
+  }
+
+  // The later ones are bigger, but most trees fit in the first
+  this->blocks.resize(1);
+  this->next = this->blocks[0].get();
+  this->left = first_block_size;
+  this->next_block_size = first_block_size * 2;
+}
+
+void *ast_arena::allocate(std::size_t size, std::size_t alignment) {
+  auto address = reinterpret_cast<std::uintptr_t>(this->next);
+  auto padding = (alignment - address % alignment) % alignment;
+
+  if (this->next == nullptr || padding + size > this->left) {
+    auto block_size = std::max(this->next_block_size, size + alignment);
+    this->blocks.emplace_back(new std::byte[block_size]);
+    this->next = this->blocks.back().get();
+    this->left = block_size;
+    this->next_block_size = std::min(this->next_block_size * 2, max_block_size);
+
+    address = reinterpret_cast<std::uintptr_t>(this->next);
+    padding = (alignment - address % alignment) % alignment;
+  }
+
+  auto memory = this->next + padding;
+  this->next += padding + size;
+  this->left -= padding + size;
+  return memory;
+}
+
+std::size_t ast_arena::size() const { return this->nodes.size(); }
+
+std::size_t ast_arena::block_count() const { return this->blocks.size(); }
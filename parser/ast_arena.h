@@ -0,0 +1,56 @@
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include "parser/ast.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Where the nodes of a tree live. They are bumped one after the other into a
+// few big blocks, and all of them go away with the arena at once
+class ast_arena {
+private:
+  std::vector<std::unique_ptr<std::byte[]>> blocks;
+  std::byte *next;
+  std::size_t left;
+  std::size_t next_block_size;
+
+  // Nodes still own their types and strings, so their destructors have to run
+  std::vector<ast_node *> nodes;
+
+  void *allocate(std::size_t size, std::size_t alignment);
+
+public:
+  ast_arena();
+  ~ast_arena();
+
+  ast_arena(const ast_arena &) = delete;
+  ast_arena &operator=(const ast_arena &) = delete;
+
+  template <typename Node, typename... Args> Node *make(Args &&...args) {
+    auto memory = this->allocate(sizeof(Node), alignof(Node));
+
+    // Made room for first, so that a node is never left without its destructor
+    this->nodes.push_back(nullptr);
+
+    try {
+      auto node = new (memory) Node(std::forward<Args>(args)...);
+      this->nodes.back() = node;
+      return node;
+    } catch (...) {
+      this->nodes.pop_back();
+      throw;
+    }
+  }
+
+  // Destroys every node but keeps the first block, for making another tree
+  void clear();
+
+  // How many nodes it has
+  std::size_t size() const;
+  std::size_t block_count() const;
+};
+
+#endif /* AST_ARENA_H */
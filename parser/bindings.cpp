@@ -5,6 +5,11 @@
 
 using namespace emscripten;
 
+// Keeps the whole arena alive for as long as JS holds on to the root
+std::shared_ptr<ast_node> root_of(const parse_result &result) {
+  return std::shared_ptr<ast_node>(result.arena, result.ast);
+}
+
 EMSCRIPTEN_BINDINGS(ast) {
   class_<ast_node>("AstNode")
       .property("kind", &ast_node::kind)
@@ -13,7 +18,7 @@ EMSCRIPTEN_BINDINGS(ast) {
   class_<parse_result>("ParseResult")
       .property("success", &parse_result::success)
       .property("message", &parse_result::message)
-      .property("ast", &parse_result::ast);
+      .property("ast", &root_of);
 
   enum_<keyword>("Keyword")
       .value("If", keyword::IF)
@@ -29,6 +34,19 @@ EMSCRIPTEN_BINDINGS(ast) {
       .constructor<std::string>()
       .function("parse", &parser::parse)
       .function("setKeyword", &parser::set_keyword);
+
+  value_object<statement_change>("StatementChange")
+      .field("full", &statement_change::full)
+      .field("first", &statement_change::first)
+      .field("removed", &statement_change::removed)
+      .field("inserted", &statement_change::inserted);
+
+  class_<incremental_parser>("IncrementalParser")
+      .constructor<std::string>()
+      .function("edit", &incremental_parser::edit)
+      .function("parse", &incremental_parser::parse)
+      .function("lastChange", &incremental_parser::last_change)
+      .function("setKeyword", &incremental_parser::set_keyword);
 }
 
 #endif
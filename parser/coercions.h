@@ -1,58 +1,44 @@
 #ifndef COERCIONS_H
 #define COERCIONS_H
 
-#include "parser/ast.h"
+#include "parser/ast_arena.h"
 
 bool can_coerce_to(type &t1, type &t2);
 
-std::shared_ptr<ast_node>
-coerced_conditional(std::shared_ptr<ast_node> condition,
-                    std::shared_ptr<ast_node> if_body,
-                    std::shared_ptr<ast_node> else_body, yy::location loc);
+// They make the node, and whatever coercions it needs, in `arena`
 
-std::shared_ptr<ast_node> coerced_while(std::shared_ptr<ast_node> condition,
-                                        std::shared_ptr<ast_node> body,
-                                        yy::location loc);
+ast_node *coerced_conditional(ast_arena &arena, ast_node *condition,
+                              ast_node *if_body, ast_node *else_body,
+                              yy::location loc);
 
-std::shared_ptr<ast_node> coerced_sum(std::shared_ptr<ast_node> left,
-                                      std::shared_ptr<ast_node> right,
-                                      yy::location loc);
-std::shared_ptr<ast_node> coerced_subtraction(std::shared_ptr<ast_node> left,
-                                              std::shared_ptr<ast_node> right,
-                                              yy::location loc);
-std::shared_ptr<ast_node>
-coerced_multiplication(std::shared_ptr<ast_node> left,
-                       std::shared_ptr<ast_node> right, yy::location loc);
+ast_node *coerced_while(ast_arena &arena, ast_node *condition, ast_node *body,
+                        yy::location loc);
 
-std::shared_ptr<ast_node> coerced_division(std::shared_ptr<ast_node> left,
-                                           std::shared_ptr<ast_node> right,
-                                           yy::location loc);
-std::shared_ptr<ast_node> coerced_modulo(std::shared_ptr<ast_node> left,
-                                         std::shared_ptr<ast_node> right,
-                                         yy::location loc);
-std::shared_ptr<ast_node> coerced_lt(std::shared_ptr<ast_node> left,
-                                     std::shared_ptr<ast_node> right,
-                                     yy::location loc);
-std::shared_ptr<ast_node> coerced_gt(std::shared_ptr<ast_node> left,
-                                     std::shared_ptr<ast_node> right,
-                                     yy::location loc);
-std::shared_ptr<ast_node> coerced_lteq(std::shared_ptr<ast_node> left,
-                                       std::shared_ptr<ast_node> right,
-                                       yy::location loc);
-std::shared_ptr<ast_node> coerced_gteq(std::shared_ptr<ast_node> left,
-                                       std::shared_ptr<ast_node> right,
-                                       yy::location loc);
-std::shared_ptr<ast_node> coerced_equals(std::shared_ptr<ast_node> left,
-                                         std::shared_ptr<ast_node> right,
-                                         yy::location loc);
-std::shared_ptr<ast_node> coerced_nequals(std::shared_ptr<ast_node> left,
-                                          std::shared_ptr<ast_node> right,
-                                          yy::location loc);
-std::shared_ptr<ast_node> coerced_or(std::shared_ptr<ast_node> left,
-                                     std::shared_ptr<ast_node> right,
-                                     yy::location loc);
-std::shared_ptr<ast_node> coerced_and(std::shared_ptr<ast_node> left,
-                                      std::shared_ptr<ast_node> right,
-                                      yy::location loc);
+ast_node *coerced_sum(ast_arena &arena, ast_node *left, ast_node *right,
+                      yy::location loc);
+ast_node *coerced_subtraction(ast_arena &arena, ast_node *left, ast_node *right,
+                              yy::location loc);
+ast_node *coerced_multiplication(ast_arena &arena, ast_node *left,
+                                 ast_node *right, yy::location loc);
+ast_node *coerced_division(ast_arena &arena, ast_node *left, ast_node *right,
+                           yy::location loc);
+ast_node *coerced_modulo(ast_arena &arena, ast_node *left, ast_node *right,
+                         yy::location loc);
+ast_node *coerced_lt(ast_arena &arena, ast_node *left, ast_node *right,
+                     yy::location loc);
+ast_node *coerced_gt(ast_arena &arena, ast_node *left, ast_node *right,
+                     yy::location loc);
+ast_node *coerced_lteq(ast_arena &arena, ast_node *left, ast_node *right,
+                       yy::location loc);
+ast_node *coerced_gteq(ast_arena &arena, ast_node *left, ast_node *right,
+                       yy::location loc);
+ast_node *coerced_equals(ast_arena &arena, ast_node *left, ast_node *right,
+                         yy::location loc);
+ast_node *coerced_nequals(ast_arena &arena, ast_node *left, ast_node *right,
+                          yy::location loc);
+ast_node *coerced_or(ast_arena &arena, ast_node *left, ast_node *right,
+                     yy::location loc);
+ast_node *coerced_and(ast_arena &arena, ast_node *left, ast_node *right,
+                      yy::location loc);
 
 #endif /* COERCIONS_H */
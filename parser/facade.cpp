@@ -1,19 +1,65 @@
 #include "parser/facade.h"
+#include <algorithm>
+#include <unordered_set>
 
 parser::parser(std::string input) : input(input) {
-  this->scanner = yy::scanner(this->input);
   this->scanner.init_default_keywords();
+  this->init(this->input, "");
+}
+
+parser::parser(std::unique_ptr<mapped_file> file, std::string filename)
+    : file(std::move(file)) {
+  this->scanner.init_default_keywords();
+  this->init(this->file->view(), filename);
+}
+
+parser parser::from_file(std::string path) {
+  return parser(std::make_unique<mapped_file>(path), path);
+}
+
+parser parser::from_descriptor(int fd, std::string filename) {
+  return parser(std::make_unique<mapped_file>(fd), filename);
+}
+
+void parser::init(std::string_view source, std::string filename) {
+  this->scanner.in(reflex::Input(source.data(), source.size()));
+  this->scanner.filename = filename;
+
+  // Strings point into the input instead of being copied
+  this->scanner.source = source;
   this->stbuilder = symbol_table_stack();
-  this->y = std::make_shared<yy::parser>(scanner, stbuilder, &this->ast,
-                                         &this->message_recipient);
+  this->ast = nullptr;
+  this->message_recipient.clear();
+
+  if (this->arena != nullptr && this->arena.use_count() == 1) {
+    this->arena->clear();
+  } else {
+    // The last result still has the old one
+    this->arena = std::make_shared<ast_arena>();
+    this->y = std::make_shared<yy::parser>(scanner, stbuilder, *this->arena,
+                                           &this->ast,
+                                           &this->message_recipient);
+  }
 
   // test
   // auto t1 = this->scanner.yylex();
   // std::cout << t1.name() << '\n';
 }
 
+void parser::reset(std::string_view input, std::string filename) {
+  this->file.reset();
+  this->input.assign(input);
+  this->init(this->input, filename);
+}
+
+void parser::reset(std::unique_ptr<mapped_file> file, std::string filename) {
+  this->file = std::move(file);
+  this->input.clear();
+  this->init(this->file->view(), filename);
+}
+
 void parser::set_keyword(keyword kw, std::string value) {
-  this->scanner.keyword_map[value] = kw;
+  this->scanner.keywords.set(symbol(value), kw);
 }
 
 void parser::debug(int level) {
@@ -33,8 +79,440 @@ parse_result parser::parse() {
   auto status = this->y->parse();
 
   result.success = status == 0;
+  result.arena = this->arena;
   result.ast = this->ast;
   result.message = this->message_recipient;
 
   return result;
 }
+
+static keyword_table default_keywords() {
+  yy::scanner scanner;
+  scanner.init_default_keywords();
+  return scanner.keywords;
+}
+
+incremental_parser::incremental_parser(std::string input)
+    : keywords(default_keywords()), lexer(std::move(input), this->keywords),
+      root(nullptr), full_size(0), dirty(false), old_begin(0), old_end(0),
+      new_begin(0), new_end(0), change{true, 0, 0, 0} {}
+
+void incremental_parser::edit(std::size_t start, std::size_t removed,
+                              std::string inserted) {
+  this->lexer.edit(start, removed, inserted);
+
+  auto changed = this->lexer.last_change();
+  auto changed_end = changed.first + changed.removed;
+
+  if (!this->dirty) {
+    this->old_begin = this->new_begin = changed.first;
+    this->old_end = this->new_end = changed_end;
+  }
+
+  // Together with what earlier edits changed, which is in indices of the last
+  // parse outside of it
+  if (changed.first < this->new_begin) {
+    this->old_begin = this->new_begin = changed.first;
+  }
+
+  if (changed_end > this->new_end) {
+    this->old_end += changed_end - this->new_end;
+    this->new_end = changed_end;
+  }
+
+  this->new_end = this->new_end - changed.removed + changed.inserted;
+  this->dirty = true;
+}
+
+const std::string &incremental_parser::get_source() const {
+  return this->lexer.get_text();
+}
+
+void incremental_parser::set_keyword(keyword kw, std::string value) {
+  auto before = this->keywords.find(value);
+
+  if (before.has_value() && before.value() == kw) {
+    return;
+  }
+
+  this->keywords.set(symbol(value), kw);
+  this->lexer.set_keywords(this->keywords);
+
+  // Any name could be a keyword now
+  this->root = nullptr;
+}
+
+parse_result incremental_parser::parse() {
+  if (this->root == nullptr || (this->dirty && !this->reparse())) {
+    return this->full_parse();
+  }
+
+  if (this->dirty) {
+    this->dirty = false;
+  } else {
+    this->change = {false, 0, 0, 0};
+  }
+
+  parse_result result;
+  result.success = true;
+  result.arena = this->arena;
+  result.ast = this->root;
+
+  return result;
+}
+
+statement_change incremental_parser::last_change() const {
+  return this->change;
+}
+
+parse_result incremental_parser::full_parse() {
+  token_replay replay(this->lexer, &this->filename);
+  symbol_table_stack stbuilder;
+  auto arena = std::make_shared<ast_arena>();
+  ast_node *ast = nullptr;
+  std::string message;
+
+  yy::parser y(replay, stbuilder, *arena, &ast, &message);
+  auto status = y.parse();
+
+  parse_result result;
+  result.success = status == 0;
+  result.arena = arena;
+  result.ast = ast;
+  result.message = message;
+
+  this->dirty = false;
+  this->change = {true, 0, 0, 0};
+  this->links.clear();
+  this->starts.clear();
+  this->scopes.clear();
+
+  if (!result.success) {
+    this->arena = nullptr;
+    this->root = nullptr;
+    return result;
+  }
+
+  this->arena = arena;
+  this->root = static_cast<block_node *>(ast);
+  this->full_size = arena->size();
+  this->index_statements(this->root->children[0], 0,
+                         this->lexer.get_tokens().size(), this->links,
+                         this->starts);
+  this->snapshot_scopes();
+  this->change.inserted = this->links.size();
+
+  return result;
+}
+
+static bool is_before(const yy::position &a, const yy::position &b) {
+  return a.line < b.line || (a.line == b.line && a.column < b.column);
+}
+
+static bool is_declaration(const ast_node *statement) {
+  if (statement->kind != ast_node_kind::STATEMENT) {
+    return false;
+  }
+
+  auto kind = statement->children[0]->kind;
+  return kind == ast_node_kind::DECLARATION ||
+         kind == ast_node_kind::DECLARATION_ASSIGNMENT;
+}
+
+// Calls `visit` with `node` and everything under it, but doesn't go under the
+// nodes it returns false for
+template <typename Visit> static void walk(ast_node *node, Visit visit) {
+  std::vector<ast_node *> pending{node};
+
+  while (!pending.empty()) {
+    auto next = pending.back();
+    pending.pop_back();
+
+    if (visit(next)) {
+      pending.insert(pending.end(), next->children.begin(),
+                     next->children.end());
+    }
+  }
+}
+
+// If `table` or any scope in it has variables
+static bool declares_variables(symbol_table *table) {
+  std::vector<symbol_table *> pending{table};
+
+  while (!pending.empty()) {
+    auto next = pending.back();
+    pending.pop_back();
+
+    if (!next->vars().empty()) {
+      return true;
+    }
+
+    auto &children = next->get_children();
+    pending.insert(pending.end(), children.begin(), children.end());
+  }
+
+  return false;
+}
+
+void incremental_parser::index_statements(ast_node *head, std::size_t begin,
+                                          std::size_t end,
+                                          std::vector<ast_node *> &links,
+                                          std::vector<std::size_t> &starts) {
+  for (auto link = head; link->kind == ast_node_kind::SEQUENCE;
+       link = link->children[1]) {
+    auto at = link->children[0]->location.begin;
+
+    // Its first token is the first one that isn't before it
+    auto low = begin, high = end;
+
+    while (low < high) {
+      auto middle = low + (high - low) / 2;
+      auto token_at = this->lexer.location_of(middle, &this->filename).begin;
+
+      if (is_before(token_at, at)) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+
+    links.push_back(link);
+    starts.push_back(low);
+    begin = low;
+  }
+}
+
+void incremental_parser::snapshot_scopes() {
+  auto &table = *this->root->table;
+  auto scope = table.get_prelude();
+
+  // Declared in order, each visible from the statement after its own
+  auto &vars = table.vars();
+  auto next = vars.begin();
+
+  for (auto link : this->links) {
+    auto at = link->children[0]->location.begin;
+
+    for (; next != vars.end() && is_before(next->declared_at.begin, at);
+         ++next) {
+      scope.vars = scope.vars.insert(next->name, &*next);
+    }
+
+    this->scopes.push_back(scope);
+  }
+}
+
+bool incremental_parser::reparse() {
+  auto &tokens = this->lexer.get_tokens();
+  auto count = this->starts.size();
+
+  // Otherwise the arena would be mostly statements that were replaced
+  if (count == 0 || this->arena->size() > 2 * this->full_size + 4096) {
+    return false;
+  }
+
+  // The statements that the changed tokens were in
+  std::size_t first = std::upper_bound(this->starts.begin(), this->starts.end(),
+                                       this->old_begin) -
+                      this->starts.begin() - 1;
+  auto last_token = std::max(this->old_end, this->old_begin + 1) - 1;
+  std::size_t last = std::upper_bound(this->starts.begin(), this->starts.end(),
+                                      last_token) -
+                     this->starts.begin() - 1;
+
+  // An `if` without an `else` takes one from right after it, so the statement
+  // before can change too. A declaration can't
+  if (first > 0 && !is_declaration(this->links[first - 1]->children[0])) {
+    first--;
+  }
+
+  for (auto i = first; i <= last; ++i) {
+    if (is_declaration(this->links[i]->children[0])) {
+      return false;
+    }
+  }
+
+  auto begin = this->starts[first];
+  auto end = last + 1 < count
+                 ? this->starts[last + 1] - this->old_end + this->new_end
+                 : tokens.size();
+
+  // Two names in a row only ever start a declaration
+  for (auto i = begin; i + 1 < end; ++i) {
+    if (tokens[i].kind == yy::parser::symbol_kind::S_IDENTIFIER &&
+        tokens[i + 1].kind == yy::parser::symbol_kind::S_IDENTIFIER) {
+      return false;
+    }
+  }
+
+  auto table = this->root->table;
+  auto &children = table->get_children();
+  auto children_before = children.size();
+
+  // Without what's declared after, so that using it fails like it would in a
+  // full parse, which then says why
+  auto everything = table->snapshot();
+  table->restore(this->scopes[first]);
+
+  symbol_table_stack stbuilder(table);
+  token_replay replay(this->lexer, &this->filename, begin, end);
+  ast_node *fragment = nullptr;
+  std::string message;
+
+  yy::parser y(replay, stbuilder, *this->arena, &fragment, &message);
+  auto failed = y.parse() != 0;
+
+  table->restore(everything);
+
+  if (failed) {
+    // Tables of blocks in the fragment
+    children.resize(children_before);
+    return false;
+  }
+
+  std::vector<ast_node *> new_links;
+  std::vector<std::size_t> new_starts;
+  this->index_statements(fragment, begin, end, new_links, new_starts);
+
+  // Nothing would be left to say where the program ends
+  if (new_links.empty() && last - first + 1 == count) {
+    children.resize(children_before);
+    return false;
+  }
+
+  // Tables of blocks in the old statements
+  std::unordered_set<symbol_table *> dropped;
+
+  for (auto i = first; i <= last; ++i) {
+    walk(this->links[i]->children[0], [&](ast_node *node) {
+      if (node->kind == ast_node_kind::BLOCK) {
+        dropped.insert(static_cast<block_node *>(node)->table.get());
+        return false;
+      }
+
+      return true;
+    });
+  }
+
+  // Variables in blocks have offsets among the root's, in the order they were
+  // declared. Without a full parse, dropping some would leave a gap, and new
+  // ones would go after everything else
+  if (std::any_of(dropped.begin(), dropped.end(), declares_variables) ||
+      std::any_of(children.begin() + children_before, children.end(),
+                  declares_variables)) {
+    children.resize(children_before);
+    return false;
+  }
+
+  if (!dropped.empty()) {
+    children.erase(std::remove_if(children.begin(), children.end(),
+                                  [&](symbol_table *child) {
+                                    return dropped.count(child) > 0;
+                                  }),
+                   children.end());
+  }
+
+  // Splice the new statements in
+  auto next = last + 1 < count ? this->links[last + 1]
+                               : this->links[last]->children[1];
+  auto head = next;
+
+  if (!new_links.empty()) {
+    new_links.back()->children.set(1, next);
+    head = new_links.front();
+  }
+
+  if (first == 0) {
+    this->root->children.set(0, head);
+  } else {
+    this->links[first - 1]->children.set(1, head);
+  }
+
+  for (auto i = last + 1; i < count; ++i) {
+    this->starts[i] = this->starts[i] - this->old_end + this->new_end;
+  }
+
+  this->links.erase(this->links.begin() + first,
+                    this->links.begin() + last + 1);
+  this->links.insert(this->links.begin() + first, new_links.begin(),
+                     new_links.end());
+  this->starts.erase(this->starts.begin() + first,
+                     this->starts.begin() + last + 1);
+  this->starts.insert(this->starts.begin() + first, new_starts.begin(),
+                      new_starts.end());
+
+  // Nothing in between declares anything
+  auto scope = this->scopes[first];
+  this->scopes.erase(this->scopes.begin() + first,
+                     this->scopes.begin() + last + 1);
+  this->scopes.insert(this->scopes.begin() + first, new_links.size(), scope);
+
+  this->change = {false, first, last - first + 1, new_links.size()};
+
+  if (first + new_links.size() < this->links.size()) {
+    this->shift_locations(first + new_links.size());
+  }
+
+  this->span_statements();
+
+  return true;
+}
+
+void incremental_parser::span_statements() {
+  auto end = this->links.back()->children[0]->location.end;
+
+  for (auto link : this->links) {
+    link->location.begin = link->children[0]->location.begin;
+    link->location.end = end;
+  }
+
+  auto noop = this->links.back()->children[1];
+  noop->location.begin = noop->location.end = end;
+
+  this->root->location = this->links.front()->location;
+}
+
+void incremental_parser::shift_locations(std::size_t from) {
+  auto was = this->links[from]->children[0]->location.begin;
+  auto now = this->lexer.location_of(this->starts[from], &this->filename).begin;
+
+  // Columns only moved on the line where the edit ended
+  auto line = was.line;
+  auto lines = now.line - was.line;
+  auto columns = now.column - was.column;
+
+  if (lines == 0 && columns == 0) {
+    return;
+  }
+
+  auto shift = [&](yy::location &loc) {
+    for (auto position : {&loc.begin, &loc.end}) {
+      if (position->line == line) {
+        position->column += columns;
+      }
+
+      position->line += lines;
+    }
+  };
+
+  for (auto i = from; i < this->links.size(); ++i) {
+    auto statement = this->links[i]->children[0];
+
+    // The rest didn't move at all
+    if (lines == 0 && statement->location.begin.line != line) {
+      break;
+    }
+
+    walk(statement, [&](ast_node *node) {
+      shift(node->location);
+
+      if (node->kind == ast_node_kind::DECLARATION ||
+          node->kind == ast_node_kind::DECLARATION_ASSIGNMENT) {
+        auto var = static_cast<var_identifier_node *>(node->children[1]);
+        shift(var->entry->declared_at);
+      }
+
+      return true;
+    });
+  }
+}
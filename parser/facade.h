@@ -1,25 +1,132 @@
+#include "common/mapped_file.h"
+#include "parser/ast_arena.h"
+#include "parser/lex/incremental_lexer.h"
 #include "parser/lex/scanner.hpp"
 #include "parser/syntax/parser.hpp"
+#include <memory>
 
 struct parse_result {
   bool success;
   std::string message;
-  std::shared_ptr<ast_node> ast;
+  // Owns the nodes, `ast` included. Copies of the result share it
+  std::shared_ptr<ast_arena> arena;
+  ast_node *ast;
 };
 
+// Parsers share nothing but the names and types they intern, which is safe,
+// so each thread can have its own. A single parser is not to be used from
+// two threads at once, and neither is a result while it's parsing again
 class parser {
 private:
   std::string input;
+  // Instead of `input`, when reading from a file
+  std::unique_ptr<mapped_file> file;
+
   std::shared_ptr<yy::parser> y;
   yy::scanner scanner;
   symbol_table_stack stbuilder;
-  std::shared_ptr<ast_node> ast;
+  std::shared_ptr<ast_arena> arena;
+  ast_node *ast;
   std::string message_recipient;
 
+  parser(std::unique_ptr<mapped_file> file, std::string filename);
+  void init(std::string_view source, std::string filename);
+
 public:
   parser(std::string input);
 
+  // Reads straight from the mapped file, which is never copied. Locations
+  // refer to `path`, or `filename` if given
+  static parser from_file(std::string path);
+  static parser from_descriptor(int fd, std::string filename);
+
+  // Starts over with another source, to parse many one after the other.
+  // Keywords that were set stay, and so do the arena and the parser's stack
+  // when no result holds on to them anymore
+  void reset(std::string_view input, std::string filename = "");
+  // Same, but reads straight from the mapped file like `from_file`
+  void reset(std::unique_ptr<mapped_file> file, std::string filename);
+
   void set_keyword(keyword kw, std::string value);
   void debug(int level);
   parse_result parse();
 };
+
+// What the last parse of an `incremental_parser` changed, in statements of the
+// outermost block
+struct statement_change {
+  // Everything was parsed again, and the rest doesn't apply
+  bool full;
+  // Statements from `first` to `first + inserted` are new, and took the place
+  // of `removed` old ones. All others are the same nodes as before
+  std::size_t first;
+  std::size_t removed;
+  std::size_t inserted;
+};
+
+// For the editor, which changes a bit of the source at a time. Keeps the tokens
+// between parses, and each edit only relexes around itself.
+//
+// It also keeps the last tree, and parses again only the statements of the
+// outermost block that edits touched, seeing just the names declared before
+// them. That is, unless they declare something, since that can change what
+// every other statement means or where variables are, and then everything is
+// parsed again. Even in blocks, which take offsets among the outermost
+// block's. Results share the tree, which later parses change
+class incremental_parser {
+private:
+  keyword_table keywords;
+  incremental_lexer lexer;
+  // Locations point to it
+  std::string filename;
+
+  // Empty after a failed parse
+  std::shared_ptr<ast_arena> arena;
+  block_node *root;
+  // The arena's size after the last full parse, to know when it's mostly
+  // replaced statements
+  std::size_t full_size;
+
+  // For each statement of `root`, the sequence node that holds it, the index
+  // of its first token and the names declared before it
+  std::vector<ast_node *> links;
+  std::vector<std::size_t> starts;
+  std::vector<scope_snapshot> scopes;
+
+  // Tokens changed since the last parse, by index then and now
+  bool dirty;
+  std::size_t old_begin, old_end;
+  std::size_t new_begin, new_end;
+
+  statement_change change;
+
+  parse_result full_parse();
+  // False if it takes a full parse
+  bool reparse();
+  // Fixes the locations of statements from `from` on, which were kept but
+  // moved
+  void shift_locations(std::size_t from);
+  // Sequence nodes, the `noop` that ends them and `root` span from their first
+  // statement to the end of the last, which changes with any reparse
+  void span_statements();
+  // What each statement of `root` sees, from the declarations in it
+  void snapshot_scopes();
+
+  // Statements from `head` on, with the first token of each between `begin`
+  // and `end`
+  void index_statements(ast_node *head, std::size_t begin, std::size_t end,
+                        std::vector<ast_node *> &links,
+                        std::vector<std::size_t> &starts);
+
+public:
+  incremental_parser(std::string input);
+
+  // Replaces `removed` bytes at byte offset `start` with `inserted`
+  void edit(std::size_t start, std::size_t removed, std::string inserted);
+  const std::string &get_source() const;
+
+  void set_keyword(keyword kw, std::string value);
+  parse_result parse();
+
+  statement_change last_change() const;
+};
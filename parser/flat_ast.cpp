@@ -0,0 +1,143 @@
+#include "parser/flat_ast.h"
+
+std::size_t flat_ast::size() const { return this->kinds.size(); }
+
+void flat_ast::clear() {
+  this->kinds.clear();
+  this->types.clear();
+  this->first_child.clear();
+  this->next_sibling.clear();
+  this->lines.clear();
+  this->columns.clear();
+  this->values.clear();
+  this->type_list.clear();
+  this->strings.clear();
+  this->tables.clear();
+}
+
+node_index flat_ast::child(node_index node, std::size_t n) const {
+  auto found = this->first_child[node];
+
+  for (std::size_t i = 0; i < n && found != no_node; ++i) {
+    found = this->next_sibling[found];
+  }
+
+  return found;
+}
+
+type &flat_ast::type_of(node_index node) const {
+  return *this->type_list[this->types[node]];
+}
+
+static std::uint32_t type_id_of(flat_ast &flat,
+                                const std::shared_ptr<type> &typ) {
+  // There's only a handful of different types in a tree
+  for (std::uint32_t i = 0; i < flat.type_list.size(); ++i) {
+    auto &known = flat.type_list[i];
+
+    if (known == typ) {
+      return i;
+    }
+  }
+
+  flat.type_list.push_back(typ);
+  return flat.type_list.size() - 1;
+}
+
+static flat_value value_of(flat_ast &flat, const ast_node *node) {
+  flat_value value;
+  value.int_value = 0;
+
+  switch (node->kind) {
+  case ast_node_kind::INT_LITERAL:
+    value.int_value = static_cast<const int_literal_node *>(node)->value;
+    break;
+  case ast_node_kind::FLOAT_LITERAL:
+    value.float_value = static_cast<const float_literal_node *>(node)->value;
+    break;
+  case ast_node_kind::BOOLEAN_LITERAL:
+    value.bool_value = static_cast<const boolean_literal_node *>(node)->value;
+    break;
+  case ast_node_kind::CHAR_LITERAL:
+    value.char_value = static_cast<const char_literal_node *>(node)->value;
+    break;
+  case ast_node_kind::STRING_LITERAL:
+    value.string = flat.strings.size();
+    flat.strings.push_back(
+        static_cast<const string_literal_node *>(node)->value);
+    break;
+  case ast_node_kind::VAR_IDENTIFIER:
+    value.var = static_cast<const var_identifier_node *>(node)->entry;
+    break;
+  case ast_node_kind::TYPE_IDENTIFIER:
+    value.type_entry = static_cast<const type_identifier_node *>(node)->entry;
+    break;
+  case ast_node_kind::LABEL:
+    value.name = static_cast<const label_node *>(node)->value.get_id();
+    break;
+  case ast_node_kind::GOTO:
+    value.name = static_cast<const goto_node *>(node)->value.get_id();
+    break;
+  case ast_node_kind::BLOCK: {
+    auto table = static_cast<const block_node *>(node)->table;
+    flat.tables.push_back(table);
+    value.table = table.get();
+    break;
+  }
+  default:
+    break;
+  }
+
+  return value;
+}
+
+flat_ast flatten(const ast_node *root) {
+  flat_ast flat;
+  flatten(root, flat);
+  return flat;
+}
+
+void flatten(const ast_node *root, flat_ast &flat) {
+  flat.clear();
+
+  // The last child of each node seen so far, for the next one to follow
+  std::vector<node_index> last_child;
+
+  struct pending {
+    const ast_node *node;
+    node_index parent;
+  };
+
+  std::vector<pending> stack;
+  stack.push_back({root, no_node});
+
+  while (!stack.empty()) {
+    auto [node, parent] = stack.back();
+    stack.pop_back();
+
+    node_index index = flat.size();
+    flat.kinds.push_back(node->kind);
+    flat.types.push_back(type_id_of(flat, node->typ));
+    flat.first_child.push_back(no_node);
+    flat.next_sibling.push_back(no_node);
+    flat.lines.push_back(node->location.begin.line);
+    flat.columns.push_back(node->location.begin.column);
+    flat.values.push_back(value_of(flat, node));
+    last_child.push_back(no_node);
+
+    if (parent != no_node) {
+      if (last_child[parent] == no_node) {
+        flat.first_child[parent] = index;
+      } else {
+        flat.next_sibling[last_child[parent]] = index;
+      }
+
+      last_child[parent] = index;
+    }
+
+    // Backwards, so that the first child comes out next
+    for (auto i = node->children.size(); i > 0; --i) {
+      stack.push_back({node->children[i - 1], index});
+    }
+  }
+}
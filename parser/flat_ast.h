@@ -0,0 +1,68 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include "parser/ast.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::uint32_t node_index;
+const node_index no_node = std::numeric_limits<node_index>::max();
+
+// What a node carries besides its children, depending on its kind
+union flat_value {
+  std::int64_t int_value;
+  double float_value;
+  bool bool_value;
+  char char_value;
+  // LABEL and GOTO
+  symbol_id name;
+  // STRING_LITERAL, into `strings`
+  std::uint32_t string;
+  // VAR_IDENTIFIER and TYPE_IDENTIFIER
+  var_table_entry *var;
+  type_table_entry *type_entry;
+  // BLOCK
+  symbol_table *table;
+};
+
+// The same tree as the nodes, but with each field in its own array, indexed by
+// node. Nodes are in preorder, so walking the tree goes forward in memory, and
+// a node's first child comes right after it.
+//
+// The nodes are still what the parser builds and what tests look at. This is
+// what the compiler walks
+class flat_ast {
+public:
+  std::vector<ast_node_kind> kinds;
+  // Into `type_list`, where each distinct type is once
+  std::vector<std::uint32_t> types;
+  std::vector<node_index> first_child;
+  std::vector<node_index> next_sibling;
+  // Where each node starts in the source
+  std::vector<std::uint32_t> lines;
+  std::vector<std::uint32_t> columns;
+  std::vector<flat_value> values;
+
+  std::vector<std::shared_ptr<type>> type_list;
+  std::vector<std::string> strings;
+  // Variable entries point into them
+  std::vector<std::shared_ptr<symbol_table>> tables;
+
+  std::size_t size() const;
+  // Empties it but keeps the arrays' memory
+  void clear();
+
+  // The `n`th child of `node`
+  node_index child(node_index node, std::size_t n) const;
+  type &type_of(node_index node) const;
+};
+
+// Doesn't recurse, so any depth is fine
+flat_ast flatten(const ast_node *root);
+// Into one that's already there, reusing its memory
+void flatten(const ast_node *root, flat_ast &flat);
+
+#endif /* FLAT_AST_H */
@@ -0,0 +1,352 @@
+#include "parser/lex/incremental_lexer.h"
+#include <algorithm>
+
+typedef yy::parser::symbol_kind_type token_kind;
+
+// Same as the scanner's, so that columns match
+const std::size_t tab_size = 8;
+
+bool lexed_token::operator==(const lexed_token &other) const {
+  if (this->kind != other.kind || this->start != other.start ||
+      this->end != other.end) {
+    return false;
+  }
+
+  switch (this->kind) {
+  case token_kind::S_IDENTIFIER:
+    return this->name == other.name;
+  case token_kind::S_INT_LITERAL:
+    return this->int_value == other.int_value;
+  case token_kind::S_FLOAT_LITERAL:
+    return this->float_value == other.float_value;
+  case token_kind::S_CHAR_LITERAL:
+    return this->char_value == other.char_value;
+  case token_kind::S_BOOLEAN_LITERAL:
+    return this->bool_value == other.bool_value;
+  default:
+    return true;
+  }
+}
+
+incremental_lexer::incremental_lexer(std::string text, keyword_table keywords)
+    : text(std::move(text)), keywords(std::move(keywords)), changed{0, 0, 0} {
+  this->line_starts.push_back(0);
+  this->update_line_starts(0, 0, this->text);
+  this->relex(0, 0, 0, 0);
+}
+
+std::size_t incremental_lexer::restart_point(std::size_t offset) const {
+  // Up to the start of the line, since `//`, strings and exponents look ahead
+  // until its end
+  auto line = std::upper_bound(this->line_starts.begin(),
+                               this->line_starts.end(), offset);
+  auto line_start = *(line - 1);
+
+  // A `/*` without its `*/` looked ahead all the way, so the edit may close it
+  for (std::size_t i = 0; i < this->tokens.size(); ++i) {
+    auto &token = this->tokens[i];
+
+    if (token.start >= line_start) {
+      break;
+    }
+
+    if (token.kind == token_kind::S_SLASH && token.end < this->text.size() &&
+        this->text[token.end] == '*') {
+      line_start = token.start;
+      break;
+    }
+  }
+
+  // The first token that ends after the line starts
+  auto first = std::upper_bound(
+      this->tokens.begin(), this->tokens.end(), line_start,
+      [](std::size_t offset, const lexed_token &token) {
+        return offset < token.end;
+      });
+
+  return first - this->tokens.begin();
+}
+
+static lexed_token make_lexed_token(yy::parser::symbol_type &scanned,
+                                    std::size_t start, std::size_t end) {
+  lexed_token token;
+  token.kind = scanned.kind();
+  token.start = start;
+  token.end = end;
+  token.int_value = 0;
+
+  switch (token.kind) {
+  case token_kind::S_IDENTIFIER:
+    token.name = scanned.value.as<symbol>().get_id();
+    break;
+  case token_kind::S_INT_LITERAL:
+    token.int_value = scanned.value.as<std::int64_t>();
+    break;
+  case token_kind::S_FLOAT_LITERAL:
+    token.float_value = scanned.value.as<double>();
+    break;
+  case token_kind::S_CHAR_LITERAL:
+    token.char_value = scanned.value.as<char>();
+    break;
+  case token_kind::S_BOOLEAN_LITERAL:
+    token.bool_value = scanned.value.as<bool>();
+    break;
+  default:
+    break;
+  }
+
+  return token;
+}
+
+void incremental_lexer::relex(std::size_t keep, std::size_t offset,
+                              std::size_t sync_from, std::int64_t delta) {
+  auto rest = std::string_view(this->text).substr(offset);
+  yy::scanner scanner(reflex::Input(rest.data(), rest.size()));
+  scanner.source = rest;
+  scanner.keywords = this->keywords;
+
+  std::vector<lexed_token> fresh;
+  auto old_begin = this->tokens.begin() + keep;
+  auto old = old_begin;
+  auto resume = this->tokens.end();
+
+  while (true) {
+    lexed_token token;
+
+    try {
+      auto scanned = scanner.yylex();
+
+      if (scanned.kind() == token_kind::S_YYEOF) {
+        break;
+      }
+
+      auto start = offset + scanner.matcher().first();
+      token = make_lexed_token(scanned, start, start + scanner.size());
+    } catch (const yy::parser::syntax_error &) {
+      // A literal that doesn't fit. The parser gets the error when it gets here
+      token.kind = token_kind::S_YYerror;
+      token.start = offset + scanner.matcher().first();
+      token.end = token.start + scanner.size();
+      token.int_value = 0;
+    }
+
+    if (token.start >= sync_from) {
+      // Scanning from here on would give the same tokens as before
+      while (old != this->tokens.end() &&
+             std::int64_t(old->start) + delta < std::int64_t(token.start)) {
+        ++old;
+      }
+
+      if (old != this->tokens.end() &&
+          std::int64_t(old->start) + delta == std::int64_t(token.start)) {
+        resume = old;
+        break;
+      }
+    }
+
+    fresh.push_back(token);
+  }
+
+  this->changed = {keep, std::size_t(resume - old_begin), fresh.size()};
+
+  for (auto it = resume; it != this->tokens.end(); ++it) {
+    it->start += delta;
+    it->end += delta;
+  }
+
+  auto kept_after = this->tokens.erase(this->tokens.begin() + keep, resume);
+  this->tokens.insert(kept_after, fresh.begin(), fresh.end());
+}
+
+void incremental_lexer::update_line_starts(std::size_t start,
+                                           std::size_t removed,
+                                           std::string_view inserted) {
+  auto &starts = this->line_starts;
+  std::int64_t delta = std::int64_t(inserted.size()) - std::int64_t(removed);
+
+  // Lines that started inside the removed text are gone
+  auto first = std::upper_bound(starts.begin(), starts.end(), start);
+  auto last = std::upper_bound(first, starts.end(), start + removed);
+  auto after = starts.erase(first, last);
+
+  for (auto it = after; it != starts.end(); ++it) {
+    *it += delta;
+  }
+
+  std::vector<std::size_t> added;
+  for (std::size_t i = 0; i < inserted.size(); ++i) {
+    if (inserted[i] == '\n') {
+      added.push_back(start + i + 1);
+    }
+  }
+
+  starts.insert(after, added.begin(), added.end());
+}
+
+void incremental_lexer::edit(std::size_t start, std::size_t removed,
+                             std::string_view inserted) {
+  if (start > this->text.size()) {
+    throw std::out_of_range("Edit starts past the end of the source.");
+  }
+
+  removed = std::min(removed, this->text.size() - start);
+
+  auto keep = this->restart_point(start);
+  auto offset = keep > 0 ? this->tokens[keep - 1].end : 0;
+  std::int64_t delta = std::int64_t(inserted.size()) - std::int64_t(removed);
+
+  auto removed_text = this->text.substr(start, removed);
+  this->text.replace(start, removed, inserted);
+
+  try {
+    this->relex(keep, offset, start + inserted.size(), delta);
+  } catch (...) {
+    // As if nothing happened
+    this->text.replace(start, inserted.size(), removed_text);
+    throw;
+  }
+
+  this->update_line_starts(start, removed, inserted);
+}
+
+void incremental_lexer::set_keywords(keyword_table keywords) {
+  this->keywords = std::move(keywords);
+  this->tokens.clear();
+  this->relex(0, 0, 0, 0);
+}
+
+const std::string &incremental_lexer::get_text() const { return this->text; }
+
+const std::vector<lexed_token> &incremental_lexer::get_tokens() const {
+  return this->tokens;
+}
+
+std::size_t incremental_lexer::last_relexed() const {
+  return this->changed.inserted;
+}
+
+token_change incremental_lexer::last_change() const { return this->changed; }
+
+std::size_t incremental_lexer::column_of(std::size_t line_start,
+                                         std::size_t offset) const {
+  std::size_t column = 0;
+
+  for (auto i = line_start; i < offset; ++i) {
+    char c = this->text[i];
+
+    if (c == '\t') {
+      column += 1 + (~column & (tab_size - 1));
+    } else {
+      // UTF-8 continuation bytes aren't characters
+      column += (c & 0xC0) != 0x80;
+    }
+  }
+
+  return column;
+}
+
+yy::location incremental_lexer::location_of(std::size_t index,
+                                            const std::string *filename) const {
+  auto &token = this->tokens[index];
+
+  auto line = std::upper_bound(this->line_starts.begin(),
+                               this->line_starts.end(), token.start) -
+              1;
+  auto line_number = line - this->line_starts.begin() + 1;
+
+  // Tokens are never more than one line long
+  auto begin_column = this->column_of(*line, token.start);
+  auto end_column = this->column_of(*line, token.end);
+
+  yy::location loc;
+  loc.begin.initialize(filename, line_number, begin_column);
+  loc.end.initialize(filename, line_number,
+                     end_column > 0 ? end_column - 1 : 0);
+  return loc;
+}
+
+yy::parser::symbol_type
+incremental_lexer::make_symbol(std::size_t index,
+                               const std::string *filename) const {
+  auto &token = this->tokens[index];
+  auto loc = this->location_of(index, filename);
+
+  switch (token.kind) {
+  case token_kind::S_IDENTIFIER:
+    return yy::parser::make_IDENTIFIER(symbol::from_id(token.name), loc);
+  case token_kind::S_INT_LITERAL:
+    return yy::parser::make_INT_LITERAL(token.int_value, loc);
+  case token_kind::S_FLOAT_LITERAL:
+    return yy::parser::make_FLOAT_LITERAL(token.float_value, loc);
+  case token_kind::S_CHAR_LITERAL:
+    return yy::parser::make_CHAR_LITERAL(token.char_value, loc);
+  case token_kind::S_BOOLEAN_LITERAL:
+    return yy::parser::make_BOOLEAN_LITERAL(token.bool_value, loc);
+  case token_kind::S_STRING_LITERAL:
+    return yy::parser::make_STRING_LITERAL(
+        std::string_view(this->text).substr(token.start,
+                                            token.end - token.start),
+        loc);
+  case token_kind::S_YYerror: {
+    // Scanning it again gives the same error, now with the right location
+    auto text = std::string_view(this->text).substr(token.start,
+                                                    token.end - token.start);
+    yy::scanner scanner(reflex::Input(text.data(), text.size()));
+
+    try {
+      scanner.yylex();
+    } catch (const yy::parser::syntax_error &error) {
+      throw yy::parser::syntax_error(loc, error.what());
+    }
+
+    return yy::parser::make_YYUNDEF(loc);
+  }
+  default:
+    // Token numbers are the same as kinds
+    return yy::parser::symbol_type(token.kind, loc);
+  }
+}
+
+yy::location
+incremental_lexer::end_location(const std::string *filename) const {
+  auto line_start = this->line_starts.back();
+  auto column = this->column_of(line_start, this->text.size());
+
+  yy::location loc;
+  loc.begin.initialize(filename, this->line_starts.size(), column);
+  loc.end = loc.begin;
+  return loc;
+}
+
+token_replay::token_replay(const incremental_lexer &lexer,
+                           const std::string *filename)
+    : lexer(lexer), filename_of_tokens(filename), next(0),
+      end(lexer.get_tokens().size()), fragment(false) {}
+
+token_replay::token_replay(const incremental_lexer &lexer,
+                           const std::string *filename, std::size_t begin,
+                           std::size_t end)
+    : lexer(lexer), filename_of_tokens(filename), next(begin), end(end),
+      fragment(true) {}
+
+yy::parser::symbol_type token_replay::yylex() {
+  // Where the next token would be
+  auto here = [&]() {
+    if (this->next < this->lexer.get_tokens().size()) {
+      return this->lexer.location_of(this->next, this->filename_of_tokens);
+    }
+
+    return this->lexer.end_location(this->filename_of_tokens);
+  };
+
+  if (this->fragment) {
+    this->fragment = false;
+    return yy::parser::make_FRAGMENT(here());
+  }
+
+  if (this->next < this->end) {
+    return this->lexer.make_symbol(this->next++, this->filename_of_tokens);
+  }
+
+  return yy::parser::make_YYEOF(here());
+}
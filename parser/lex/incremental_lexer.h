@@ -0,0 +1,117 @@
+#ifndef INCREMENTAL_LEXER_H
+#define INCREMENTAL_LEXER_H
+
+#include "parser/lex/keyword_table.h"
+#include "parser/lex/scanner.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A token as kept between edits. It only has byte offsets into the source, so
+// that moving it around after an edit is just adding to them
+struct lexed_token {
+  yy::parser::symbol_kind_type kind;
+  std::size_t start;
+  std::size_t end;
+
+  // Depending on `kind`. Strings are taken from the source when needed
+  union {
+    symbol_id name;
+    std::int64_t int_value;
+    double float_value;
+    char char_value;
+    bool bool_value;
+  };
+
+  bool operator==(const lexed_token &other) const;
+};
+
+// Which tokens an edit replaced, by index
+struct token_change {
+  std::size_t first;
+  std::size_t removed;
+  std::size_t inserted;
+};
+
+// Keeps the tokens of a source between edits, and after each one relexes only
+// from the last point before it that the edit can't have changed, until the
+// tokens line up with the old ones again.
+//
+// Any token boundary is a safe place to start scanning from, since the scanner
+// has no states. What the edit can change is how the tokens right before it
+// were scanned, because the scanner looked ahead: past the end of the line for
+// `//` comments, strings and exponents, or up to the end of the source for a
+// `/*` that was never closed. So it starts over from the previous line, or
+// from before the first unclosed `/*`.
+class incremental_lexer {
+private:
+  std::string text;
+  std::vector<lexed_token> tokens;
+  keyword_table keywords;
+
+  // Offsets where each line starts, for locations
+  std::vector<std::size_t> line_starts;
+
+  token_change changed;
+
+  // Index of the first token that has to be scanned again for an edit at
+  // `offset`
+  std::size_t restart_point(std::size_t offset) const;
+
+  // Replaces the tokens from `keep` on by scanning from `offset`. Once past
+  // `sync_from` it stops at the first token that starts where an old one used
+  // to, minus `delta`, and moves the rest of the old tokens instead
+  void relex(std::size_t keep, std::size_t offset, std::size_t sync_from,
+             std::int64_t delta);
+
+  void update_line_starts(std::size_t start, std::size_t removed,
+                          std::string_view inserted);
+
+  std::size_t column_of(std::size_t line_start, std::size_t offset) const;
+
+public:
+  incremental_lexer(std::string text, keyword_table keywords);
+
+  // Replaces `removed` bytes at byte offset `start` with `inserted`
+  void edit(std::size_t start, std::size_t removed, std::string_view inserted);
+
+  // Everything is scanned again, since any identifier may have changed
+  void set_keywords(keyword_table keywords);
+
+  const std::string &get_text() const;
+  const std::vector<lexed_token> &get_tokens() const;
+
+  // How many tokens the last edit scanned
+  std::size_t last_relexed() const;
+  token_change last_change() const;
+
+  // For the parser. Locations point to `filename`
+  yy::location location_of(std::size_t index,
+                           const std::string *filename) const;
+  yy::parser::symbol_type make_symbol(std::size_t index,
+                                      const std::string *filename) const;
+  yy::location end_location(const std::string *filename) const;
+};
+
+// Gives the parser the tokens of an incremental lexer instead of scanning
+class token_replay : public yy::scanner {
+private:
+  const incremental_lexer &lexer;
+  const std::string *filename_of_tokens;
+  std::size_t next;
+  std::size_t end;
+  bool fragment;
+
+public:
+  token_replay(const incremental_lexer &lexer, const std::string *filename);
+
+  // Only tokens `begin` to `end`, parsed as statements going into a block that
+  // already exists
+  token_replay(const incremental_lexer &lexer, const std::string *filename,
+               std::size_t begin, std::size_t end);
+
+  virtual yy::parser::symbol_type yylex() override;
+};
+
+#endif /* INCREMENTAL_LEXER_H */
@@ -0,0 +1,79 @@
+#include "parser/lex/keyword_table.h"
+#include <algorithm>
+
+// How many multipliers to try before giving up on a table this small
+const int attempts_per_size = 4096;
+
+keyword_table::keyword_table() : slots(1), multiplier(1) {}
+
+keyword_table::keyword_table(std::vector<std::pair<symbol, keyword>> entries)
+    : entries(std::move(entries)) {
+  this->rebuild();
+}
+
+void keyword_table::set(symbol name, keyword value) {
+  for (auto &entry : this->entries) {
+    if (entry.first == name) {
+      entry.second = value;
+      this->rebuild();
+      return;
+    }
+  }
+
+  this->entries.emplace_back(name, value);
+  this->rebuild();
+}
+
+void keyword_table::rebuild() {
+  // Same sequence every time, so the same keywords get the same table
+  std::uint64_t seed = 0x9e3779b97f4a7c15;
+  auto next_multiplier = [&seed]() {
+    // splitmix64
+    std::uint64_t z = (seed += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return (z ^ (z >> 31)) | 1;
+  };
+
+  // Starts with one slot per keyword, and only makes room when no multiplier
+  // works, which doesn't happen for the handful of keywords we have
+  std::vector<std::uint8_t> taken;
+
+  for (auto size = std::max<std::size_t>(this->entries.size(), 1);; ++size) {
+    taken.resize(size);
+
+    for (int attempt = 0; attempt < attempts_per_size; ++attempt) {
+      auto candidate = next_multiplier();
+      std::fill(taken.begin(), taken.end(), 0);
+
+      bool collided = false;
+      for (auto &[name, _] : this->entries) {
+        auto index = slot_of(name.get_id(), candidate, size);
+
+        if (taken[index]) {
+          collided = true;
+          break;
+        }
+
+        taken[index] = 1;
+      }
+
+      if (collided) {
+        continue;
+      }
+
+      this->multiplier = candidate;
+      this->slots.assign(size, slot{symbol(), keyword::TRUE});
+
+      for (auto &[name, value] : this->entries) {
+        this->slots[slot_of(name.get_id(), candidate, size)] = {name, value};
+      }
+
+      return;
+    }
+  }
+}
+
+std::size_t keyword_table::size() const { return this->entries.size(); }
+
+std::size_t keyword_table::slot_count() const { return this->slots.size(); }
@@ -0,0 +1,71 @@
+#ifndef KEYWORD_TABLE_H
+#define KEYWORD_TABLE_H
+
+#include "common/interner.h"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class keyword { TRUE, FALSE, IF, ELSE, WHILE, RETURN, GOTO, WRITE, READ };
+
+// Tells keywords apart from other identifiers, which are already interned by
+// the time they get here. Every time the keywords change, it looks for a
+// multiplier that sends each of them to a slot of its own, so that a lookup is
+// a couple of multiplications and a single comparison
+class keyword_table {
+private:
+  struct slot {
+    symbol name;
+    keyword value;
+  };
+
+  std::vector<std::pair<symbol, keyword>> entries;
+
+  // Unused slots have the empty name, which is never an identifier
+  std::vector<slot> slots;
+  std::uint64_t multiplier;
+
+  void rebuild();
+
+  static std::size_t slot_of(symbol_id id, std::uint64_t multiplier,
+                             std::size_t slot_count) {
+    std::uint64_t mixed = (id * multiplier) >> 32;
+    return (mixed * slot_count) >> 32;
+  }
+
+public:
+  keyword_table();
+  keyword_table(std::vector<std::pair<symbol, keyword>> entries);
+
+  // Adds `name` as another way to write `value`, or changes what it means
+  void set(symbol name, keyword value);
+
+  std::optional<keyword> find(symbol name) const {
+    auto &found = this->slots[slot_of(name.get_id(), this->multiplier,
+                                      this->slots.size())];
+
+    if (found.name == name) {
+      return found.value;
+    }
+
+    return std::nullopt;
+  }
+
+  // Doesn't intern `name`, which no keyword has if it never was
+  std::optional<keyword> find(std::string_view name) const {
+    auto interned = symbol::find(name);
+
+    if (!interned.has_value()) {
+      return std::nullopt;
+    }
+
+    return this->find(interned.value());
+  }
+
+  std::size_t size() const;
+  std::size_t slot_count() const;
+};
+
+#endif /* KEYWORD_TABLE_H */
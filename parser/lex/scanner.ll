@@ -1,20 +1,40 @@
 %top{
+  #include "common/interner.h"
+  #include "parser/lex/keyword_table.h"
   #include "parser/literals.h"
   #include "parser/syntax/parser.hpp"
   #include "parser/syntax/location.hpp"
-
-  enum class keyword { TRUE, FALSE, IF, ELSE, WHILE, RETURN, GOTO, WRITE, READ };
+  #include <deque>
+  #include <string_view>
 }
 
 %class {
 private:
+  // Lexemes copied for when there's no `source`
+  std::deque<std::string> copies;
+
   yy::parser::symbol_type make_keyword(keyword k, yy::location loc);
+  std::string_view lexeme();
+  // The match in the matcher's own buffer, only good until the next one
+  std::string_view span();
+
+  yy::parser::symbol_type make_int(yy::location loc);
+  yy::parser::symbol_type make_float(yy::location loc);
+
+  // Like `location()`, which goes back to the start of the line for where the
+  // match ends, and so takes quadratic time on long generated lines. Tokens
+  // never span lines, so the end is on the line it started
+  yy::location token_location();
 
 public:
-  std::map<std::string, keyword> keyword_map;
+  // The whole input. String tokens are views into it, so it has to outlive
+  // them. Identifiers are interned instead
+  std::string_view source;
+
+  keyword_table keywords;
 
   void init_default_keywords();
-  yy::parser::symbol_type look_for_keyword(std::string identifier, yy::location loc);
+  yy::parser::symbol_type look_for_keyword(std::string_view identifier, yy::location loc);
 }
 
 %option bison-complete
@@ -49,53 +69,55 @@ string       \" ( \\. | [^\\"\n] )* \"
 "//".*           // inline comment
 "/*"(.|\n)*?"*/" // multiline comment
 
-{identifier}     { return look_for_keyword(str(), location()); }
-{integer}        { return yy::parser::make_INT_LITERAL(parse_int(str()), location()); }
-{float}          { return yy::parser::make_FLOAT_LITERAL(parse_float(str()), location()); }
-{char}           { return yy::parser::make_CHAR_LITERAL(parse_char(str()), location()); }
-{string}         { return yy::parser::make_STRING_LITERAL(parse_string(str()), location()); }
-"+="             { return yy::parser::make_PLUS_ASSIGN(location()); }
-"-="             { return yy::parser::make_MINUS_ASSIGN(location()); }
-"*="             { return yy::parser::make_STAR_ASSIGN(location()); }
-"/="             { return yy::parser::make_SLASH_ASSIGN(location()); }
-"%="             { return yy::parser::make_PERCENT_ASSIGN(location()); }
-">="             { return yy::parser::make_GTEQ(location()); }
-"<="             { return yy::parser::make_LTEQ(location()); }
-"=="             { return yy::parser::make_EQUALS(location()); }
-"!="             { return yy::parser::make_NEQUALS(location()); }
-"&&"             { return yy::parser::make_AND(location()); }
-"||"             { return yy::parser::make_OR(location()); }
-"!"              { return yy::parser::make_NOT(location()); }
-"="              { return yy::parser::make_ASSIGN(location()); }
-"+"              { return yy::parser::make_PLUS(location()); }
-"-"              { return yy::parser::make_MINUS(location()); }
-"*"              { return yy::parser::make_STAR(location()); }
-"/"              { return yy::parser::make_SLASH(location()); }
-"<"              { return yy::parser::make_LT(location()); }
-">"              { return yy::parser::make_GT(location()); }
-"%"              { return yy::parser::make_PERCENT(location()); }
-"("              { return yy::parser::make_LPARENS(location()); }
-")"              { return yy::parser::make_RPARENS(location()); }
-"{"              { return yy::parser::make_LCURLY(location()); }
-"}"              { return yy::parser::make_RCURLY(location()); }
-";"              { return yy::parser::make_SEMI(location()); }
-":"              { return yy::parser::make_COLON(location()); }
-","              { return yy::parser::make_COMMA(location()); }
+{identifier}     { return look_for_keyword(lexeme(), token_location()); }
+{integer}        { return make_int(token_location()); }
+{float}          { return make_float(token_location()); }
+{char}           { return yy::parser::make_CHAR_LITERAL(parse_char(span()), token_location()); }
+{string}         { return yy::parser::make_STRING_LITERAL(lexeme(), token_location()); }
+"+="             { return yy::parser::make_PLUS_ASSIGN(token_location()); }
+"-="             { return yy::parser::make_MINUS_ASSIGN(token_location()); }
+"*="             { return yy::parser::make_STAR_ASSIGN(token_location()); }
+"/="             { return yy::parser::make_SLASH_ASSIGN(token_location()); }
+"%="             { return yy::parser::make_PERCENT_ASSIGN(token_location()); }
+">="             { return yy::parser::make_GTEQ(token_location()); }
+"<="             { return yy::parser::make_LTEQ(token_location()); }
+"=="             { return yy::parser::make_EQUALS(token_location()); }
+"!="             { return yy::parser::make_NEQUALS(token_location()); }
+"&&"             { return yy::parser::make_AND(token_location()); }
+"||"             { return yy::parser::make_OR(token_location()); }
+"!"              { return yy::parser::make_NOT(token_location()); }
+"="              { return yy::parser::make_ASSIGN(token_location()); }
+"+"              { return yy::parser::make_PLUS(token_location()); }
+"-"              { return yy::parser::make_MINUS(token_location()); }
+"*"              { return yy::parser::make_STAR(token_location()); }
+"/"              { return yy::parser::make_SLASH(token_location()); }
+"<"              { return yy::parser::make_LT(token_location()); }
+">"              { return yy::parser::make_GT(token_location()); }
+"%"              { return yy::parser::make_PERCENT(token_location()); }
+"("              { return yy::parser::make_LPARENS(token_location()); }
+")"              { return yy::parser::make_RPARENS(token_location()); }
+"{"              { return yy::parser::make_LCURLY(token_location()); }
+"}"              { return yy::parser::make_RCURLY(token_location()); }
+";"              { return yy::parser::make_SEMI(token_location()); }
+":"              { return yy::parser::make_COLON(token_location()); }
+","              { return yy::parser::make_COMMA(token_location()); }
 <<EOF>>          { return yy::parser::make_YYEOF(location()); }
-.                { return yy::parser::make_YYUNDEF(location()); }
+.                { return yy::parser::make_YYUNDEF(token_location()); }
 %%
 
 void yy::scanner::init_default_keywords() {
-  this->keyword_map["if"] = keyword::IF;
-  this->keyword_map["else"] = keyword::ELSE;
-  this->keyword_map["while"] = keyword::WHILE;
-  this->keyword_map["return"] = keyword::RETURN;
-  this->keyword_map["goto"] = keyword::GOTO;
-  this->keyword_map["write"] = keyword::WRITE;
-  this->keyword_map["read"] = keyword::READ;
-
-  this->keyword_map["true"] = keyword::TRUE;
-  this->keyword_map["false"] = keyword::FALSE;
+  this->keywords = keyword_table({
+      {symbol("if"), keyword::IF},
+      {symbol("else"), keyword::ELSE},
+      {symbol("while"), keyword::WHILE},
+      {symbol("return"), keyword::RETURN},
+      {symbol("goto"), keyword::GOTO},
+      {symbol("write"), keyword::WRITE},
+      {symbol("read"), keyword::READ},
+
+      {symbol("true"), keyword::TRUE},
+      {symbol("false"), keyword::FALSE},
+  });
 }
 
 yy::parser::symbol_type yy::scanner::make_keyword(keyword k, yy::location loc) {
@@ -123,14 +145,66 @@ yy::parser::symbol_type yy::scanner::make_keyword(keyword k, yy::location loc) {
   }
 }
 
-yy::parser::symbol_type yy::scanner::look_for_keyword(std::string identifier, yy::location loc) {
-  auto found = this->keyword_map.find(identifier);
+std::string_view yy::scanner::lexeme() {
+  if (this->source.data() != nullptr) {
+    return this->source.substr(matcher().first(), size());
+  }
+
+  // The matcher's own buffer moves around, so views into it don't last
+  return this->copies.emplace_back(str());
+}
+
+yy::location yy::scanner::token_location() {
+  yy::location loc;
+  auto line = static_cast<unsigned int>(matcher().lineno());
+  auto column = static_cast<unsigned int>(matcher().columno());
+  auto past = column + static_cast<unsigned int>(matcher().columns());
+
+  loc.begin.filename = loc.end.filename = &this->filename;
+  loc.begin.line = loc.end.line = line;
+  loc.begin.column = column;
+  loc.end.column = past > 0 ? past - 1 : 0;
+  return loc;
+}
 
-  if (found == this->keyword_map.end()) {
-    return yy::parser::make_IDENTIFIER(identifier, loc);
-  } else {
-    auto pair = *found;
-    auto keyword = pair.second;
-    return make_keyword(keyword, loc);
+std::string_view yy::scanner::span() {
+  return std::string_view(matcher().begin(), size());
+}
+
+yy::parser::symbol_type yy::scanner::make_int(yy::location loc) {
+  auto value = parse_int(span());
+
+  if (!value.has_value()) {
+    throw yy::parser::syntax_error(loc, "Integer `" + str() + "` is too big.");
   }
+
+  return yy::parser::make_INT_LITERAL(value.value(), loc);
+}
+
+yy::parser::symbol_type yy::scanner::make_float(yy::location loc) {
+  auto value = parse_float(span());
+
+  if (!value.has_value()) {
+    throw yy::parser::syntax_error(loc, "Float `" + str() + "` is too big.");
+  }
+
+  return yy::parser::make_FLOAT_LITERAL(value.value(), loc);
+}
+
+yy::parser::symbol_type yy::scanner::look_for_keyword(std::string_view identifier, yy::location loc) {
+  // Keywords are always interned, so others needn't be before they're known
+  // not to be one
+  auto name = symbol::find(identifier);
+
+  if (!name.has_value()) {
+    return yy::parser::make_IDENTIFIER(symbol(identifier), loc);
+  }
+
+  auto found = this->keywords.find(name.value());
+
+  if (!found.has_value()) {
+    return yy::parser::make_IDENTIFIER(name.value(), loc);
+  }
+
+  return make_keyword(found.value(), loc);
 }
@@ -1,10 +1,125 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
 #include <parser/literals.h>
 
-std::int64_t parse_int(std::string lexeme) { return std::stoll(lexeme); }
-double parse_float(std::string lexeme) { return std::stod(lexeme); }
+// Turns 8 ASCII digits into their value all at once, with a few
+// multiplications over a 64-bit word instead of one per digit.
+// http://0x80.pl/articles/simd-parsing-int-sequences.html
+static std::uint64_t parse_eight_digits(const char *digits) {
+  std::uint64_t chunk;
+  std::memcpy(&chunk, digits, sizeof(chunk));
+
+  // Each byte from '0'-'9' to 0-9, first digit in the lowest byte
+  chunk -= 0x3030303030303030;
+
+  // Pairs, then groups of four, then all eight
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+           (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+          32;
+
+  return chunk;
+}
+
+// The lexer only gives us digits
+std::optional<std::int64_t> parse_int(std::string_view lexeme) {
+  auto first = lexeme.find_first_not_of('0');
+  if (first == std::string_view::npos) {
+    return 0;
+  }
+
+  auto digits = lexeme.substr(first);
+
+  // 19 digits always fit in 64 unsigned bits, so only one check at the end
+  if (digits.size() > std::numeric_limits<std::int64_t>::digits10 + 1) {
+    return std::nullopt;
+  }
+
+  std::uint64_t value = 0;
+  std::size_t i = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for (; i + 8 <= digits.size(); i += 8) {
+    value = value * 100000000 + parse_eight_digits(digits.data() + i);
+  }
+#endif
+
+  for (; i < digits.size(); ++i) {
+    value = value * 10 + (digits[i] - '0');
+  }
+
+  if (value > std::uint64_t(std::numeric_limits<std::int64_t>::max())) {
+    return std::nullopt;
+  }
+
+  return value;
+}
+
+// Where the first significant digit of a float literal is, as a power of ten:
+// 1 for "1.5", 0 for ".5", -1 for "0.005e1". Positive if it's too big to fit
+static std::int64_t decimal_magnitude(std::string_view lexeme) {
+  auto exponent_at = lexeme.find_first_of("eE");
+  auto mantissa = lexeme.substr(0, exponent_at);
+  auto point = std::min(mantissa.find('.'), mantissa.size());
+
+  std::int64_t magnitude;
+  auto first = mantissa.find_first_not_of("0.");
+
+  if (first == std::string_view::npos) {
+    // Zero, which always fits
+    return std::numeric_limits<std::int64_t>::min();
+  } else if (first < point) {
+    magnitude = point - first;
+  } else {
+    magnitude = -std::int64_t(first - point - 1);
+  }
+
+  if (exponent_at == std::string_view::npos) {
+    return magnitude;
+  }
+
+  auto exponent = lexeme.substr(exponent_at + 1);
+  bool negative = exponent[0] == '-';
+  if (exponent[0] == '-' || exponent[0] == '+') {
+    exponent.remove_prefix(1);
+  }
+
+  // Way past what a double holds either way, and no overflow below
+  constexpr std::int64_t cap = 1000000000;
+  std::int64_t value = 0;
+
+  for (auto digit : exponent) {
+    value = std::min(value * 10 + (digit - '0'), cap);
+  }
+
+  return magnitude + (negative ? -value : value);
+}
+
+std::optional<double> parse_float(std::string_view lexeme) {
+  double value = 0;
+  auto end = lexeme.data() + lexeme.size();
+  auto [ptr, error] = std::from_chars(lexeme.data(), end, value);
+
+  if (error == std::errc::result_out_of_range) {
+    // Too small is just zero, like in C
+    if (decimal_magnitude(lexeme) <= 0) {
+      return 0.0;
+    }
+
+    return std::nullopt;
+  }
+
+  if (error != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+
+  return value;
+}
 
 // TODO: Char = Grapheme
-char parse_char(std::string lexeme) { return lexeme.at(1); }
+char parse_char(std::string_view lexeme) { return lexeme.at(1); }
 
 #define ESCAPE_CASE(Char, Escaped)                                             \
   case Char:                                                                   \
@@ -12,7 +127,7 @@ char parse_char(std::string lexeme) { return lexeme.at(1); }
     continue
 
 // Translate escape sequences
-std::string parse_string(std::string lexeme) {
+std::string parse_string(std::string_view lexeme) {
   std::string building;
   bool escaped = false;
 
@@ -2,13 +2,16 @@
 #define LITERALS_H
 
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 
-// Literal sub-parser
+// Literal sub-parser. These work on the lexeme wherever it is, without copying
+// it. Numbers are empty if they don't fit
 
-std::int64_t parse_int(std::string lexeme);
-double parse_float(std::string lexeme);
-char parse_char(std::string lexeme);
-std::string parse_string(std::string lexeme);
+std::optional<std::int64_t> parse_int(std::string_view lexeme);
+std::optional<double> parse_float(std::string_view lexeme);
+char parse_char(std::string_view lexeme);
+std::string parse_string(std::string_view lexeme);
 
 #endif /* LITERALS_H */
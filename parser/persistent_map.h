@@ -0,0 +1,130 @@
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include "common/interner.h"
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A map from names that never changes: `insert` makes a new version, which
+// shares all but the nodes on one path with the old one. So keeping a version
+// around is one pointer, and making one is a handful of small copies.
+//
+// A hash array mapped trie, five bits of the hash per level. The hash of an
+// id is a bijection, so two names always part ways by the last level and
+// there's no need for collision nodes
+template <typename V> class persistent_map {
+private:
+  struct node;
+
+  struct slot {
+    // A leaf if `child` is null
+    symbol_id key;
+    V value;
+    std::shared_ptr<const node> child;
+  };
+
+  struct node {
+    // Which of the 32 slots are in `slots`, in order
+    std::uint32_t bitmap = 0;
+    std::vector<slot> slots;
+  };
+
+  std::shared_ptr<const node> root;
+  std::size_t count = 0;
+
+  static std::uint32_t hash_of(symbol_id key) {
+    return key * std::uint32_t(2654435769u);
+  }
+
+  static std::uint32_t bit_of(std::uint32_t hash, unsigned level) {
+    return std::uint32_t(1) << ((hash >> (5 * level)) & 31);
+  }
+
+  static unsigned position_of(const node &n, std::uint32_t bit) {
+    return std::popcount(n.bitmap & (bit - 1));
+  }
+
+  // A node with both leaves, from `level` down
+  static std::shared_ptr<const node> join(const slot &a, const slot &b,
+                                          unsigned level) {
+    auto joined = std::make_shared<node>();
+    auto a_bit = bit_of(hash_of(a.key), level);
+    auto b_bit = bit_of(hash_of(b.key), level);
+
+    if (a_bit == b_bit) {
+      joined->bitmap = a_bit;
+      joined->slots.push_back({0, V(), join(a, b, level + 1)});
+    } else {
+      joined->bitmap = a_bit | b_bit;
+      joined->slots.push_back(a_bit < b_bit ? a : b);
+      joined->slots.push_back(a_bit < b_bit ? b : a);
+    }
+
+    return joined;
+  }
+
+  static std::shared_ptr<const node> insert(const node &n, const slot &leaf,
+                                            unsigned level, bool &added) {
+    auto copy = std::make_shared<node>(n);
+    auto bit = bit_of(hash_of(leaf.key), level);
+    auto at = copy->slots.begin() + position_of(n, bit);
+
+    if ((n.bitmap & bit) == 0) {
+      copy->bitmap |= bit;
+      copy->slots.insert(at, leaf);
+      added = true;
+    } else if (at->child != nullptr) {
+      at->child = insert(*at->child, leaf, level + 1, added);
+    } else if (at->key == leaf.key) {
+      at->value = leaf.value;
+    } else {
+      *at = {0, V(), join(*at, leaf, level + 1)};
+      added = true;
+    }
+
+    return copy;
+  }
+
+public:
+  // Null if not there
+  const V *find(symbol key) const {
+    auto hash = hash_of(key.get_id());
+    auto n = this->root.get();
+
+    for (unsigned level = 0; n != nullptr; ++level) {
+      auto bit = bit_of(hash, level);
+
+      if ((n->bitmap & bit) == 0) {
+        return nullptr;
+      }
+
+      auto &found = n->slots[position_of(*n, bit)];
+
+      if (found.child == nullptr) {
+        return found.key == key.get_id() ? &found.value : nullptr;
+      }
+
+      n = found.child.get();
+    }
+
+    return nullptr;
+  }
+
+  // With `key` set to `value`, replacing what it was
+  persistent_map insert(symbol key, V value) const {
+    static const node empty;
+
+    persistent_map next;
+    bool added = false;
+    next.root = insert(this->root != nullptr ? *this->root : empty,
+                       {key.get_id(), value, nullptr}, 0, added);
+    next.count = this->count + (added ? 1 : 0);
+    return next;
+  }
+
+  std::size_t size() const { return this->count; }
+};
+
+#endif /* PERSISTENT_MAP_H */
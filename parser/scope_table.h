@@ -0,0 +1,130 @@
+#ifndef SCOPE_TABLE_H
+#define SCOPE_TABLE_H
+
+#include "common/interner.h"
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// What one scope declares, by name. Entries are found through an open
+// addressing table of symbol ids, and never move once inserted since the tree
+// points to them. Iterates in the order things were declared.
+//
+// `T` needs a `name` symbol. An empty scope allocates nothing, which matters
+// when there's one per block
+template <typename T> class scope_table {
+private:
+  struct slot {
+    symbol_id id;
+    std::uint32_t index;
+  };
+
+  static constexpr std::uint32_t no_entry = UINT32_MAX;
+
+  std::vector<std::unique_ptr<T>> entries;
+  std::vector<slot> slots;
+  // Of the hash, so that its top bits pick the slot
+  unsigned shift = 32;
+
+  std::size_t slot_of(symbol_id id) const {
+    // Fibonacci hashing, since ids are handed out one after the other
+    return (id * std::uint32_t(2654435769u)) >> this->shift;
+  }
+
+  void grow() {
+    auto capacity = this->slots.empty() ? 8 : this->slots.size() * 2;
+    this->shift = 32 - std::countr_zero(capacity);
+    this->slots.assign(capacity, {0, no_entry});
+
+    for (std::uint32_t i = 0; i < this->entries.size(); ++i) {
+      this->place(this->entries[i]->name.get_id(), i);
+    }
+  }
+
+  void place(symbol_id id, std::uint32_t index) {
+    auto mask = this->slots.size() - 1;
+    auto at = this->slot_of(id);
+
+    while (this->slots[at].index != no_entry) {
+      at = (at + 1) & mask;
+    }
+
+    this->slots[at] = {id, index};
+  }
+
+public:
+  template <typename V, typename Base> class basic_iterator {
+  private:
+    Base at;
+
+  public:
+    basic_iterator(Base at) : at(at) {}
+
+    V &operator*() const { return **this->at; }
+    V *operator->() const { return this->at->get(); }
+
+    basic_iterator &operator++() {
+      ++this->at;
+      return *this;
+    }
+
+    bool operator==(const basic_iterator &other) const = default;
+  };
+
+  typedef basic_iterator<
+      T, typename std::vector<std::unique_ptr<T>>::const_iterator>
+      iterator;
+  typedef basic_iterator<
+      const T, typename std::vector<std::unique_ptr<T>>::const_iterator>
+      const_iterator;
+
+  // Null if not there
+  T *find(symbol name) const {
+    if (this->slots.empty()) {
+      return nullptr;
+    }
+
+    auto mask = this->slots.size() - 1;
+    auto id = name.get_id();
+
+    for (auto at = this->slot_of(id); this->slots[at].index != no_entry;
+         at = (at + 1) & mask) {
+      if (this->slots[at].id == id) {
+        return this->entries[this->slots[at].index].get();
+      }
+    }
+
+    return nullptr;
+  }
+
+  // Null if there's one with that name already
+  T *insert(T entry) {
+    if (this->find(entry.name) != nullptr) {
+      return nullptr;
+    }
+
+    // At most three quarters full
+    if ((this->entries.size() + 1) * 4 > this->slots.size() * 3) {
+      this->grow();
+    }
+
+    std::uint32_t index = this->entries.size();
+    auto &stored = this->entries.emplace_back(
+        std::make_unique<T>(std::move(entry)));
+    this->place(stored->name.get_id(), index);
+    return stored.get();
+  }
+
+  std::size_t size() const { return this->entries.size(); }
+  bool empty() const { return this->entries.empty(); }
+
+  iterator begin() { return iterator(this->entries.cbegin()); }
+  iterator end() { return iterator(this->entries.cend()); }
+  const_iterator begin() const {
+    return const_iterator(this->entries.cbegin());
+  }
+  const_iterator end() const { return const_iterator(this->entries.cend()); }
+};
+
+#endif /* SCOPE_TABLE_H */
@@ -9,9 +9,11 @@ std::ostream &operator<<(std::ostream &o, const var_table_entry &a) {
            << "]";
 }
 
-symbol_table::symbol_table() : parent(std::nullopt), offset_counter(0) {}
+symbol_table::symbol_table()
+    : offset_counter(0), root(this), parent(std::nullopt) {}
 symbol_table::symbol_table(std::shared_ptr<symbol_table> parent)
-    : parent(parent) {
+    : offset_counter(0), root(parent->root), visible(parent->visible),
+      parent(parent) {
   parent->add_child(this);
 }
 
@@ -25,20 +27,22 @@ std::vector<symbol_table *> &symbol_table::get_children() {
 
 size_t symbol_table::size() { return locals.size() + types.size(); }
 
-std::shared_ptr<variable_map> symbol_table::vars() {
-  auto new_map = std::make_shared<variable_map>();
-  new_map->insert(this->locals.begin(), this->locals.end());
-  return new_map;
+variable_map &symbol_table::vars() { return this->locals; }
+
+scope_snapshot symbol_table::snapshot() const { return this->visible; }
+
+scope_snapshot symbol_table::get_prelude() { return this->root->prelude; }
+
+void symbol_table::restore(scope_snapshot snapshot) {
+  this->visible = snapshot;
 }
 
 std::optional<var_table_entry *>
-symbol_table::insert_var(std::string name, yy::location loc,
+symbol_table::insert_var(symbol name, yy::location loc,
                          type_table_entry *type, variable_map *map) {
   // Check for redeclaration of the same symbol
   // Local variables and parameters share the same namespace
-  auto maybe_local = this->locals.find(name);
-
-  if (maybe_local != map->end()) {
+  if (map->find(name) != nullptr) {
     return std::nullopt;
   }
 
@@ -50,23 +54,25 @@ symbol_table::insert_var(std::string name, yy::location loc,
 
   inc_offset(type->value->size());
 
-  (*map)[name] = entry;
-  return &(*map)[name];
+  auto inserted = map->insert(entry);
+  if (map == &this->locals) {
+    this->visible.vars = this->visible.vars.insert(name, inserted);
+  }
+
+  return inserted;
 }
 
 std::optional<var_table_entry *>
-symbol_table::insert_variable(std::string name, yy::location loc,
+symbol_table::insert_variable(symbol name, yy::location loc,
                               type_table_entry *type) {
   return insert_var(name, loc, type, &this->locals);
 }
 
 std::optional<type_table_entry *>
-symbol_table::insert_type(std::string name, yy::location loc,
+symbol_table::insert_type(symbol name, yy::location loc,
                           std::shared_ptr<type> value) {
   // Check for redeclaration of the same symbol in the same context
-  auto maybe_found = this->types.find(name);
-
-  if (maybe_found != this->types.end()) {
+  if (this->types.find(name) != nullptr) {
     return std::nullopt;
   }
 
@@ -75,65 +81,58 @@ symbol_table::insert_type(std::string name, yy::location loc,
   entry.declared_at = loc;
   entry.value = value;
 
-  this->types[name] = entry;
-  return &this->types[name];
+  auto inserted = this->types.insert(entry);
+  this->visible.types = this->visible.types.insert(name, inserted);
+  return inserted;
 }
 
-std::optional<var_table_entry *> symbol_table::get_var(std::string name,
-                                                       variable_map *map) {
-  auto maybe_found = map->find(name);
+std::optional<var_table_entry *> symbol_table::get_var(symbol name) {
+  auto found = this->visible.vars.find(name);
 
-  if (maybe_found != map->end()) {
-    return &maybe_found->second;
+  if (found != nullptr) {
+    return *found;
   }
 
   return std::nullopt;
 }
 
-std::optional<var_table_entry *> symbol_table::get_var(std::string name) {
-  auto var = get_var(name, &this->locals);
+std::optional<type_table_entry *> symbol_table::get_type(symbol name) {
+  auto found = this->visible.types.find(name);
 
-  if (var.has_value()) {
-    return var;
-  }
-
-  if (parent.has_value()) {
-    return parent.value()->get_var(name);
+  if (found != nullptr) {
+    return *found;
   }
 
   return std::nullopt;
 }
 
-std::optional<type_table_entry *> symbol_table::get_type(std::string name) {
-  auto maybe_found = this->types.find(name);
-
-  if (maybe_found != this->types.end()) {
-    return &maybe_found->second;
-  }
+std::optional<var_table_entry *> symbol_table::get_var(std::string_view name) {
+  auto interned = symbol::find(name);
 
-  if (parent.has_value()) {
-    return parent.value()->get_type(name);
+  if (!interned.has_value()) {
+    return std::nullopt;
   }
 
-  return std::nullopt;
+  return this->get_var(interned.value());
 }
 
-symbol_table *symbol_table::get_root() {
-  auto current = this;
-  auto next = current->parent;
+std::optional<type_table_entry *>
+symbol_table::get_type(std::string_view name) {
+  auto interned = symbol::find(name);
 
-  while (next.has_value()) {
-    current = next.value().get();
-    next = current->parent;
+  if (!interned.has_value()) {
+    return std::nullopt;
   }
 
-  return current;
+  return this->get_type(interned.value());
 }
 
-std::string default_filename = "prelude";
+symbol_table *symbol_table::get_root() { return this->root; }
 
 yy::location symbol_table::default_location() {
-  return yy::location(&default_filename, 0, 0);
+  // Never changes, so every thread can point to it
+  static const std::string filename = "prelude";
+  return yy::location(&filename, 0, 0);
 }
 
 std::uint64_t symbol_table::get_offset() {
@@ -145,59 +144,62 @@ void symbol_table::inc_offset(std::uint64_t amount) {
 }
 
 std::optional<var_table_entry *>
-symbol_table::insert_default_var(std::string name, yy::location loc,
+symbol_table::insert_default_var(symbol name, yy::location loc,
                                  type_table_entry *type) {
   auto root = get_root();
   auto entry = root->insert_variable(name, loc, type);
-  root->default_vars[name] = *entry.value();
+  root->default_vars.insert(*entry.value());
   return entry;
 }
 
 std::optional<type_table_entry *>
-symbol_table::insert_default_type(std::string name, yy::location loc,
+symbol_table::insert_default_type(symbol name, yy::location loc,
                                   std::shared_ptr<type> value) {
   auto root = get_root();
   auto entry = root->insert_type(name, loc, value);
-  root->default_types[name] = *entry.value();
+  root->default_types.insert(*entry.value());
   return entry;
 }
 
 void symbol_table::init_default_symbols() {
   auto root = get_root();
-  root->insert_default_type("int", default_location(),
-                            std::make_shared<type_int>());
-  root->insert_default_type("float", default_location(),
-                            std::make_shared<type_float>());
-  root->insert_default_type("boolean", default_location(),
-                            std::make_shared<type_boolean>());
-  root->insert_default_type("char", default_location(),
-                            std::make_shared<type_char>());
-  root->insert_default_type("function", default_location(),
-                            std::make_shared<type_function>());
-  root->insert_default_type("void", default_location(),
-                            std::make_shared<type_void>());
-}
-
-var_table_entry *symbol_table::get_default_var(std::string name) {
+  auto &types = type_context::global();
+  root->insert_default_type(symbol("int"), default_location(),
+                            types.int_type());
+  root->insert_default_type(symbol("float"), default_location(),
+                            types.float_type());
+  root->insert_default_type(symbol("boolean"), default_location(),
+                            types.boolean_type());
+  root->insert_default_type(symbol("char"), default_location(),
+                            types.char_type());
+  root->insert_default_type(symbol("function"), default_location(),
+                            types.function_type());
+  root->insert_default_type(symbol("void"), default_location(),
+                            types.void_type());
+  root->prelude = root->visible;
+}
+
+var_table_entry *symbol_table::get_default_var(symbol name) {
   auto root = get_root();
-  auto maybe_found = root->default_vars.find(name);
+  auto found = root->default_vars.find(name);
 
-  if (maybe_found != root->default_vars.end()) {
-    return &maybe_found->second;
+  if (found != nullptr) {
+    return found;
   }
 
-  throw std::runtime_error("No default variable named " + name);
+  throw std::runtime_error("No default variable named " +
+                           std::string(name.text()));
 }
 
-type_table_entry *symbol_table::get_default_type(std::string name) {
+type_table_entry *symbol_table::get_default_type(symbol name) {
   auto root = get_root();
-  auto maybe_found = root->default_types.find(name);
+  auto found = root->default_types.find(name);
 
-  if (maybe_found != root->default_types.end()) {
-    return &maybe_found->second;
+  if (found != nullptr) {
+    return found;
   }
 
-  throw std::runtime_error("No default type named " + name);
+  throw std::runtime_error("No default type named " + std::string(name.text()));
 }
 
 std::ostream &operator<<(std::ostream &o, const symbol_table &a) {
@@ -207,14 +209,12 @@ std::ostream &operator<<(std::ostream &o, const symbol_table &a) {
   auto types_end = a.types.end();
 
   if (types_it != types_end) {
-    auto [_, val] = *types_it;
-    o << val;
+    o << *types_it;
     ++types_it;
   }
 
   for (; types_it != types_end; ++types_it) {
-    auto [_, val] = *types_it;
-    o << ", " << val;
+    o << ", " << *types_it;
   }
 
   o << " | LOCALS: ";
@@ -223,14 +223,12 @@ std::ostream &operator<<(std::ostream &o, const symbol_table &a) {
   auto locals_end = a.locals.end();
 
   if (locals_it != locals_end) {
-    auto [_, val] = *locals_it;
-    o << val;
+    o << *locals_it;
     ++locals_it;
   }
 
   for (; locals_it != locals_end; ++locals_it) {
-    auto [_, val] = *locals_it;
-    o << ", " << val;
+    o << ", " << *locals_it;
   }
 
   return o << "}";
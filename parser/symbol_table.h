@@ -2,17 +2,20 @@
 #define SYMBOL_TABLE_H
 
 #include "cinttypes"
+#include "common/interner.h"
+#include "parser/persistent_map.h"
+#include "parser/scope_table.h"
 #include "parser/syntax/location.hpp"
 #include "parser/types.h"
-#include <map>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 class ast_node;
 
 struct type_table_entry {
-  std::string name;
+  symbol name;
   yy::location declared_at;
   std::shared_ptr<type> value;
 
@@ -23,12 +26,12 @@ struct var_table_entry;
 
 struct function_data {
   std::shared_ptr<type> return_type;
-  std::shared_ptr<ast_node> body;
+  ast_node *body;
   std::vector<var_table_entry *> parameters;
 };
 
 struct var_table_entry {
-  std::string name;
+  symbol name;
   yy::location declared_at;
   type_table_entry *type;
   std::shared_ptr<function_data> fn_data;
@@ -37,16 +40,33 @@ struct var_table_entry {
   friend std::ostream &operator<<(std::ostream &o, const var_table_entry &a);
 };
 
-typedef std::map<std::string, var_table_entry> variable_map;
-typedef std::map<std::string, type_table_entry> type_map;
+// Keyed by interned names, so lookups only compare integers
+typedef scope_table<var_table_entry> variable_map;
+typedef scope_table<type_table_entry> type_map;
+
+// Every name visible at some point, which later declarations don't change.
+// Cheap to copy and keep around, since versions share most of their nodes
+struct scope_snapshot {
+  persistent_map<var_table_entry *> vars;
+  persistent_map<type_table_entry *> types;
+};
 
 class symbol_table {
 private:
+  // Only the root's counts, and every table knows its root so that declaring
+  // something doesn't walk up the scopes
   std::uint64_t offset_counter;
+  symbol_table *root;
 
   variable_map locals;
   type_map types;
 
+  // What this scope sees, its parents' names included as of when it was
+  // made, so lookups don't walk up the scopes
+  scope_snapshot visible;
+  // The root's, right after the default symbols
+  scope_snapshot prelude;
+
   std::optional<std::shared_ptr<symbol_table>> parent;
   std::vector<symbol_table *> children;
 
@@ -59,21 +79,18 @@ private:
   std::uint64_t get_offset();
   void inc_offset(std::uint64_t amount);
 
-  std::optional<var_table_entry *> insert_default_var(std::string name,
+  std::optional<var_table_entry *> insert_default_var(symbol name,
                                                       yy::location loc,
                                                       type_table_entry *type);
 
   std::optional<type_table_entry *>
-  insert_default_type(std::string name, yy::location loc,
+  insert_default_type(symbol name, yy::location loc,
                       std::shared_ptr<type> value);
 
-  std::optional<var_table_entry *> insert_var(std::string name,
-                                              yy::location loc,
+  std::optional<var_table_entry *> insert_var(symbol name, yy::location loc,
                                               type_table_entry *type,
                                               variable_map *map);
 
-  std::optional<var_table_entry *> get_var(std::string name, variable_map *map);
-
 public:
   symbol_table();
   symbol_table(std::shared_ptr<symbol_table> parent);
@@ -84,21 +101,33 @@ public:
   void init_default_symbols();
   size_t size();
 
-  var_table_entry *get_default_var(std::string name);
-  type_table_entry *get_default_type(std::string name);
+  var_table_entry *get_default_var(symbol name);
+  type_table_entry *get_default_type(symbol name);
+
+  // Declared in this scope only, in order
+  variable_map &vars();
 
-  std::shared_ptr<variable_map> vars();
+  scope_snapshot snapshot() const;
+  scope_snapshot get_prelude();
+  // Sees only what `snapshot` has until restored again. Scopes made meanwhile
+  // start from it too, so that statements can be parsed again as if what was
+  // declared after them wasn't there yet
+  void restore(scope_snapshot snapshot);
 
   // Empty if already exists
-  std::optional<var_table_entry *>
-  insert_variable(std::string name, yy::location loc, type_table_entry *type);
+  std::optional<var_table_entry *> insert_variable(symbol name,
+                                                   yy::location loc,
+                                                   type_table_entry *type);
 
-  std::optional<type_table_entry *>
-  insert_type(std::string name, yy::location loc, std::shared_ptr<type> value);
+  std::optional<type_table_entry *> insert_type(symbol name, yy::location loc,
+                                                std::shared_ptr<type> value);
 
   // Empty if does not exist
-  std::optional<var_table_entry *> get_var(std::string name);
-  std::optional<type_table_entry *> get_type(std::string name);
+  std::optional<var_table_entry *> get_var(symbol name);
+  std::optional<type_table_entry *> get_type(symbol name);
+  // Same, without interning `name`
+  std::optional<var_table_entry *> get_var(std::string_view name);
+  std::optional<type_table_entry *> get_type(std::string_view name);
 
   friend std::ostream &operator<<(std::ostream &o, const symbol_table &a);
 };
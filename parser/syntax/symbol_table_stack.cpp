@@ -6,6 +6,10 @@ symbol_table_stack::symbol_table_stack() {
   tables.push_back(root_table);
 }
 
+symbol_table_stack::symbol_table_stack(std::shared_ptr<symbol_table> current) {
+  tables.push_back(current);
+}
+
 std::shared_ptr<symbol_table> symbol_table_stack::current() {
   return tables.back();
 }
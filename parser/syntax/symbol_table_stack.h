@@ -18,6 +18,8 @@ private:
 
 public:
   symbol_table_stack();
+  // Starts in `current` instead of a new root table
+  symbol_table_stack(std::shared_ptr<symbol_table> current);
   ~symbol_table_stack();
 
   std::shared_ptr<symbol_table> current();
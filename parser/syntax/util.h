@@ -1,48 +1,45 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include "parser/ast_arena.h"
 #include "parser/syntax/symbol_table_stack.h"
 #include <memory>
 
-// To keep the grammar file mostly clean
-
-std::shared_ptr<ast_node> declare_var(std::shared_ptr<symbol_table> table,
-                                      std::string type, std::string name,
-                                      yy::location loc);
-std::shared_ptr<ast_node>
-declare_assign_var(std::shared_ptr<symbol_table> table, std::string type,
-                   std::string name, std::shared_ptr<ast_node> value,
-                   yy::location loc);
-
-std::shared_ptr<ast_node> declare_struct(std::shared_ptr<symbol_table> table,
-                                         std::string name, yy::location loc);
-std::shared_ptr<ast_node> declare_typedef(std::shared_ptr<symbol_table> table,
-                                          std::string name,
-                                          std::string original,
-                                          yy::location loc);
-
-type_table_entry *get_type(std::shared_ptr<symbol_table> table,
-                           std::string name, yy::location loc);
-var_table_entry *get_var(std::shared_ptr<symbol_table> table, std::string name,
+// To keep the grammar file mostly clean. Nodes are made in `arena`
+
+ast_node *declare_var(ast_arena &arena, std::shared_ptr<symbol_table> table,
+                      symbol type, symbol name, yy::location loc);
+ast_node *declare_assign_var(ast_arena &arena,
+                             std::shared_ptr<symbol_table> table, symbol type,
+                             symbol name, ast_node *value, yy::location loc);
+
+ast_node *declare_struct(ast_arena &arena, std::shared_ptr<symbol_table> table,
+                         symbol name, yy::location loc);
+ast_node *declare_typedef(ast_arena &arena,
+                          std::shared_ptr<symbol_table> table, symbol name,
+                          symbol original, yy::location loc);
+
+type_table_entry *get_type(std::shared_ptr<symbol_table> table, symbol name,
+                           yy::location loc);
+var_table_entry *get_var(std::shared_ptr<symbol_table> table, symbol name,
                          yy::location loc);
 
-std::shared_ptr<ast_node> use_var(std::shared_ptr<symbol_table> table,
-                                  std::string name, yy::location loc);
-std::shared_ptr<ast_node> use_type(std::shared_ptr<symbol_table> table,
-                                   std::string name, yy::location loc);
+ast_node *use_var(ast_arena &arena, std::shared_ptr<symbol_table> table,
+                  symbol name, yy::location loc);
+ast_node *use_type(ast_arena &arena, std::shared_ptr<symbol_table> table,
+                   symbol name, yy::location loc);
 
 // Set the parameters on the stack so that the next block will contain them
-std::shared_ptr<ast_node> set_parameters(symbol_table_stack &stack,
-                                         std::shared_ptr<ast_node> list);
-
-std::shared_ptr<ast_node>
-declare_function(std::shared_ptr<symbol_table> table, std::string return_type,
-                 std::string name, std::shared_ptr<ast_node> parameters,
-                 std::shared_ptr<ast_node> body, yy::location loc);
-
-std::shared_ptr<ast_node> invoke_function(std::shared_ptr<symbol_table> table,
-                                          std::string name,
-                                          std::shared_ptr<ast_node> arguments,
-                                          yy::location loc);
+ast_node *set_parameters(ast_arena &arena, symbol_table_stack &stack,
+                         ast_node *list);
+
+ast_node *declare_function(ast_arena &arena,
+                           std::shared_ptr<symbol_table> table,
+                           symbol return_type, symbol name,
+                           ast_node *parameters, ast_node *body,
+                           yy::location loc);
+
+ast_node *invoke_function(ast_arena &arena, std::shared_ptr<symbol_table> table,
+                          symbol name, ast_node *arguments, yy::location loc);
 
 #endif /* UTIL_H */
@@ -1,4 +1,5 @@
 #include "parser/types.h"
+#include <mutex>
 
 #define X(Enum, Name) Name,
 char const *type_kind_names[] = {TYPE_KINDS};
@@ -10,7 +11,7 @@ std::ostream &operator<<(std::ostream &o, const type_kind &a) {
 
 type::type(type_kind kind) : kind(kind) {}
 
-bool type::matches(type &other) { return this->kind == other.kind; }
+bool type::matches(const type &other) const { return this == &other; }
 size_t type::size() { return 0; }
 
 type_void::type_void() : type(type_kind::VOID) {}
@@ -66,11 +67,6 @@ size_t type_struct::size() {
   return 0;
 }
 
-bool type_struct::matches(type &other) {
-  // TODO
-  return true;
-}
-
 std::ostream &type_struct::extract(std::ostream &o) const {
   return o << "struct";
 }
@@ -80,15 +76,6 @@ type_pointer::type_pointer(std::shared_ptr<type> of)
 
 size_t type_pointer::size() { return 8; }
 
-bool type_pointer::matches(type &other) {
-  if (this->kind != other.kind) {
-    return false;
-  }
-
-  auto other_ptr = (type_pointer &)other;
-  return of->matches(*other_ptr.of);
-}
-
 std::ostream &type_pointer::extract(std::ostream &o) const {
   return o << "ptr<" << of << ">";
 }
@@ -102,3 +89,64 @@ bool is_integral(type &t) {
 }
 
 bool is_pointer(type &t) { return t.kind == type_kind::POINTER; }
+
+type_context::type_context()
+    : void_typ(new type_void()), error_typ(new type_error()),
+      int_typ(new type_int()), float_typ(new type_float()),
+      boolean_typ(new type_boolean()), char_typ(new type_char()),
+      function_typ(new type_function()) {}
+
+const std::shared_ptr<type> &type_context::void_type() const {
+  return this->void_typ;
+}
+
+const std::shared_ptr<type> &type_context::error_type() const {
+  return this->error_typ;
+}
+
+const std::shared_ptr<type> &type_context::int_type() const {
+  return this->int_typ;
+}
+
+const std::shared_ptr<type> &type_context::float_type() const {
+  return this->float_typ;
+}
+
+const std::shared_ptr<type> &type_context::boolean_type() const {
+  return this->boolean_typ;
+}
+
+const std::shared_ptr<type> &type_context::char_type() const {
+  return this->char_typ;
+}
+
+const std::shared_ptr<type> &type_context::function_type() const {
+  return this->function_typ;
+}
+
+std::shared_ptr<type>
+type_context::pointer_to(const std::shared_ptr<type> &of) {
+  {
+    std::shared_lock lock(this->mutex);
+    auto found = this->pointers.find(of.get());
+
+    if (found != this->pointers.end()) {
+      return found->second;
+    }
+  }
+
+  std::unique_lock lock(this->mutex);
+  auto &pointer = this->pointers[of.get()];
+
+  // Someone else may have made it in between
+  if (!pointer) {
+    pointer = std::shared_ptr<type>(new type_pointer(of));
+  }
+
+  return pointer;
+}
+
+type_context &type_context::global() {
+  static type_context instance;
+  return instance;
+}
@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 
 #define TYPE_KINDS                                                             \
   X(VOID, "void")                                                              \
@@ -30,7 +32,8 @@ public:
 
   type(type_kind kind);
 
-  virtual bool matches(type &other);
+  // There's only ever one of each type, see `type_context`
+  bool matches(const type &other) const;
   virtual size_t size();
 
   friend std::ostream &operator<<(std::ostream &o, const type &a);
@@ -44,10 +47,12 @@ bool is_pointer(type &t);
   class type_##Name : public type {                                            \
   private:                                                                     \
     virtual std::ostream &extract(std::ostream &o) const;                      \
+    type_##Name();                                                             \
                                                                                \
   public:                                                                      \
-    type_##Name();                                                             \
     virtual size_t size();                                                     \
+                                                                               \
+    friend class type_context;                                                 \
   }
 
 BASIC_TYPE(void);
@@ -65,7 +70,6 @@ private:
 public:
   type_struct();
 
-  bool matches(type &other);
   virtual size_t size();
 };
 
@@ -74,11 +78,45 @@ private:
   std::ostream &extract(std::ostream &o) const;
   std::shared_ptr<type> of;
 
-public:
   type_pointer(std::shared_ptr<type> of);
 
-  bool matches(type &other);
+public:
   virtual size_t size();
+
+  friend class type_context;
+};
+
+// Hands out the one instance of each type, so that types can be compared by
+// address. Pointer types are made the first time they're asked for. Safe to
+// share between threads
+class type_context {
+private:
+  std::shared_ptr<type> void_typ;
+  std::shared_ptr<type> error_typ;
+  std::shared_ptr<type> int_typ;
+  std::shared_ptr<type> float_typ;
+  std::shared_ptr<type> boolean_typ;
+  std::shared_ptr<type> char_typ;
+  std::shared_ptr<type> function_typ;
+
+  mutable std::shared_mutex mutex;
+  // By what they point to
+  std::unordered_map<const type *, std::shared_ptr<type>> pointers;
+
+public:
+  type_context();
+
+  const std::shared_ptr<type> &void_type() const;
+  const std::shared_ptr<type> &error_type() const;
+  const std::shared_ptr<type> &int_type() const;
+  const std::shared_ptr<type> &float_type() const;
+  const std::shared_ptr<type> &boolean_type() const;
+  const std::shared_ptr<type> &char_type() const;
+  const std::shared_ptr<type> &function_type() const;
+
+  std::shared_ptr<type> pointer_to(const std::shared_ptr<type> &of);
+
+  static type_context &global();
 };
 
 #endif /* TYPES_H */
@@ -1,8 +1,10 @@
 #ifdef __EMSCRIPTEN__
 
 #include <emscripten/bind.h>
+#include <emscripten/val.h>
 #include <parser/facade.h>
 #include <synthesis/compiler.h>
+#include <vm/debugger.h>
 
 using namespace emscripten;
 
@@ -10,6 +12,61 @@ std::string name_of_instruction_wrapper(op operation) {
   return name_of_instruction(operation);
 }
 
+// JS holds the root through the `shared_ptr` that `ParseResult.ast` gives it,
+// which also keeps the arena alive while compiling
+program compile_wrapper(compiler &c, const std::shared_ptr<ast_node> &ast) {
+  return c.compile(ast.get());
+}
+
+// Everything the editor needs after running, so that it only has to cross
+// into wasm once
+struct debugger_stop {
+  exit_reason reason;
+  std::uint64_t pc;
+  std::int64_t x;
+  std::uint64_t executed;
+  std::vector<std::int64_t> output;
+  // Empty if there was none
+  std::string error;
+};
+
+template <typename F> debugger_stop stop_after(debugger &d, F run) {
+  debugger_stop stop;
+
+  try {
+    stop.reason = run();
+  } catch (execution_error &e) {
+    stop.reason = exit_reason::HALTED;
+    stop.error = e.what();
+  }
+
+  auto &state = d.get_state();
+  stop.pc = state.pc;
+  stop.x = state.x;
+  stop.executed = state.executed;
+  stop.output = d.take_output();
+  return stop;
+}
+
+debugger_stop run_until_wrapper(debugger &d,
+                                const std::vector<std::uint64_t> &breakpoints,
+                                std::uint64_t max_instructions) {
+  return stop_after(
+      d, [&]() { return d.run_until(breakpoints, max_instructions); });
+}
+
+debugger_stop run_one_statement_wrapper(debugger &d,
+                                        std::uint64_t max_instructions) {
+  return stop_after(d,
+                    [&]() { return d.run_one_statement(max_instructions); });
+}
+
+// A view, not a copy. Only valid until wasm memory grows
+val memory_wrapper(debugger &d) {
+  auto &memory = d.get_state().memory;
+  return val(typed_memory_view(memory.size(), memory.data()));
+}
+
 EMSCRIPTEN_BINDINGS(synthesis) {
   auto op_b = enum_<op>("Op");
 
@@ -58,7 +115,32 @@ EMSCRIPTEN_BINDINGS(synthesis) {
 
   class_<compiler>("Compiler")
       .constructor<>()
-      .function("compile", &compiler::compile);
+      .function("compile", &compile_wrapper);
+
+  auto exit_reason_b = enum_<exit_reason>("ExitReason");
+
+#define X(Enum, Name) exit_reason_b.value(Name, exit_reason::Enum);
+  EXIT_REASONS
+#undef X
+
+  register_vector<std::int64_t>("Vector<Int64>");
+
+  value_object<debugger_stop>("DebuggerStop")
+      .field("reason", &debugger_stop::reason)
+      .field("pc", &debugger_stop::pc)
+      .field("x", &debugger_stop::x)
+      .field("executed", &debugger_stop::executed)
+      .field("output", &debugger_stop::output)
+      .field("error", &debugger_stop::error);
+
+  // The program has to be kept alive for as long as the debugger
+  class_<debugger>("Debugger")
+      .constructor<const program &>()
+      .function("reset", &debugger::reset)
+      .function("runUntil", &run_until_wrapper)
+      .function("runOneStatement", &run_one_statement_wrapper)
+      .function("giveInput", &debugger::give_input)
+      .function("getMemory", &memory_wrapper);
 }
 
 #endif
@@ -13,13 +13,31 @@ std::shared_ptr<address_placeholder> label(std::uint64_t index) {
   return std::make_shared<hidden_label_reference>(index);
 }
 
-std::shared_ptr<address_placeholder> label(std::string name) {
+std::shared_ptr<address_placeholder> label(symbol name) {
   return std::make_shared<user_label_reference>(name);
 }
 
+void compiler::schedule(node_index node, std::uint32_t next,
+                        std::uint64_t label1, std::uint64_t label2) {
+  this->steps.push_back({node, next, {label1, label2}});
+}
+
+void compiler::compile_select(node_index node) {
+  this->schedule(node);
+
+  while (!this->steps.empty()) {
+    auto s = this->steps.back();
+    this->steps.pop_back();
+    compile_step(s);
+  }
+}
+
 // TODO: Improve this
-void compiler::compile_select(std::shared_ptr<ast_node> node) {
-  switch (node->kind) {
+void compiler::compile_step(const step &s) {
+  auto node = s.node;
+  auto kind = this->ast->kinds[node];
+
+  switch (kind) {
   case ast_node_kind::SUM:
   case ast_node_kind::SUBTRACTION:
   case ast_node_kind::MULTIPLICATION:
@@ -58,21 +76,21 @@ void compiler::compile_select(std::shared_ptr<ast_node> node) {
     return compile_expr(node);
 
   case ast_node_kind::STATEMENT:
-    return compile_statement(node);
+    return compile_statement(s);
 
   case ast_node_kind::BLOCK:
-    return compile_block(node);
+    return compile_block(s);
   case ast_node_kind::SEQUENCE:
-    return compile_sequence(node);
+    return compile_sequence(s);
 
   case ast_node_kind::DECLARATION_ASSIGNMENT:
-    return compile_decl_assignment(node);
+    return compile_decl_assignment(s);
 
   case ast_node_kind::CONDITIONAL:
-    return compile_conditional(node);
+    return compile_conditional(s);
 
   case ast_node_kind::WHILE:
-    return compile_while(node);
+    return compile_while(s);
 
   case ast_node_kind::LABEL:
     return compile_label(node);
@@ -81,7 +99,7 @@ void compiler::compile_select(std::shared_ptr<ast_node> node) {
     return compile_goto(node);
 
   case ast_node_kind::WRITE:
-    return compile_write(node);
+    return compile_write(s);
 
   case ast_node_kind::READ:
     return compile_read(node);
@@ -90,15 +108,14 @@ void compiler::compile_select(std::shared_ptr<ast_node> node) {
   case ast_node_kind::NOOP:
     return;
   default:
-    std::cout << "Node not implemented " << name_of_ast_node_kind(node->kind)
-              << '\n';
+    std::cout << "Node not implemented " << name_of_ast_node_kind(kind) << '\n';
     return;
   }
 }
 
 // In the loose sense that 2 operands becomes 1 value
-bool is_bin_operation(std::shared_ptr<ast_node> node) {
-  switch (node->kind) {
+bool is_bin_operation(ast_node_kind kind) {
+  switch (kind) {
   case ast_node_kind::SUM:
   case ast_node_kind::SUBTRACTION:
   case ast_node_kind::MULTIPLICATION:
@@ -123,8 +140,8 @@ bool is_bin_operation(std::shared_ptr<ast_node> node) {
   }
 }
 
-bool is_unary_operation(std::shared_ptr<ast_node> node) {
-  switch (node->kind) {
+bool is_unary_operation(ast_node_kind kind) {
+  switch (kind) {
   case ast_node_kind::INT_TO_FLOAT_COERCION:
   case ast_node_kind::INT_TO_BOOLEAN_COERCION:
   case ast_node_kind::BOOLEAN_TO_INT_COERCION:
@@ -138,8 +155,8 @@ bool is_unary_operation(std::shared_ptr<ast_node> node) {
   }
 }
 
-bool is_simple_assignment(std::shared_ptr<ast_node> node) {
-  switch (node->kind) {
+bool is_simple_assignment(ast_node_kind kind) {
+  switch (kind) {
   case ast_node_kind::ASSIGNMENT:
     return true;
   default:
@@ -147,40 +164,55 @@ bool is_simple_assignment(std::shared_ptr<ast_node> node) {
   }
 }
 
-void add_expr_nodes(std::vector<std::shared_ptr<expr_component>> *vec,
-                    std::shared_ptr<ast_node> tree) {
-  if (is_bin_operation(tree)) {
-    add_expr_nodes(vec, tree->children[0]);
-    add_expr_nodes(vec, tree->children[1]);
-
-    auto ooperator = std::make_shared<expr_bin_operator>(tree.get());
-    vec->push_back(ooperator);
-    return;
+// In postfix order, with a stack instead of recursion since expressions can
+// nest as deep as the source wants
+void add_expr_nodes(const flat_ast *ast,
+                    std::vector<std::shared_ptr<expr_component>> *vec,
+                    node_index tree) {
+  struct pending {
+    node_index node;
+    // Its operands are already in
+    bool operands_done;
+  };
+
+  std::vector<pending> stack{{tree, false}};
+
+  while (!stack.empty()) {
+    auto [node, operands_done] = stack.back();
+    stack.pop_back();
+
+    auto kind = ast->kinds[node];
+
+    if (operands_done) {
+      if (is_unary_operation(kind)) {
+        vec->push_back(std::make_shared<expr_unary_operator>(ast, node));
+      } else {
+        vec->push_back(std::make_shared<expr_bin_operator>(ast, node));
+      }
+
+      continue;
+    }
+
+    // The first operand goes on last, so that it comes out first
+    if (is_bin_operation(kind)) {
+      stack.push_back({node, true});
+      stack.push_back({ast->child(node, 1), false});
+      stack.push_back({ast->child(node, 0), false});
+    } else if (is_unary_operation(kind)) {
+      stack.push_back({node, true});
+      stack.push_back({ast->child(node, 0), false});
+    } else if (is_simple_assignment(kind)) {
+      stack.push_back({node, true});
+      stack.push_back({ast->child(node, 1), false});
+    } else {
+      vec->push_back(std::make_shared<expr_operand>(ast, node));
+    }
   }
-
-  if (is_unary_operation(tree)) {
-    add_expr_nodes(vec, tree->children[0]);
-
-    auto ooperator = std::make_shared<expr_unary_operator>(tree.get());
-    vec->push_back(ooperator);
-    return;
-  }
-
-  if (is_simple_assignment(tree)) {
-    add_expr_nodes(vec, tree->children[1]);
-
-    auto ooperator = std::make_shared<expr_bin_operator>(tree.get());
-    vec->push_back(ooperator);
-    return;
-  }
-
-  auto operand = std::make_shared<expr_operand>(tree.get());
-  vec->push_back(operand);
 }
 
-void compiler::compile_expr(std::shared_ptr<ast_node> tree) {
+void compiler::compile_expr(node_index tree) {
   std::vector<std::shared_ptr<expr_component>> components;
-  add_expr_nodes(&components, tree);
+  add_expr_nodes(this->ast, &components, tree);
 
   unsigned long stack_size = 0;
 
@@ -197,7 +229,7 @@ void compiler::compile_expr(std::shared_ptr<ast_node> tree) {
 }
 
 void compiler::compile_expr_select(expr_component *expr) {
-  switch (expr->node->kind) {
+  switch (this->ast->kinds[expr->node]) {
   case ast_node_kind::VAR_IDENTIFIER:
     return compile_expr_var(expr);
   case ast_node_kind::INT_LITERAL:
@@ -251,7 +283,7 @@ void compiler::compile_expr_select(expr_component *expr) {
     return compile_expr_or(expr);
   default: {
     std::cout << "Expression node not implemented "
-              << name_of_ast_node_kind(expr->node->kind) << '\n';
+              << name_of_ast_node_kind(this->ast->kinds[expr->node]) << '\n';
     return;
   }
   }
@@ -261,9 +293,9 @@ void compiler::compile_expr_unary_minus(expr_component *expr) {
   auto operand1 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(instruction_with_operand_placeholders(op::NEGATE),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -275,9 +307,9 @@ void compiler::compile_expr_sum(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(instruction_with_operand_placeholders(op::ADD, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -287,10 +319,10 @@ void compiler::compile_expr_sub(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(
       instruction_with_operand_placeholders(op::SUBTRACT, operand2),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -300,10 +332,10 @@ void compiler::compile_expr_mul(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(
       instruction_with_operand_placeholders(op::MULTIPLY, operand2),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -313,9 +345,9 @@ void compiler::compile_expr_div(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(instruction_with_operand_placeholders(op::DIVIDE, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -325,36 +357,35 @@ void compiler::compile_expr_mod(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
   push_instruction(
       instruction_with_operand_placeholders(op::REMAINDER, operand2),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_var(expr_component *expr) {
-  auto var_node = (var_identifier_node *)(expr->node);
-  auto var_offset = var_node->entry->offset;
+  auto var_offset = this->ast->values[expr->node].var->offset;
 
   if (this->data.intermediate_stack_size() != 0) {
     auto last = this->data.peek_intermediate();
     push_instruction(instruction_with_operand_placeholders(op::SET, last),
-                     expr->node->location);
+                     expr->node);
   }
 
   push_instruction(
       instruction_with_operand_placeholders(op::LOAD, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto bitmask = 0;
-  for (auto i = 0; i < var_node->typ->size() * 8; ++i) {
+  for (auto i = 0; i < this->ast->type_of(expr->node).size() * 8; ++i) {
     bitmask = (bitmask << 1) | 1;
   }
 
   push_instruction(
       instruction_with_operand_placeholders(op::AND_I, absolute(bitmask)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -362,29 +393,24 @@ void compiler::compile_expr_var(expr_component *expr) {
 void compiler::compile_expr_literal(expr_component *expr) {
   std::uint64_t value;
 
-  switch (expr->node->typ->kind) {
-  case type_kind::INT: {
-    auto node = (int_literal_node *)(expr->node);
-    value = node->value;
+  auto &literal = this->ast->values[expr->node];
+  auto kind = this->ast->type_of(expr->node).kind;
+
+  switch (kind) {
+  case type_kind::INT:
+    value = literal.int_value;
     break;
-  }
-  case type_kind::FLOAT: {
-    auto node = (float_literal_node *)(expr->node);
-    value = *(std::int64_t *)&(node->value);
+  case type_kind::FLOAT:
+    value = *(std::int64_t *)&(literal.float_value);
     break;
-  }
-  case type_kind::BOOLEAN: {
-    auto node = (boolean_literal_node *)(expr->node);
-    value = node->value ? 1 : 0;
+  case type_kind::BOOLEAN:
+    value = literal.bool_value ? 1 : 0;
     break;
-  }
-  case type_kind::CHAR: {
-    auto node = (char_literal_node *)(expr->node);
-    value = node->value;
+  case type_kind::CHAR:
+    value = literal.char_value;
     break;
-  }
   default:
-    std::cout << "Invalid type in expression " << expr->node->typ->kind << '\n';
+    std::cout << "Invalid type in expression " << kind << '\n';
     value = 0xBAD;
     break;
   }
@@ -392,132 +418,126 @@ void compiler::compile_expr_literal(expr_component *expr) {
   if (this->data.intermediate_stack_size() != 0) {
     auto last = this->data.peek_intermediate();
     push_instruction(instruction_with_operand_placeholders(op::SET, last),
-                     expr->node->location);
+                     expr->node);
   }
 
   push_instruction(
       instruction_with_operand_placeholders(op::LOAD_I, absolute(value)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   // The assigned value is kept in the register
 }
 
 void compiler::compile_expr_sum_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   auto previous = this->data.pop_intermediate();
   auto modifier = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, previous),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::ADD, modifier),
-                   expr->node->location);
+                   expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_subtraction_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   auto previous = this->data.pop_intermediate();
   auto modifier = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, previous),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SUBTRACT, modifier),
-      expr->node->location);
+      expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_multiplication_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   auto previous = this->data.pop_intermediate();
   auto modifier = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, previous),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::MULTIPLY, modifier),
-      expr->node->location);
+      expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_division_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   auto previous = this->data.pop_intermediate();
   auto modifier = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, previous),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::DIVIDE, modifier),
-                   expr->node->location);
+                   expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
 void compiler::compile_expr_modulo_assignment(expr_component *expr) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(expr->node->children[0]);
-  auto var_offset = var_node->entry->offset;
+  auto var = this->ast->child(expr->node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   auto previous = this->data.pop_intermediate();
   auto modifier = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, previous),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::REMAINDER, modifier),
-      expr->node->location);
+      expr->node);
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      expr->node->location);
+      expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -527,10 +547,10 @@ void compiler::compile_expr_gt(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::GT, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -540,10 +560,10 @@ void compiler::compile_expr_lt(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::LT, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -553,10 +573,10 @@ void compiler::compile_expr_gteq(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::GTEQ, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -566,10 +586,10 @@ void compiler::compile_expr_lteq(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::LTEQ, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -579,10 +599,10 @@ void compiler::compile_expr_equals(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::EQUALS, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -592,13 +612,12 @@ void compiler::compile_expr_nequals(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::EQUALS, operand2),
-                   expr->node->location);
+                   expr->node);
 
-  push_instruction(instruction_with_operand_placeholders(op::NOT),
-                   expr->node->location);
+  push_instruction(instruction_with_operand_placeholders(op::NOT), expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -607,14 +626,13 @@ void compiler::compile_expr_not(expr_component *expr) {
   auto operand1 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
-  push_instruction(instruction_with_operand_placeholders(op::NOT),
-                   expr->node->location);
+  push_instruction(instruction_with_operand_placeholders(op::NOT), expr->node);
 
   auto result = this->data.push_intermediate(expr);
   push_instruction(instruction_with_operand_placeholders(op::SET, result),
-                   expr->node->location);
+                   expr->node);
 }
 
 void compiler::compile_expr_and(expr_component *expr) {
@@ -622,10 +640,10 @@ void compiler::compile_expr_and(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::AND, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
@@ -635,122 +653,167 @@ void compiler::compile_expr_or(expr_component *expr) {
   auto operand2 = this->data.pop_intermediate();
 
   // push_instruction(instruction_with_operand_placeholders(op::LOAD, operand1),
-  //                  expr->node->location);
+  //                  expr->node);
 
   push_instruction(instruction_with_operand_placeholders(op::OR, operand2),
-                   expr->node->location);
+                   expr->node);
 
   auto result = this->data.push_intermediate(expr);
 }
 
-void compiler::compile_statement(std::shared_ptr<ast_node> node) {
+void compiler::compile_statement(const step &s) {
   push_statement_boundary();
-  compile_select(node->children[0]);
+  this->schedule(this->ast->child(s.node, 0));
 }
 
-void compiler::compile_block(std::shared_ptr<ast_node> node) {
-  compile_select(node->children[0]);
+void compiler::compile_block(const step &s) {
+  this->schedule(this->ast->child(s.node, 0));
 }
 
-void compiler::compile_sequence(std::shared_ptr<ast_node> node) {
-  compile_select(node->children[0]);
-  compile_select(node->children[1]);
+void compiler::compile_sequence(const step &s) {
+  this->schedule(this->ast->child(s.node, 1));
+  this->schedule(this->ast->child(s.node, 0));
 }
 
-void compiler::compile_decl_assignment(std::shared_ptr<ast_node> node) {
-  compile_select(node->children[2]);
+void compiler::compile_decl_assignment(const step &s) {
+  auto node = s.node;
+
+  if (s.next == 0) {
+    this->schedule(node, 1);
+    this->schedule(this->ast->child(node, 2));
+    return;
+  }
 
-  auto var = std::dynamic_pointer_cast<var_identifier_node>(node->children[1]);
-  auto var_offset = var->entry->offset;
+  auto var = this->ast->child(node, 1);
+  auto var_offset = this->ast->values[var].var->offset;
 
   push_instruction(
       instruction_with_operand_placeholders(op::SET, absolute(var_offset)),
-      node->location);
+      node);
 }
 
-void compiler::compile_conditional(std::shared_ptr<ast_node> node) {
-  compile_select(node->children[0]);
-  push_statement_boundary();
+void compiler::compile_conditional(const step &s) {
+  auto node = s.node;
 
-  auto else_body_label = this->make_label();
-  auto end_label = this->make_label();
+  switch (s.next) {
+  case 0:
+    this->schedule(node, 1);
+    this->schedule(this->ast->child(node, 0));
+    return;
 
-  push_instruction(instruction_with_operand_placeholders(
-                       op::BRANCH_IF_ZERO, label(else_body_label)),
-                   node->location);
+  case 1: {
+    push_statement_boundary();
 
-  compile_select(node->children[1]);
+    auto else_body_label = this->make_label();
+    auto end_label = this->make_label();
 
-  push_instruction(
-      instruction_with_operand_placeholders(op::JUMP, label(end_label)),
-      node->location);
+    push_instruction(instruction_with_operand_placeholders(
+                         op::BRANCH_IF_ZERO, label(else_body_label)),
+                     node);
+
+    this->schedule(node, 2, else_body_label, end_label);
+    this->schedule(this->ast->child(node, 1));
+    return;
+  }
+
+  case 2: {
+    auto [else_body_label, end_label] = s.labels;
 
-  auto else_body_index = current_instruction_index();
-  this->hidden_labels[else_body_label] = else_body_index;
+    push_instruction(
+        instruction_with_operand_placeholders(op::JUMP, label(end_label)),
+        node);
 
-  compile_select(node->children[2]);
+    auto else_body_index = current_instruction_index();
+    this->hidden_labels[else_body_label] = else_body_index;
 
-  auto end_index = current_instruction_index();
-  this->hidden_labels[end_label] = end_index;
+    this->schedule(node, 3, else_body_label, end_label);
+    this->schedule(this->ast->child(node, 2));
+    return;
+  }
+
+  default:
+    auto end_index = current_instruction_index();
+    this->hidden_labels[s.labels[1]] = end_index;
+  }
 }
 
-void compiler::compile_while(std::shared_ptr<ast_node> node) {
-  auto start_label = this->make_label();
-  auto start_index = current_instruction_index();
-  this->hidden_labels[start_label] = start_index;
+void compiler::compile_while(const step &s) {
+  auto node = s.node;
 
-  compile_select(node->children[0]);
-  push_statement_boundary();
+  switch (s.next) {
+  case 0: {
+    auto start_label = this->make_label();
+    auto start_index = current_instruction_index();
+    this->hidden_labels[start_label] = start_index;
 
-  auto end_label = this->make_label();
+    this->schedule(node, 1, start_label);
+    this->schedule(this->ast->child(node, 0));
+    return;
+  }
 
-  push_instruction(instruction_with_operand_placeholders(op::BRANCH_IF_ZERO,
-                                                         label(end_label)),
-                   node->location);
+  case 1: {
+    push_statement_boundary();
 
-  compile_select(node->children[1]);
+    auto end_label = this->make_label();
 
-  push_instruction(
-      instruction_with_operand_placeholders(op::JUMP, label(start_label)),
-      node->location);
+    push_instruction(instruction_with_operand_placeholders(
+                         op::BRANCH_IF_ZERO, label(end_label)),
+                     node);
+
+    this->schedule(node, 2, s.labels[0], end_label);
+    this->schedule(this->ast->child(node, 1));
+    return;
+  }
+
+  default:
+    auto [start_label, end_label] = s.labels;
 
-  auto end_index = current_instruction_index();
-  this->hidden_labels[end_label] = end_index;
+    push_instruction(
+        instruction_with_operand_placeholders(op::JUMP, label(start_label)),
+        node);
+
+    auto end_index = current_instruction_index();
+    this->hidden_labels[end_label] = end_index;
+  }
 }
 
-void compiler::compile_label(std::shared_ptr<ast_node> node) {
-  auto cast = std::dynamic_pointer_cast<label_node>(node);
-  this->user_labels[cast->value] = current_instruction_index();
+void compiler::compile_label(node_index node) {
+  auto name = symbol::from_id(this->ast->values[node].name);
+  this->user_labels[name] = current_instruction_index();
 }
 
-void compiler::compile_goto(std::shared_ptr<ast_node> node) {
-  auto cast = std::dynamic_pointer_cast<goto_node>(node);
+void compiler::compile_goto(node_index node) {
+  auto name = symbol::from_id(this->ast->values[node].name);
 
-  push_instruction(
-      instruction_with_operand_placeholders(op::JUMP, label(cast->value)),
-      node->location);
+  push_instruction(instruction_with_operand_placeholders(op::JUMP, label(name)),
+                   node);
 }
 
-void compiler::compile_write(std::shared_ptr<ast_node> node) {
-  compile_select(node->children[0]);
+void compiler::compile_write(const step &s) {
+  auto node = s.node;
+
+  if (s.next == 0) {
+    this->schedule(node, 1);
+    this->schedule(this->ast->child(node, 0));
+    return;
+  }
 
   auto syscall_code = code_of_syscall(sys_call::WRITE);
   push_instruction(instruction_with_operand_placeholders(
                        op::INTERRUPT, absolute(syscall_code)),
-                   node->location);
+                   node);
 }
 
-void compiler::compile_read(std::shared_ptr<ast_node> node) {
-  auto var_node =
-      std::dynamic_pointer_cast<var_identifier_node>(node->children[0]);
-  auto var_offset = var_node->entry->offset;
+void compiler::compile_read(node_index node) {
+  auto var = this->ast->child(node, 0);
+  auto var_offset = this->ast->values[var].var->offset;
 
   push_instruction(
       instruction_with_operand_placeholders(op::LOAD_I, absolute(var_offset)),
-      node->location);
+      node);
 
   auto syscall_code = code_of_syscall(sys_call::READ);
   push_instruction(instruction_with_operand_placeholders(
                        op::INTERRUPT, absolute(syscall_code)),
-                   node->location);
+                   node);
 }
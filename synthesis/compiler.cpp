@@ -1,25 +1,35 @@
 #include "synthesis/compiler.h"
+#include <algorithm>
 #include <exception>
 
 data_manager::data_manager()
     : variable_data_size(0), intermediate_value_data_size(0),
       intermediate_value_stack_tip(0) {}
 
+void data_manager::clear() {
+  this->intermediate_value_stack.clear();
+  this->intermediate_value_stack_tip = 0;
+  this->variable_data_size = 0;
+  this->intermediate_value_data_size = 0;
+  this->variables.clear();
+}
+
 std::uint64_t data_manager::add_variable(var_table_entry *entry) {
-  auto current_size = this->variable_data_size;
   auto var_size = entry->type->value->size();
-  auto final_size = current_size + var_size;
 
-  this->variable_data_size = final_size;
+  // Offsets come from the parser, and needn't be packed in the order they're
+  // added, so this is wherever the last of them ends
+  this->variable_data_size = std::max<std::uint64_t>(
+      this->variable_data_size, entry->offset + var_size);
 
   // This assumes global variables will be the first things in memory
   variable_data *metadata = &this->variables[entry->offset];
-  metadata->name = entry->name;
-  metadata->size = entry->type->value->size();
+  metadata->name = entry->name.text();
+  metadata->size = var_size;
   metadata->address = entry->offset;
   metadata->declared_at = entry->declared_at;
 
-  return current_size;
+  return entry->offset;
 }
 
 void data_manager::ensure_intermediate_values(unsigned int count) {
@@ -37,7 +47,8 @@ std::shared_ptr<address_placeholder>
 data_manager::push_intermediate(expr_component *component) {
   auto tip = this->intermediate_value_stack_tip;
   this->intermediate_value_stack.push_back(component);
-  this->intermediate_value_stack_tip += component->node->typ->size();
+  this->intermediate_value_stack_tip +=
+      component->ast->type_of(component->node).size();
 
   return std::make_shared<intermediate_value_address>(tip);
 }
@@ -45,7 +56,7 @@ data_manager::push_intermediate(expr_component *component) {
 std::shared_ptr<address_placeholder> data_manager::pop_intermediate() {
   auto last = this->intermediate_value_stack.back();
   this->intermediate_value_stack.pop_back();
-  this->intermediate_value_stack_tip -= last->node->typ->size();
+  this->intermediate_value_stack_tip -= last->ast->type_of(last->node).size();
 
   return std::make_shared<intermediate_value_address>(
       this->intermediate_value_stack_tip);
@@ -53,8 +64,9 @@ std::shared_ptr<address_placeholder> data_manager::pop_intermediate() {
 
 std::shared_ptr<address_placeholder> data_manager::peek_intermediate() {
   auto last = this->intermediate_value_stack.back();
+  auto size = last->ast->type_of(last->node).size();
   return std::make_shared<intermediate_value_address>(
-      this->intermediate_value_stack_tip - last->node->typ->size());
+      this->intermediate_value_stack_tip - size);
 }
 
 int data_manager::intermediate_stack_size() {
@@ -84,17 +96,17 @@ hidden_label_reference::resolve(address_placeholder_resolve_data data) {
   return data.hidden_labels[this->index];
 }
 
-user_label_reference::user_label_reference(std::string name) : name(name) {}
+user_label_reference::user_label_reference(symbol name) : name(name) {}
 std::uint64_t
 user_label_reference::resolve(address_placeholder_resolve_data data) {
   auto maybe_found = data.user_labels.find(this->name);
 
   if (maybe_found == data.user_labels.end()) {
-    throw std::runtime_error("Label " + this->name +
+    throw std::runtime_error("Label " + std::string(this->name.text()) +
                              " referenced but not defined.");
   }
 
-  return data.user_labels[this->name];
+  return maybe_found->second;
 }
 
 instruction_with_operand_placeholders::instruction_with_operand_placeholders(
@@ -150,61 +162,68 @@ instruction_with_operands instruction_with_operand_placeholders::resolve(
   return result;
 }
 
-expr_component::expr_component(ast_node *node) : node(node) {}
+expr_component::expr_component(const flat_ast *ast, node_index node)
+    : ast(ast), node(node) {}
 
-expr_operand::expr_operand(ast_node *node) : expr_component(node) {}
+expr_operand::expr_operand(const flat_ast *ast, node_index node)
+    : expr_component(ast, node) {}
 long expr_operand::get_stack_size_contribution() {
-  return +this->node->typ->size();
+  return +this->ast->type_of(this->node).size();
 }
 
-expr_bin_operator::expr_bin_operator(ast_node *node) : expr_component(node) {}
+expr_bin_operator::expr_bin_operator(const flat_ast *ast, node_index node)
+    : expr_component(ast, node) {}
 long expr_bin_operator::get_stack_size_contribution() {
-  auto operand1 = this->node->children[0];
-  auto operand2 = this->node->children[1];
+  auto operand1 = this->ast->child(this->node, 0);
+  auto operand2 = this->ast->child(this->node, 1);
 
-  return this->node->typ->size() - operand1->typ->size() -
-         operand2->typ->size();
+  return this->ast->type_of(this->node).size() -
+         this->ast->type_of(operand1).size() -
+         this->ast->type_of(operand2).size();
 }
 
-expr_unary_operator::expr_unary_operator(ast_node *node)
-    : expr_component(node) {}
+expr_unary_operator::expr_unary_operator(const flat_ast *ast, node_index node)
+    : expr_component(ast, node) {}
 long expr_unary_operator::get_stack_size_contribution() {
-  auto operand = this->node->children[0];
-  return this->node->typ->size() - operand->typ->size();
+  auto operand = this->ast->child(this->node, 0);
+  return this->ast->type_of(this->node).size() -
+         this->ast->type_of(operand).size();
 }
 
-compiler::compiler() : hidden_label_counter(0) {}
+compiler::compiler() : ast(nullptr), hidden_label_counter(0) {}
 
 void compiler::push_statement_boundary() {
   this->statement_boundaries.insert(instructions.size());
 }
 
 void compiler::push_instruction(
-    instruction_with_operand_placeholders instruction, yy::location from) {
+    instruction_with_operand_placeholders instruction, node_index from) {
   this->instructions.push_back(instruction);
-  this->source_line_map.push_back(from.begin.line);
+  this->source_line_map.push_back(this->ast->lines[from]);
 }
 
 std::uint64_t compiler::current_instruction_index() {
   return this->instructions.size();
 }
 
-void setup_variables_from_table(data_manager *data, symbol_table *table) {
-  auto vars = table->vars();
+void setup_variables_from_table(data_manager *data, symbol_table *root) {
+  std::vector<symbol_table *> pending{root};
 
-  for (auto const &pair : *vars) {
-    auto [key, value] = pair;
-    data->add_variable(&value);
-  }
+  while (!pending.empty()) {
+    auto table = pending.back();
+    pending.pop_back();
+
+    for (auto &entry : table->vars()) {
+      data->add_variable(&entry);
+    }
 
-  for (auto const &child : table->get_children()) {
-    setup_variables_from_table(data, child);
+    auto &children = table->get_children();
+    pending.insert(pending.end(), children.rbegin(), children.rend());
   }
 }
 
-void compiler::setup_variables(std::shared_ptr<ast_node> root) {
-  auto block = std::dynamic_pointer_cast<block_node>(root);
-  setup_variables_from_table(&this->data, block->table.get());
+void compiler::setup_variables(node_index root) {
+  setup_variables_from_table(&this->data, this->ast->values[root].table);
 }
 
 std::uint64_t compiler::make_label() {
@@ -216,11 +235,31 @@ std::uint64_t compiler::make_label() {
   return index;
 }
 
-program compiler::compile(std::shared_ptr<ast_node> ast) {
+void compiler::reset() {
+  this->ast = nullptr;
+  this->data.clear();
+  this->instructions.clear();
+  this->hidden_labels.clear();
+  this->hidden_label_counter = 0;
+  this->user_labels.clear();
+  this->steps.clear();
+  this->statement_boundaries.clear();
+  this->source_line_map.clear();
+}
+
+program compiler::compile(ast_node *ast) {
+  flatten(ast, this->flat);
+  return compile(this->flat);
+}
+
+program compiler::compile(const flat_ast &ast) {
+  this->reset();
   program prog;
 
-  setup_variables(ast);
-  compile_select(ast);
+  // The root is always the first node
+  this->ast = &ast;
+  setup_variables(0);
+  compile_select(0);
 
   prog.code.reserve(instructions.size());
   prog.data.insert(prog.data.begin(), this->data.data_size(), 0);
@@ -1,7 +1,7 @@
 #ifndef COMPILER_H
 #define COMPILER_H
 
-#include "parser/ast.h"
+#include "parser/flat_ast.h"
 #include "synthesis/program.h"
 #include <cstdint>
 #include <memory>
@@ -13,7 +13,7 @@ class data_manager;
 struct address_placeholder_resolve_data {
   data_manager &data;
   std::map<std::uint64_t, std::uint64_t> &hidden_labels;
-  std::map<std::string, std::uint64_t> &user_labels;
+  std::map<symbol, std::uint64_t> &user_labels;
 };
 
 class address_placeholder {
@@ -50,10 +50,10 @@ public:
 
 class user_label_reference : public address_placeholder {
 private:
-  std::string name;
+  symbol name;
 
 public:
-  user_label_reference(std::string name);
+  user_label_reference(symbol name);
   virtual std::uint64_t resolve(address_placeholder_resolve_data data);
 };
 
@@ -85,27 +85,28 @@ public:
 // expressing it in postfix form
 class expr_component {
 public:
-  ast_node *node;
+  const flat_ast *ast;
+  node_index node;
 
-  expr_component(ast_node *node);
+  expr_component(const flat_ast *ast, node_index node);
   virtual long get_stack_size_contribution() = 0;
 };
 
 class expr_operand : public expr_component {
 public:
-  expr_operand(ast_node *node);
+  expr_operand(const flat_ast *ast, node_index node);
   virtual long get_stack_size_contribution();
 };
 
 class expr_bin_operator : public expr_component {
 public:
-  expr_bin_operator(ast_node *node);
+  expr_bin_operator(const flat_ast *ast, node_index node);
   virtual long get_stack_size_contribution();
 };
 
 class expr_unary_operator : public expr_component {
 public:
-  expr_unary_operator(ast_node *node);
+  expr_unary_operator(const flat_ast *ast, node_index node);
   virtual long get_stack_size_contribution();
 };
 
@@ -122,6 +123,9 @@ public:
 
   data_manager();
 
+  // Empty again, keeping the stack's memory
+  void clear();
+
   std::uint64_t add_variable(var_table_entry *entry);
   void ensure_intermediate_values(unsigned int count);
   std::uint64_t get_current_intermediate_values_start();
@@ -147,16 +151,24 @@ public:
 };
 
 // Implemented in `compiler.cpp` and `compile_ops.cpp` to keep file size
-// a bit smaller
+// a bit smaller.
+//
+// Like parsers, one per thread: it only reads the tree and the symbol tables,
+// so threads can compile separate trees at once
 class compiler {
 private:
+  // The tree being compiled
+  const flat_ast *ast;
+  // Where `compile(ast_node *)` flattens to, kept for the next one
+  flat_ast flat;
+
   data_manager data;
   std::vector<instruction_with_operand_placeholders> instructions;
 
   std::map<std::uint64_t, std::uint64_t> hidden_labels;
   std::uint64_t hidden_label_counter;
 
-  std::map<std::string, std::uint64_t> user_labels;
+  std::map<symbol, std::uint64_t> user_labels;
 
   // Metadata
   std::unordered_set<std::uint64_t> statement_boundaries;
@@ -164,16 +176,33 @@ private:
 
   void push_statement_boundary();
   void push_instruction(instruction_with_operand_placeholders instruction,
-                        yy::location from);
+                        node_index from);
   std::uint64_t current_instruction_index();
 
-  void setup_variables(std::shared_ptr<ast_node> root);
+  void setup_variables(node_index root);
   std::uint64_t make_label();
 
-  // compile_ops.cpp
-  void compile_select(std::shared_ptr<ast_node> node);
+  // Statements that hold others are compiled a step at a time, and what's
+  // left of them waits here while their children are compiled. So nesting
+  // takes room on the heap instead of the native stack
+  struct step {
+    node_index node;
+    std::uint32_t next;
+    // Made by the earlier steps, for the later ones
+    std::uint64_t labels[2];
+  };
+
+  std::vector<step> steps;
 
-  void compile_expr(std::shared_ptr<ast_node> tree);
+  // compile_ops.cpp
+  // Steps run last in first out, so what comes after a child is scheduled
+  // before the child
+  void schedule(node_index node, std::uint32_t next = 0,
+                std::uint64_t label1 = 0, std::uint64_t label2 = 0);
+  void compile_select(node_index node);
+  void compile_step(const step &s);
+
+  void compile_expr(node_index tree);
   void compile_expr_select(expr_component *expr);
   void compile_expr_unary_minus(expr_component *expr);
   void compile_expr_unary_plus(expr_component *expr);
@@ -200,21 +229,28 @@ private:
   void compile_expr_and(expr_component *expr);
   void compile_expr_or(expr_component *expr);
 
-  void compile_statement(std::shared_ptr<ast_node> node);
-  void compile_block(std::shared_ptr<ast_node> node);
-  void compile_sequence(std::shared_ptr<ast_node> node);
-  void compile_decl_assignment(std::shared_ptr<ast_node> node);
-  void compile_conditional(std::shared_ptr<ast_node> node);
-  void compile_while(std::shared_ptr<ast_node> node);
-  void compile_label(std::shared_ptr<ast_node> node);
-  void compile_goto(std::shared_ptr<ast_node> node);
-  void compile_write(std::shared_ptr<ast_node> node);
-  void compile_read(std::shared_ptr<ast_node> node);
+  void compile_statement(const step &s);
+  void compile_block(const step &s);
+  void compile_sequence(const step &s);
+  void compile_decl_assignment(const step &s);
+  void compile_conditional(const step &s);
+  void compile_while(const step &s);
+  void compile_label(node_index node);
+  void compile_goto(node_index node);
+  void compile_write(const step &s);
+  void compile_read(node_index node);
   // /compile_ops.cpp
 
 public:
   compiler();
-  program compile(std::shared_ptr<ast_node> ast);
+
+  // Forgets the last program, keeping memory for the next. `compile` does it
+  // first, so one compiler can compile any number of programs
+  void reset();
+
+  program compile(const flat_ast &ast);
+  // Flattens it first
+  program compile(ast_node *ast);
 };
 
 #endif /* COMPILER_H */
@@ -0,0 +1,89 @@
+#include "driver/batch.h"
+#include "temp_dir.h"
+#include "vm/programs.h"
+#include <bandit/bandit.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace snowhouse;
+using namespace bandit;
+
+static bool same_code(const program &a, const program &b) {
+  if (a.code.size() != b.code.size() || a.data != b.data) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < a.code.size(); ++i) {
+    auto x = a.code[i];
+    auto y = b.code[i];
+
+    // The operands past the count are left uninitialized
+    if (x.operation != y.operation ||
+        !std::equal(x.operands, x.operands + x.operand_count(), y.operands)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+go_bandit([]() {
+  describe("batch compiler", []() {
+    it("compiles like one at a time, in order", [&]() {
+      std::vector<std::string> sources;
+
+      for (int i = 0; i < 200; ++i) {
+        switch (i % 3) {
+        case 0:
+          sources.push_back(collatz_source);
+          break;
+        case 1:
+          sources.push_back(prime_source);
+          break;
+        default:
+          sources.push_back("int x = " + std::to_string(i) + "; write x;");
+        }
+      }
+
+      batch_compiler batch(4);
+      auto results = batch.compile(sources);
+
+      AssertThat(results.size(), Equals(sources.size()));
+
+      for (std::size_t i = 0; i < sources.size(); ++i) {
+        AssertThat(results[i].success, IsTrue());
+        AssertThat(same_code(results[i].prog, compile_source(sources[i])),
+                   IsTrue());
+      }
+    });
+
+    it("keeps going after a source that doesn't parse", [&]() {
+      batch_compiler batch(2);
+      auto results =
+          batch.compile({"int x = 1;", "int x = ;", "int y; write y;"});
+
+      AssertThat(results[0].success, IsTrue());
+      AssertThat(results[1].success, IsFalse());
+      AssertThat(results[1].message.empty(), IsFalse());
+      AssertThat(results[2].success, IsTrue());
+    });
+
+    it("compiles every file in a directory", [&]() {
+      temp_dir dir("tokiwen_batch_");
+
+      std::ofstream(dir / "b.tkw") << "int x;\nx = ;\n";
+      std::ofstream(dir / "a.tkw") << collatz_source;
+
+      batch_compiler batch(2);
+      auto paths = files_in(dir.get().string());
+      auto results = batch.compile_files(paths);
+
+      AssertThat(paths.size(), Equals(2u));
+      AssertThat(results[0].success, IsTrue());
+      AssertThat(same_code(results[0].prog, compile_source(collatz_source)),
+                 IsTrue());
+      AssertThat(results[1].success, IsFalse());
+      AssertThat(results[1].message.rfind(paths[1] + ":2", 0), Equals(0u));
+    });
+  });
+});
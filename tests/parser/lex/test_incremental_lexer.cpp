@@ -0,0 +1,98 @@
+#include "parser/lex/incremental_lexer.h"
+#include <bandit/bandit.h>
+#include <random>
+
+using namespace snowhouse;
+using namespace bandit;
+
+keyword_table test_keywords() {
+  yy::scanner scanner;
+  scanner.init_default_keywords();
+  return scanner.keywords;
+}
+
+bool same_tokens_as_fresh(const incremental_lexer &lexer) {
+  incremental_lexer fresh(lexer.get_text(), test_keywords());
+  return lexer.get_tokens() == fresh.get_tokens();
+}
+
+go_bandit([]() {
+  describe("incremental lexer", []() {
+    it("gives the same tokens as lexing everything again", [&]() {
+      incremental_lexer lexer("\
+int x = 1e5; /* a\n\
+comment */ float y = 2.5;\n\
+// line comment\n\
+write \"a string\" ; goto end;\n\
+while (x < 10) x += 1;\n\
+end:\n\
+",
+                              test_keywords());
+
+      // Bits that change how what's around them is scanned
+      std::vector<std::string> snippets = {
+          "/*", "*/", "//", "\"", "'", "e", "e+", "5", ".", "\n",
+          " ", "x", "while", "=", "/", "*", "\t", "1", "a'",
+      };
+
+      std::mt19937 random(42);
+
+      for (int i = 0; i < 2000; ++i) {
+        auto size = lexer.get_text().size();
+        std::size_t start = random() % (size + 1);
+        std::size_t removed = random() % 3 == 0 ? random() % 4 : 0;
+        auto inserted = random() % 4 == 0 ? "" : snippets[random() %
+                                                          snippets.size()];
+
+        lexer.edit(start, removed, inserted);
+
+        if (!same_tokens_as_fresh(lexer)) {
+          AssertThat(lexer.get_text(), Equals("the same tokens"));
+        }
+      }
+    });
+
+    it("only relexes around the edit", [&]() {
+      std::string source;
+      for (int i = 0; i < 1000; ++i) {
+        source += "int x" + std::to_string(i) + " = " + std::to_string(i) +
+                  ";\n";
+      }
+
+      incremental_lexer lexer(source, test_keywords());
+      auto middle = source.find("x500");
+
+      lexer.edit(middle + 1, 3, "fifty");
+
+      AssertThat(lexer.last_relexed(), IsLessThan(10u));
+      AssertThat(same_tokens_as_fresh(lexer), IsTrue());
+    });
+
+    it("closes comments that were left open", [&]() {
+      incremental_lexer lexer("int x; /* int y;\nint z;\n", test_keywords());
+      auto tokens_before = lexer.get_tokens().size();
+
+      lexer.edit(lexer.get_text().size(), 0, "*/");
+
+      AssertThat(lexer.get_tokens().size(), IsLessThan(tokens_before));
+      AssertThat(same_tokens_as_fresh(lexer), IsTrue());
+
+      // And opens them again
+      lexer.edit(lexer.get_text().size() - 2, 2, "");
+      AssertThat(lexer.get_tokens().size(), Equals(tokens_before));
+    });
+
+    it("keeps locations right after edits", [&]() {
+      incremental_lexer lexer("int x;\nint y;\n", test_keywords());
+      std::string filename = "test";
+
+      lexer.edit(0, 0, "\n\n");
+
+      // `y`
+      auto y = lexer.make_symbol(4, &filename);
+      AssertThat(y.location.begin.line, Equals(4u));
+      AssertThat(y.location.begin.column, Equals(4u));
+      AssertThat(*y.location.begin.filename, Equals("test"));
+    });
+  });
+});
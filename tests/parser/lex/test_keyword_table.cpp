@@ -0,0 +1,75 @@
+#include "parser/lex/keyword_table.h"
+#include <bandit/bandit.h>
+#include <string>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("keyword table", []() {
+    it("finds keywords and nothing else", [&]() {
+      keyword_table table({
+          {symbol("if"), keyword::IF},
+          {symbol("else"), keyword::ELSE},
+          {symbol("while"), keyword::WHILE},
+      });
+
+      AssertThat(table.find("if") == keyword::IF, IsTrue());
+      AssertThat(table.find("else") == keyword::ELSE, IsTrue());
+      AssertThat(table.find("while") == keyword::WHILE, IsTrue());
+
+      AssertThat(table.find("iff").has_value(), IsFalse());
+      AssertThat(table.find("").has_value(), IsFalse());
+      AssertThat(table.find("x").has_value(), IsFalse());
+
+      // Minimal
+      AssertThat(table.slot_count(), Equals(3u));
+    });
+
+    it("doesn't intern names it looks for", [&]() {
+      keyword_table table({{symbol("if"), keyword::IF}});
+      auto interned = interner::global().size();
+
+      AssertThat(table.find("never seen before").has_value(), IsFalse());
+      AssertThat(interner::global().size(), Equals(interned));
+      AssertThat(symbol::find("never seen before").has_value(), IsFalse());
+    });
+
+    it("is empty by default", [&]() {
+      keyword_table table;
+
+      AssertThat(table.find("if").has_value(), IsFalse());
+      AssertThat(table.size(), Equals(0u));
+    });
+
+    it("changes when keywords are set", [&]() {
+      keyword_table table({{symbol("while"), keyword::WHILE}});
+
+      table.set(symbol("enquanto"), keyword::WHILE);
+      table.set(symbol("se"), keyword::IF);
+
+      AssertThat(table.find("while") == keyword::WHILE, IsTrue());
+      AssertThat(table.find("enquanto") == keyword::WHILE, IsTrue());
+      AssertThat(table.find("se") == keyword::IF, IsTrue());
+
+      table.set(symbol("se"), keyword::ELSE);
+      AssertThat(table.find("se") == keyword::ELSE, IsTrue());
+      AssertThat(table.size(), Equals(3u));
+    });
+
+    it("still works with many keywords", [&]() {
+      keyword_table table;
+
+      for (int i = 0; i < 64; ++i) {
+        table.set(symbol("keyword" + std::to_string(i)), keyword::READ);
+      }
+
+      for (int i = 0; i < 64; ++i) {
+        AssertThat(table.find("keyword" + std::to_string(i)).has_value(),
+                   IsTrue());
+      }
+
+      AssertThat(table.find("keyword64").has_value(), IsFalse());
+    });
+  });
+});
@@ -160,5 +160,44 @@ go_bandit([]() {
       AssertThat(scanner.yylex().type_get(),
                  Equals(yy::parser::symbol_kind_type::S_YYEOF));
     });
+
+    it("gives strings as views into the source", [&]() {
+      std::string source = "hello \"wor\\tld\" there";
+      yy::scanner scanner(source);
+      scanner.source = source;
+
+      auto hello = scanner.yylex().value.as<symbol>();
+      auto world = scanner.yylex().value.as<std::string_view>();
+      auto there = scanner.yylex().value.as<symbol>();
+
+      AssertThat(hello.text() == "hello", IsTrue());
+      AssertThat(std::string(world), Equals("\"wor\\tld\""));
+      AssertThat(there.text() == "there", IsTrue());
+
+      AssertThat(world.data() == source.data() + 6, IsTrue());
+    });
+
+    it("copies strings when it doesn't have the source", [&]() {
+      yy::scanner scanner("\"some\" \"strings\"");
+
+      auto some = scanner.yylex().value.as<std::string_view>();
+      auto strings = scanner.yylex().value.as<std::string_view>();
+
+      AssertThat(std::string(some), Equals("\"some\""));
+      AssertThat(std::string(strings), Equals("\"strings\""));
+    });
+
+    it("interns identifiers", [&]() {
+      yy::scanner scanner("apple banana apple");
+
+      auto first = scanner.yylex().value.as<symbol>();
+      auto second = scanner.yylex().value.as<symbol>();
+      auto third = scanner.yylex().value.as<symbol>();
+
+      AssertThat(first == third, IsTrue());
+      AssertThat(first == second, IsFalse());
+      AssertThat(first.get_id(), Equals(symbol("apple").get_id()));
+      AssertThat(interner::global().find("apple").has_value(), IsTrue());
+    });
   });
 });
@@ -1,5 +1,5 @@
 #include "constraints.h" // EqualsRef
-#include "parser/ast.h"
+#include "parser/ast_arena.h"
 #include "parser/lex/scanner.hpp"
 #include "parser/syntax/symbol_table_stack.h"
 #include <bandit/bandit.h>
@@ -8,25 +8,24 @@ using namespace snowhouse;
 using namespace bandit;
 
 #define NODE(VarName, NodeName, ...)                                           \
-  std::shared_ptr<ast_node> VarName =                                          \
-      std::make_shared<NodeName##_node>(__VA_ARGS__, location)
+  ast_node *VarName = arena.make<NodeName##_node>(__VA_ARGS__, location)
 
 #define STMT_NODE(VarName, NodeName, ...)                                      \
-  std::shared_ptr<ast_node> VarName = std::make_shared<statement_node>(        \
-      std::make_shared<NodeName##_node>(__VA_ARGS__, location), location)
+  ast_node *VarName = arena.make<statement_node>(                              \
+      arena.make<NodeName##_node>(__VA_ARGS__, location), location)
 
-#define NOOP(VarName)                                                          \
-  std::shared_ptr<ast_node> VarName = std::make_shared<noop_node>(location)
+#define NOOP(VarName) ast_node *VarName = arena.make<noop_node>(location)
 
 #define VAR(Name, TypeEntry)                                                   \
   var_table_entry var_##Name##_entry;                                          \
-  var_##Name##_entry.name = #Name;                                             \
+  var_##Name##_entry.name = symbol(#Name);                                     \
   var_##Name##_entry.type = TypeEntry;                                         \
   NODE(var_##Name##_node, var_identifier, &var_##Name##_entry)
 
 #define MAKE_VAR(Name, TypeEntry)                                              \
   auto maybe_var_##Name##_entry =                                              \
-      root_symbol_table->insert_variable(#Name, yy::location(), TypeEntry);    \
+      root_symbol_table->insert_variable(symbol(#Name), yy::location(),        \
+                                         TypeEntry);                           \
                                                                                \
   AssertThat(maybe_var_##Name##_entry.has_value(), IsTrue());                  \
   auto var_##Name##_entry = maybe_var_##Name##_entry.value();                  \
@@ -34,7 +33,7 @@ using namespace bandit;
 
 #define TYPE(Name, Value)                                                      \
   type_table_entry type_##Name##_entry;                                        \
-  type_##Name##_entry.name = #Name;                                            \
+  type_##Name##_entry.name = symbol(#Name);                                    \
   type_##Name##_entry.value = Value;                                           \
   NODE(type_##Name##_node, type_identifier, &type_##Name##_entry)
 
@@ -42,10 +41,11 @@ using namespace bandit;
   std::string prelude = "prelude";                                             \
   auto root_symbol_table = stbuilder.current();                                \
   auto location = yy::location(&prelude, 0, 0);                                \
-  auto test_t = root_symbol_table->insert_type("test_t", location,             \
-                                               std::make_shared<type_int>());  \
+  auto test_t = root_symbol_table->insert_type(                                \
+      symbol("test_t"), location, type_context::global().int_type());          \
   auto test_var =                                                              \
-      root_symbol_table->insert_variable("test_var", location, test_t.value())
+      root_symbol_table->insert_variable(symbol("test_var"), location,         \
+                                         test_t.value())
 
 #define INIT_PARSER(Input)                                                     \
   yy::scanner scanner(Input);                                                  \
@@ -53,8 +53,9 @@ using namespace bandit;
   symbol_table_stack stbuilder;                                                \
   std::string message_recipient;                                               \
   INIT_SYMBOL_TABLE;                                                           \
-  std::shared_ptr<ast_node> result;                                            \
-  yy::parser parser(scanner, stbuilder, &result, &message_recipient)
+  ast_arena arena;                                                             \
+  ast_node *result;                                                            \
+  yy::parser parser(scanner, stbuilder, arena, &result, &message_recipient)
 
 #define PARSE(Input)                                                           \
   INIT_PARSER(Input);                                                          \
@@ -248,7 +249,8 @@ using namespace bandit;
     VAR(test_var, test_t.value());                                             \
     VAR(test_var2, test_t.value());                                            \
                                                                                \
-    root_symbol_table->insert_variable("test_var2", location, test_t.value()); \
+    root_symbol_table->insert_variable(symbol("test_var2"), location,         \
+                                       test_t.value());                        \
     auto ok = parser.parse();                                                  \
                                                                                \
     NODE(x_0, int_literal, 0);                                                 \
@@ -381,7 +383,7 @@ go_bandit([]() {
 
     it("parses variable declaration", [&]() {
       PARSE_SUCCESS("test_t jest;");
-      TYPE(test_t, std::make_shared<type_int>());
+      TYPE(test_t, type_context::global().int_type());
       VAR(jest, test_t.value());
 
       STMT_NODE(x_decl, declaration, type_test_t_node, var_jest_node);
@@ -390,7 +392,7 @@ go_bandit([]() {
       NODE(x_block, block, root_symbol_table, x_seq);
       AssertThat(*result, EqualsRef(*x_block));
 
-      auto block = std::dynamic_pointer_cast<block_node>(result);
+      auto block = dynamic_cast<block_node *>(result);
       AssertThat(block->table->get_var("jest").has_value(), Is().True());
     });
 
@@ -399,14 +401,15 @@ go_bandit([]() {
 
     it("fails parsing variable declaration: variable redeclaration", [&]() {
       INIT_PARSER("test_t x;");
-      root_symbol_table->insert_variable("x", location, test_t.value());
+      root_symbol_table->insert_variable(symbol("x"), location,
+                                         test_t.value());
       auto ok = parser.parse();
       AssertThat(ok, Equals(1));
     });
 
     it("parses variable declaration: type and name the same", [&]() {
       PARSE_SUCCESS("test_t test_t;");
-      TYPE(test_t, std::make_shared<type_int>());
+      TYPE(test_t, type_context::global().int_type());
       VAR(test_t, test_t.value());
 
       STMT_NODE(x_decl, declaration, type_test_t_node, var_test_t_node);
@@ -418,7 +421,7 @@ go_bandit([]() {
 
     it("parses variable declaration & assignment", [&]() {
       PARSE_SUCCESS("test_t n1 = 0;");
-      TYPE(test_t, std::make_shared<type_int>());
+      TYPE(test_t, type_context::global().int_type());
       VAR(n1, test_t.value());
 
       NODE(x_lit, int_literal, 0);
@@ -476,7 +479,7 @@ go_bandit([]() {
 
     it("parses variable declarations in blocks", [&]() {
       PARSE_SUCCESS("{ test_t plato; }");
-      TYPE(test_t, std::make_shared<type_int>());
+      TYPE(test_t, type_context::global().int_type());
       VAR(plato, test_t.value());
 
       NOOP(x_noop);
@@ -488,11 +491,11 @@ go_bandit([]() {
       NODE(x_block, block, root_symbol_table, x_outer_seq);
       AssertThat(*result, EqualsRef(*x_block));
 
-      auto outer_block_node = std::dynamic_pointer_cast<block_node>(result);
-      auto outer_seq_node = std::dynamic_pointer_cast<sequence_node>(
-          outer_block_node->children[0]);
+      auto outer_block_node = dynamic_cast<block_node *>(result);
+      auto outer_seq_node =
+          dynamic_cast<sequence_node *>(outer_block_node->children[0]);
       auto inner_block_node =
-          std::dynamic_pointer_cast<block_node>(outer_seq_node->children[0]);
+          dynamic_cast<block_node *>(outer_seq_node->children[0]);
       auto definitely_not_plato = outer_block_node->table->get_var("plato");
       auto hopefully_plato = inner_block_node->table->get_var("plato");
 
@@ -502,7 +505,7 @@ go_bandit([]() {
 
     it("checks for variables in outer blocks", [&]() {
       PARSE_SUCCESS("test_t shadow; { shadow; }");
-      TYPE(test_t, std::make_shared<type_int>());
+      TYPE(test_t, type_context::global().int_type());
       VAR(shadow, test_t.value());
 
       NOOP(x_noop);
@@ -518,9 +521,9 @@ go_bandit([]() {
 
     it("shadows variables from outer blocks", [&]() {
       INIT_PARSER("test_t shadow; { test_t2 shadow; }");
-      TYPE(test_t, std::make_shared<type_int>());
-      TYPE(test_t2, std::make_shared<type_int>());
-      root_symbol_table->insert_type("test_t2", location,
+      TYPE(test_t, type_context::global().int_type());
+      TYPE(test_t2, type_context::global().int_type());
+      root_symbol_table->insert_type(symbol("test_t2"), location,
                                      type_test_t2_entry.value);
       VAR(shadow, test_t.value());
 
@@ -537,13 +540,13 @@ go_bandit([]() {
       NODE(x_block, block, root_symbol_table, x_outer_seq1);
       AssertThat(*result, EqualsRef(*x_block));
 
-      auto outer_block_node = std::dynamic_pointer_cast<block_node>(result);
-      auto outer_seq1_node = std::dynamic_pointer_cast<sequence_node>(
-          outer_block_node->children[0]);
-      auto outer_seq2_node = std::dynamic_pointer_cast<sequence_node>(
-          outer_seq1_node->children[1]);
+      auto outer_block_node = dynamic_cast<block_node *>(result);
+      auto outer_seq1_node =
+          dynamic_cast<sequence_node *>(outer_block_node->children[0]);
+      auto outer_seq2_node =
+          dynamic_cast<sequence_node *>(outer_seq1_node->children[1]);
       auto inner_block_node =
-          std::dynamic_pointer_cast<block_node>(outer_seq2_node->children[0]);
+          dynamic_cast<block_node *>(outer_seq2_node->children[0]);
 
       auto outer_shadow = outer_block_node->table->get_var("shadow");
       auto inner_shadow = inner_block_node->table->get_var("shadow");
@@ -554,8 +557,8 @@ go_bandit([]() {
       auto outer_shadow_value = outer_shadow.value();
       auto inner_shadow_value = inner_shadow.value();
 
-      AssertThat(outer_shadow_value->type->name, Equals("test_t"));
-      AssertThat(inner_shadow_value->type->name, Equals("test_t2"));
+      AssertThat(outer_shadow_value->type->name, Equals(symbol("test_t")));
+      AssertThat(inner_shadow_value->type->name, Equals(symbol("test_t2")));
     });
 
     it("checks for variables in outer blocks: fail",
@@ -644,7 +647,7 @@ go_bandit([]() {
       PARSE_SUCCESS("start: 10;");
 
       STMT_NODE(x_10, int_literal, 10);
-      NODE(x_start, label, "start");
+      NODE(x_start, label, symbol("start"));
       NOOP(x_noop);
       NODE(x_seq1, sequence, x_10, x_noop);
       NODE(x_seq2, sequence, x_start, x_seq1);
@@ -655,7 +658,7 @@ go_bandit([]() {
     it("goto: simple", [&]() {
       PARSE_SUCCESS("goto start;");
 
-      STMT_NODE(x_goto, goto, "start");
+      STMT_NODE(x_goto, goto, symbol("start"));
       NOOP(x_noop);
       NODE(x_seq, sequence, x_goto, x_noop);
       NODE(x_block, block, root_symbol_table, x_seq);
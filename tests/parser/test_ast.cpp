@@ -1,7 +1,67 @@
 #include "parser/ast.h"
+#include "parser/ast_arena.h"
 #include <bandit/bandit.h>
+#include <sstream>
 
 using namespace snowhouse;
 using namespace bandit;
 
-// Empty for now.
+static ast_node *minus_chain(ast_arena &arena, int depth, std::int64_t value) {
+  yy::location location;
+  ast_node *chain = arena.make<int_literal_node>(value, location);
+
+  for (int i = 0; i < depth; ++i) {
+    chain = arena.make<unary_minus_node>(chain, location);
+  }
+
+  return chain;
+}
+
+go_bandit([]() {
+  describe("ast", []() {
+    it("prints nodes with their children", [&]() {
+      ast_arena arena;
+      yy::location location;
+
+      auto one = arena.make<int_literal_node>(1, location);
+      auto two = arena.make<int_literal_node>(2, location);
+      auto sum = arena.make<sum_node>(one, two, location);
+      auto noop = arena.make<noop_node>(location);
+
+      std::ostringstream printed;
+      printed << *sum << " " << *noop;
+
+      AssertThat(printed.str(),
+                 Equals("SUM[int](INT_LITERAL[int](1), INT_LITERAL[int](2)) "
+                        "NOOP()"));
+    });
+
+    it("compares children too", [&]() {
+      ast_arena arena;
+
+      AssertThat(*minus_chain(arena, 3, 1) == *minus_chain(arena, 3, 1),
+                 IsTrue());
+      AssertThat(*minus_chain(arena, 3, 1) == *minus_chain(arena, 3, 2),
+                 IsFalse());
+      AssertThat(*minus_chain(arena, 3, 1) == *minus_chain(arena, 2, 1),
+                 IsFalse());
+    });
+
+    it("compares and prints very deep trees", [&]() {
+      ast_arena arena;
+      auto a = minus_chain(arena, 1000000, 1);
+      auto b = minus_chain(arena, 1000000, 1);
+      auto c = minus_chain(arena, 1000000, 2);
+
+      AssertThat(*a == *b, IsTrue());
+      AssertThat(*a == *c, IsFalse());
+
+      std::ostringstream printed;
+      printed << *a;
+
+      AssertThat(printed.str().size(),
+                 Equals(1000000 * std::string("UNARY_MINUS[int]()").size() +
+                        std::string("INT_LITERAL[int](1)").size()));
+    });
+  });
+});
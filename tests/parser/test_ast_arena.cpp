@@ -0,0 +1,51 @@
+#include "parser/ast_arena.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("ast arena", []() {
+    it("makes nodes that point to each other", [&]() {
+      ast_arena arena;
+      yy::location location;
+
+      auto one = arena.make<int_literal_node>(1, location);
+      auto two = arena.make<int_literal_node>(2, location);
+      auto sum = arena.make<sum_node>(one, two, location);
+
+      AssertThat(sum->children.size(), Equals(2u));
+      AssertThat(sum->children[0] == one, IsTrue());
+      AssertThat(sum->children[1] == two, IsTrue());
+      AssertThat(arena.size(), Equals(3u));
+    });
+
+    it("destroys its nodes with it", [&]() {
+      auto typ = type_context::global().int_type();
+      auto before = typ.use_count();
+
+      {
+        ast_arena arena;
+        yy::location location;
+        arena.make<int_literal_node>(1, location)->typ = typ;
+        AssertThat(typ.use_count(), Equals(before + 1));
+      }
+
+      AssertThat(typ.use_count(), Equals(before));
+    });
+
+    it("keeps a million nodes in a few blocks", [&]() {
+      ast_arena arena;
+      yy::location location;
+      ast_node *chain = arena.make<noop_node>(location);
+
+      // Deep enough that destroying it recursively would overflow the stack
+      for (int i = 0; i < 1000000; ++i) {
+        chain = arena.make<sequence_node>(chain, chain, location);
+      }
+
+      AssertThat(arena.size(), Equals(1000001u));
+      AssertThat(arena.block_count(), IsLessThan(32u));
+    });
+  });
+});
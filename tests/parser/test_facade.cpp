@@ -0,0 +1,442 @@
+#include "parser/facade.h"
+#include <bandit/bandit.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <unistd.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+// The `n`th statement of the outermost block
+static ast_node *statement_at(ast_node *root, std::size_t n) {
+  auto link = root->children[0];
+
+  for (std::size_t i = 0; i < n; ++i) {
+    link = link->children[1];
+  }
+
+  return link->children[0];
+}
+
+// Every location in the tree, to tell trees apart where `==` doesn't look
+static std::string locations_of(ast_node *root) {
+  std::ostringstream out;
+  std::vector<ast_node *> pending{root};
+
+  while (!pending.empty()) {
+    auto node = pending.back();
+    pending.pop_back();
+
+    if (node == nullptr) {
+      out << "_ ";
+      continue;
+    }
+
+    out << node->location << ' ';
+    pending.insert(pending.end(), node->children.begin(),
+                   node->children.end());
+  }
+
+  return out.str();
+}
+
+// Every variable and its offset, scope by scope
+static std::string variables_of(ast_node *root) {
+  std::ostringstream out;
+  std::vector<symbol_table *> pending{
+      static_cast<block_node *>(root)->table.get()};
+
+  while (!pending.empty()) {
+    auto table = pending.back();
+    pending.pop_back();
+
+    for (auto &entry : table->vars()) {
+      out << entry.name.text() << '@' << entry.offset << ' ';
+    }
+
+    auto &children = table->get_children();
+    pending.insert(pending.end(), children.rbegin(), children.rend());
+  }
+
+  return out.str();
+}
+
+static bool same_as_full_parse(incremental_parser &p, parse_result &result) {
+  parser whole(p.get_source());
+  auto expected = whole.parse();
+
+  if (result.success != expected.success) {
+    return false;
+  }
+
+  if (!result.success) {
+    return result.message == expected.message;
+  }
+
+  return *result.ast == *expected.ast &&
+         locations_of(result.ast) == locations_of(expected.ast) &&
+         variables_of(result.ast) == variables_of(expected.ast);
+}
+
+go_bandit([]() {
+  describe("parser facade", []() {
+    it("keeps identifier names after parsing", [&]() {
+      parser p("int first; int second = first; second = 2;");
+      auto result = p.parse();
+
+      AssertThat(result.success, IsTrue());
+
+      auto block = dynamic_cast<block_node *>(result.ast);
+      AssertThat(block->table->get_var("first").has_value(), IsTrue());
+      AssertThat(block->table->get_var("second").has_value(), IsTrue());
+      AssertThat(block->table->get_var("second").value()->name,
+                 Equals(symbol("second")));
+    });
+
+    it("keeps the tree after the parser is gone", [&]() {
+      parse_result result;
+
+      {
+        parser p("int x; x = 1 + 2;");
+        result = p.parse();
+      }
+
+      AssertThat(result.success, IsTrue());
+      AssertThat(result.ast->kind, Equals(ast_node_kind::BLOCK));
+      AssertThat(result.arena->size(), IsGreaterThan(0u));
+    });
+
+    it("parses another source after a reset", [&]() {
+      parser p("int x; enquanto (x < 3) x += 1;");
+      p.set_keyword(keyword::WHILE, "enquanto");
+      auto first = p.parse();
+      AssertThat(first.success, IsTrue());
+
+      // Keeps the keyword, and leaves the first tree alone
+      p.reset("int y; enquanto (y > 0) y -= 1;");
+      auto second = p.parse();
+      AssertThat(second.success, IsTrue());
+      AssertThat(first.arena == second.arena, IsFalse());
+
+      parser whole("int x; while (x < 3) x += 1;");
+      AssertThat(*first.ast == *whole.parse().ast, IsTrue());
+
+      // Nothing holds on to the arena now, so it's used again
+      auto arena = second.arena.get();
+      first = second = parse_result();
+      p.reset("int z;");
+      AssertThat(p.parse().arena.get() == arena, IsTrue());
+    });
+
+    it("uses keywords that were set", [&]() {
+      parser p("int x; enquanto (x < 3) x += 1;");
+      p.set_keyword(keyword::WHILE, "enquanto");
+      auto result = p.parse();
+
+      AssertThat(result.success, IsTrue());
+    });
+
+    it("parses files", [&]() {
+      std::string path = "test_facade_input.tkw";
+      std::ofstream(path) << "int first;\nint second = first;\n";
+
+      auto p = parser::from_file(path);
+      auto result = p.parse();
+      std::remove(path.c_str());
+
+      AssertThat(result.success, IsTrue());
+
+      auto block = dynamic_cast<block_node *>(result.ast);
+      auto second = block->table->get_var("second").value();
+      AssertThat(*second->declared_at.begin.filename, Equals(path));
+      AssertThat(second->declared_at.begin.line, Equals(2));
+    });
+
+    it("parses files after a reset", [&]() {
+      std::string path = "test_facade_reset.tkw";
+      std::ofstream(path) << "int x;\nx = ;\n";
+
+      parser p("int y;");
+      AssertThat(p.parse().success, IsTrue());
+
+      p.reset(std::make_unique<mapped_file>(path), path);
+      std::remove(path.c_str());
+      auto result = p.parse();
+
+      AssertThat(result.success, IsFalse());
+      AssertThat(result.message.rfind(path + ":2", 0), Equals(0u));
+    });
+
+    it("names the file in errors", [&]() {
+      std::string path = "test_facade_error.tkw";
+      std::ofstream(path) << "int x;\nx = ;\n";
+
+      auto fd = open(path.c_str(), O_RDONLY);
+      auto p = parser::from_descriptor(fd, "generated.tkw");
+      close(fd);
+      std::remove(path.c_str());
+
+      auto result = p.parse();
+
+      AssertThat(result.success, IsFalse());
+      AssertThat(result.message.rfind("generated.tkw:2", 0), Equals(0u));
+    });
+
+    it("reads pipes, which can't be mapped", [&]() {
+      std::string source = "int x;\nx = ;\n";
+      int fds[2];
+      AssertThat(pipe(fds), Equals(0));
+      AssertThat(write(fds[1], source.data(), source.size()),
+                 Equals((ssize_t)source.size()));
+      close(fds[1]);
+
+      auto p = parser::from_descriptor(fds[0], "piped.tkw");
+      close(fds[0]);
+
+      auto result = p.parse();
+
+      AssertThat(result.success, IsFalse());
+      AssertThat(result.message.rfind("piped.tkw:2", 0), Equals(0u));
+    });
+
+    it("parses empty files", [&]() {
+      std::string path = "test_facade_empty.tkw";
+      std::ofstream{path};
+
+      auto p = parser::from_file(path);
+      auto result = p.parse();
+      std::remove(path.c_str());
+
+      AssertThat(result.success, IsTrue());
+    });
+
+    it("parses again after edits", [&]() {
+      incremental_parser p("int x;\nx = 1;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      // `x = 1;` to `x = y;`, with `y` undeclared
+      p.edit(11, 1, "y");
+      AssertThat(p.get_source(), Equals("int x;\nx = y;\n"));
+      AssertThat(p.parse().success, IsFalse());
+
+      p.edit(0, 0, "int y = 2;\n");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+
+      parser whole(p.get_source());
+      AssertThat(*result.ast == *whole.parse().ast, IsTrue());
+    });
+
+    it("parses again only the statements edits touched", [&]() {
+      incremental_parser p("int x;\nx = 1;\nx = 2;\nx = 3;\n");
+      auto before = p.parse();
+      AssertThat(before.success, IsTrue());
+      AssertThat(p.last_change().full, IsTrue());
+
+      auto untouched = statement_at(before.ast, 3);
+
+      // `x = 2;` to `x = 22;`
+      p.edit(18, 0, "2");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+
+      // The one before too, in case it was an `if` taking an `else`
+      auto change = p.last_change();
+      AssertThat(change.full, IsFalse());
+      AssertThat(change.first, Equals(1u));
+      AssertThat(change.removed, Equals(2u));
+      AssertThat(change.inserted, Equals(2u));
+      AssertThat(statement_at(result.ast, 3) == untouched, IsTrue());
+
+      parser whole(p.get_source());
+      AssertThat(*result.ast == *whole.parse().ast, IsTrue());
+    });
+
+    it("moves the locations of statements after edits", [&]() {
+      incremental_parser p("int x;\nx = 1; x = 2;\nx = 3;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      // `x = 1;` to `x = 100;`, then a new line before it
+      p.edit(11, 1, "100");
+      p.edit(7, 0, "x = 0;\n");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+      AssertThat(p.last_change().full, IsFalse());
+
+      parser whole(p.get_source());
+      auto expected = whole.parse();
+
+      for (std::size_t i = 0; i < 5; ++i) {
+        auto got = statement_at(result.ast, i)->location;
+        auto want = statement_at(expected.ast, i)->location;
+
+        AssertThat(got.begin.line, Equals(want.begin.line));
+        AssertThat(got.begin.column, Equals(want.begin.column));
+        AssertThat(got.end.column, Equals(want.end.column));
+      }
+    });
+
+    it("moves the spans of statement lists after edits", [&]() {
+      incremental_parser p("int x;\nx = 1;\nx = 2;\nx = 3;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      // A line before `x = 2;`, and `x = 3;` to `x = 3 + 4;`
+      p.edit(14, 0, "x = 0;\n");
+      p.edit(33, 0, " + 4");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+      AssertThat(p.last_change().full, IsFalse());
+
+      parser whole(p.get_source());
+      auto expected = whole.parse();
+
+      // The block, each sequence node, then the `noop` at the end
+      auto lists = [](ast_node *root) {
+        std::vector<ast_node *> nodes{root};
+
+        for (auto link = root->children[0];; link = link->children[1]) {
+          nodes.push_back(link);
+
+          if (link->kind != ast_node_kind::SEQUENCE) {
+            return nodes;
+          }
+        }
+      };
+
+      auto got = lists(result.ast);
+      auto want = lists(expected.ast);
+      AssertThat(got.size(), Equals(want.size()));
+
+      for (std::size_t i = 0; i < got.size(); ++i) {
+        auto &at = got[i]->location;
+        auto &expected_at = want[i]->location;
+
+        AssertThat(at.begin.line, Equals(expected_at.begin.line));
+        AssertThat(at.begin.column, Equals(expected_at.begin.column));
+        AssertThat(at.end.line, Equals(expected_at.end.line));
+        AssertThat(at.end.column, Equals(expected_at.end.column));
+      }
+    });
+
+    it("keeps variables packed after removing blocks with some", [&]() {
+      incremental_parser p(
+          "int x = 3;\n{ int z = 1; }\nint y = 5;\nif (x > 2) write y;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      // Without the block, `y` takes the place of `z`
+      p.edit(11, 15, "");
+      auto result = p.parse();
+
+      AssertThat(result.success, IsTrue());
+      AssertThat(variables_of(result.ast), Equals("x@0 y@8 "));
+    });
+
+    it("parses like a full parse after random edits", [&]() {
+      incremental_parser p("int x = 3;\n{ int z = 1; }\nint y = 5;\n"
+                           "if (x > 2) write y;\nx = 1;\n"
+                           "while (x < 3) {\n  x += 1;\n}\nwrite x;\n");
+
+      // Whole lines, so that most edits still parse
+      std::vector<std::string> lines = {
+          "x = 1;\n",
+          "{ int z = 1; }\n",
+          "{ x = 2; }\n",
+          "write x;\n",
+          "if (x > 2) write y;\n",
+          "if (x > 2)\n",
+          "{ { int q = 4; } write x; }\n",
+          "while (x < 3) x += 1;\n",
+          "write y;\n",
+      };
+
+      std::mt19937 random(7);
+      std::size_t incremental = 0;
+
+      for (int i = 0; i < 1000; ++i) {
+        auto &source = p.get_source();
+        std::vector<std::size_t> starts{0};
+
+        for (std::size_t at = 0; at < source.size(); ++at) {
+          if (source[at] == '\n') {
+            starts.push_back(at + 1);
+          }
+        }
+
+        // The declarations at the top and the last line stay
+        auto line = 3 + random() % (starts.size() - 4);
+        auto at = starts[line];
+
+        if (random() % 2 == 0 && line + 2 < starts.size()) {
+          p.edit(at, starts[line + 1] - at, "");
+        } else {
+          auto pick = random() % (lines.size() + 1);
+          p.edit(at, 0,
+                 pick < lines.size() ? lines[pick]
+                                     : "int w" + std::to_string(i) + ";\n");
+        }
+
+        // Sometimes a few edits at once
+        if (random() % 3 == 0) {
+          continue;
+        }
+
+        auto result = p.parse();
+        incremental += !p.last_change().full;
+
+        if (!same_as_full_parse(p, result)) {
+          AssertThat(p.get_source(), Equals("parsed like a full parse"));
+        }
+      }
+
+      AssertThat(incremental, IsGreaterThan(100u));
+    });
+
+    it("parses everything again after declarations change", [&]() {
+      incremental_parser p("int x;\nx = 1;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      p.edit(7, 0, "int y;\n");
+      AssertThat(p.parse().success, IsTrue());
+      AssertThat(p.last_change().full, IsTrue());
+    });
+
+    it("doesn't use variables before they're declared after edits", [&]() {
+      incremental_parser p("int x;\nx = 1;\nint y;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      // `x = 1;` to `x = y;`
+      p.edit(11, 1, "y");
+      AssertThat(p.parse().success, IsFalse());
+    });
+
+    it("gives an `else` to the `if` before it", [&]() {
+      incremental_parser p("int x;\nif (x) x = 1;\nx = 2;\n");
+      AssertThat(p.parse().success, IsTrue());
+
+      p.edit(21, 0, "else ");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+      AssertThat(p.last_change().full, IsFalse());
+
+      parser whole(p.get_source());
+      AssertThat(*result.ast == *whole.parse().ast, IsTrue());
+    });
+
+    it("uses keywords that were set after edits", [&]() {
+      incremental_parser p("int x; enquanto (x < 3) x += 1;");
+      AssertThat(p.parse().success, IsFalse());
+
+      p.set_keyword(keyword::WHILE, "enquanto");
+      AssertThat(p.parse().success, IsTrue());
+    });
+
+    it("fails on missing files", [&]() {
+      AssertThrows(std::system_error,
+                   parser::from_file("there is no such file.tkw"));
+    });
+  });
+});
@@ -0,0 +1,95 @@
+#include "parser/ast_arena.h"
+#include "parser/facade.h"
+#include "parser/flat_ast.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("flat ast", []() {
+    it("keeps nodes in preorder with their children after them", [&]() {
+      parser p("int x = 1; x = x + 2;");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+
+      auto flat = flatten(result.ast);
+
+      AssertThat(flat.size(), Equals(result.arena->size()));
+      AssertThat(flat.kinds[0], Equals(ast_node_kind::BLOCK));
+
+      for (node_index i = 0; i < flat.size(); ++i) {
+        if (flat.first_child[i] != no_node) {
+          AssertThat(flat.first_child[i], Equals(i + 1));
+        }
+      }
+    });
+
+    it("keeps what each node carries", [&]() {
+      parser p("int x = 40; x = x + 2;");
+      auto result = p.parse();
+      AssertThat(result.success, IsTrue());
+
+      auto flat = flatten(result.ast);
+      auto block = dynamic_cast<block_node *>(result.ast);
+      auto x = block->table->get_var("x").value();
+
+      int literals = 0;
+      int vars = 0;
+
+      for (node_index i = 0; i < flat.size(); ++i) {
+        if (flat.kinds[i] == ast_node_kind::INT_LITERAL) {
+          literals++;
+          AssertThat(flat.values[i].int_value == 40 ||
+                         flat.values[i].int_value == 2,
+                     IsTrue());
+        } else if (flat.kinds[i] == ast_node_kind::VAR_IDENTIFIER) {
+          vars++;
+          AssertThat(flat.values[i].var == x, IsTrue());
+        }
+      }
+
+      AssertThat(literals, Equals(2));
+      AssertThat(vars, Equals(3));
+      AssertThat(flat.values[0].table == block->table.get(), IsTrue());
+    });
+
+    it("links siblings in order", [&]() {
+      ast_arena arena;
+      yy::location location;
+
+      auto one = arena.make<int_literal_node>(1, location);
+      auto two = arena.make<int_literal_node>(2, location);
+      auto sum = arena.make<sum_node>(one, two, location);
+      auto typ = type_context::global().int_type();
+      sum->typ = one->typ = two->typ = typ;
+
+      auto flat = flatten(sum);
+
+      AssertThat(flat.size(), Equals(3u));
+      AssertThat(flat.values[flat.child(0, 0)].int_value, Equals(1));
+      AssertThat(flat.values[flat.child(0, 1)].int_value, Equals(2));
+      AssertThat(flat.child(0, 2), Equals(no_node));
+      AssertThat(flat.type_list.size(), Equals(1u));
+    });
+
+    it("flattens very deep trees", [&]() {
+      ast_arena arena;
+      yy::location location;
+      auto typ = type_context::global().void_type();
+
+      ast_node *chain = arena.make<noop_node>(location);
+      chain->typ = typ;
+
+      for (int i = 0; i < 1000000; ++i) {
+        chain = arena.make<block_node>(nullptr, chain, location);
+        chain->typ = typ;
+      }
+
+      auto flat = flatten(chain);
+
+      AssertThat(flat.size(), Equals(1000001u));
+      AssertThat(flat.kinds[1000000], Equals(ast_node_kind::NOOP));
+    });
+  });
+});
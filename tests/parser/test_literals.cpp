@@ -0,0 +1,77 @@
+#include "parser/facade.h"
+#include "parser/literals.h"
+#include <bandit/bandit.h>
+#include <limits>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("literals", []() {
+    it("parses integers of any length", [&]() {
+      std::string digits;
+      std::int64_t expected = 0;
+
+      // Every length up to 18 digits, so all the chunk sizes
+      for (int i = 1; i <= 18; ++i) {
+        auto digit = '0' + i % 10;
+        digits.push_back(digit);
+        expected = expected * 10 + (digit - '0');
+
+        AssertThat(parse_int(digits).value(), Equals(expected));
+      }
+
+      AssertThat(parse_int("0").value(), Equals(0));
+      AssertThat(parse_int("0000").value(), Equals(0));
+      AssertThat(parse_int("000000000000000000000000042").value(), Equals(42));
+      AssertThat(parse_int("9223372036854775807").value(),
+                 Equals(std::numeric_limits<std::int64_t>::max()));
+    });
+
+    it("doesn't parse integers that don't fit", [&]() {
+      AssertThat(parse_int("9223372036854775808").has_value(), IsFalse());
+      AssertThat(parse_int("18446744073709551616").has_value(), IsFalse());
+      AssertThat(parse_int("99999999999999999999999").has_value(), IsFalse());
+    });
+
+    it("parses floats", [&]() {
+      AssertThat(parse_float("1.").value(), Equals(1.0));
+      AssertThat(parse_float(".5").value(), Equals(0.5));
+      AssertThat(parse_float("2.5").value(), Equals(2.5));
+      AssertThat(parse_float("1e5").value(), Equals(1e5));
+      AssertThat(parse_float("2.5E-3").value(), Equals(2.5e-3));
+      AssertThat(parse_float("1e-999").value(), Equals(0.0));
+
+      AssertThat(parse_float("1e999").has_value(), IsFalse());
+    });
+
+    it("tells floats that are too big from those too small", [&]() {
+      // Too big, even with a negative exponent
+      auto nines = std::string(400, '9');
+      AssertThat(parse_float(nines + "e-1").has_value(), IsFalse());
+      AssertThat(parse_float("0.0001e400").has_value(), IsFalse());
+
+      // Too small, even with a positive exponent
+      auto zeros = "0." + std::string(400, '0');
+      AssertThat(parse_float(zeros + "1e5").value(), Equals(0.0));
+      AssertThat(parse_float("1000e-999").value(), Equals(0.0));
+    });
+
+    it("reports literals that don't fit", [&]() {
+      parser p("int x;\nx = 99999999999999999999;");
+      auto result = p.parse();
+
+      AssertThat(result.success, IsFalse());
+      AssertThat(result.message.find("2.4") != std::string::npos, IsTrue());
+      AssertThat(result.message.find("too big") != std::string::npos,
+                 IsTrue());
+
+      incremental_parser incremental("float y = 1e999;");
+      auto incremental_result = incremental.parse();
+
+      AssertThat(incremental_result.success, IsFalse());
+      AssertThat(incremental_result.message.find("1.10") != std::string::npos,
+                 IsTrue());
+    });
+  });
+});
@@ -0,0 +1,72 @@
+#include "parser/persistent_map.h"
+#include "parser/symbol_table.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("persistent map", []() {
+    it("leaves old versions as they were", [&]() {
+      persistent_map<int> empty;
+      auto one = empty.insert(symbol("a"), 1);
+      auto two = one.insert(symbol("b"), 2);
+      auto changed = two.insert(symbol("a"), 3);
+
+      AssertThat(empty.find(symbol("a")) == nullptr, IsTrue());
+      AssertThat(*one.find(symbol("a")), Equals(1));
+      AssertThat(one.find(symbol("b")) == nullptr, IsTrue());
+      AssertThat(*two.find(symbol("a")), Equals(1));
+      AssertThat(*two.find(symbol("b")), Equals(2));
+      AssertThat(*changed.find(symbol("a")), Equals(3));
+
+      AssertThat(two.size(), Equals(2u));
+      AssertThat(changed.size(), Equals(2u));
+    });
+
+    it("holds many names", [&]() {
+      persistent_map<int> map;
+      std::vector<persistent_map<int>> versions;
+
+      for (int i = 0; i < 5000; ++i) {
+        map = map.insert(symbol("persistent_" + std::to_string(i)), i);
+        versions.push_back(map);
+      }
+
+      AssertThat(map.size(), Equals(5000u));
+
+      for (int i = 0; i < 5000; ++i) {
+        auto name = symbol("persistent_" + std::to_string(i));
+        AssertThat(*map.find(name), Equals(i));
+        AssertThat(versions[i].size(), Equals(std::size_t(i + 1)));
+
+        if (i > 0) {
+          AssertThat(versions[i - 1].find(name) == nullptr, IsTrue());
+        }
+      }
+    });
+  });
+
+  describe("symbol table snapshots", []() {
+    it("see only what was declared before them", [&]() {
+      auto root = std::make_shared<symbol_table>();
+      root->init_default_symbols();
+      auto int_type = root->get_type("int").value();
+
+      auto before = root->snapshot();
+      root->insert_variable(symbol("x"), yy::location(), int_type);
+
+      auto everything = root->snapshot();
+      root->restore(before);
+      auto inner = std::make_shared<symbol_table>(root);
+
+      AssertThat(root->get_var("x").has_value(), IsFalse());
+      AssertThat(inner->get_var("x").has_value(), IsFalse());
+      AssertThat(inner->get_type("int").has_value(), IsTrue());
+
+      root->restore(everything);
+      AssertThat(root->get_var("x").has_value(), IsTrue());
+      AssertThat(root->get_prelude().vars.size(), Equals(0u));
+    });
+  });
+});
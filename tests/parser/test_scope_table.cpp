@@ -0,0 +1,87 @@
+#include "parser/scope_table.h"
+#include "parser/symbol_table.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+struct named {
+  symbol name;
+  int value;
+};
+
+go_bandit([]() {
+  describe("scope table", []() {
+    it("finds what was inserted", [&]() {
+      scope_table<named> table;
+
+      AssertThat(table.find(symbol("a")) == nullptr, IsTrue());
+      AssertThat(table.insert({symbol("a"), 1}) != nullptr, IsTrue());
+      AssertThat(table.insert({symbol("b"), 2}) != nullptr, IsTrue());
+
+      AssertThat(table.find(symbol("a"))->value, Equals(1));
+      AssertThat(table.find(symbol("b"))->value, Equals(2));
+      AssertThat(table.find(symbol("c")) == nullptr, IsTrue());
+    });
+
+    it("refuses the same name twice", [&]() {
+      scope_table<named> table;
+      table.insert({symbol("a"), 1});
+
+      AssertThat(table.insert({symbol("a"), 2}) == nullptr, IsTrue());
+      AssertThat(table.find(symbol("a"))->value, Equals(1));
+      AssertThat(table.size(), Equals(1u));
+    });
+
+    it("keeps entries in place and in order as it grows", [&]() {
+      scope_table<named> table;
+      std::vector<named *> inserted;
+
+      for (int i = 0; i < 1000; ++i) {
+        inserted.push_back(
+            table.insert({symbol("scope_table_" + std::to_string(i)), i}));
+      }
+
+      for (int i = 0; i < 1000; ++i) {
+        AssertThat(table.find(symbol("scope_table_" + std::to_string(i))),
+                   Equals(inserted[i]));
+      }
+
+      int expected = 0;
+      for (auto &entry : table) {
+        AssertThat(entry.value, Equals(expected++));
+      }
+
+      AssertThat(expected, Equals(1000));
+    });
+  });
+
+  describe("symbol table", []() {
+    it("hands out offsets from the root in deeply nested scopes", [&]() {
+      auto root = std::make_shared<symbol_table>();
+      root->init_default_symbols();
+      auto int_type = root->get_type("int").value();
+
+      std::vector<std::shared_ptr<symbol_table>> scopes = {root};
+
+      for (int i = 0; i < 100000; ++i) {
+        scopes.push_back(std::make_shared<symbol_table>(scopes.back()));
+      }
+
+      auto first = root->insert_variable(symbol("x"), yy::location(), int_type);
+      auto last =
+          scopes.back()->insert_variable(symbol("x"), yy::location(), int_type);
+
+      AssertThat(first.has_value() && last.has_value(), IsTrue());
+      AssertThat(last.value()->offset,
+                 Equals(first.value()->offset + int_type->value->size()));
+      AssertThat(scopes.back()->get_var("x").value(), Equals(last.value()));
+      AssertThat(scopes.back()->vars().size(), Equals(1u));
+
+      // Innermost first, or the last one would free the rest recursively
+      while (!scopes.empty()) {
+        scopes.pop_back();
+      }
+    });
+  });
+});
@@ -0,0 +1,44 @@
+#include "parser/facade.h"
+#include "parser/types.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("type context", []() {
+    it("hands out one instance of each type", [&]() {
+      type_context types;
+
+      AssertThat(types.int_type() == types.int_type(), IsTrue());
+      AssertThat(types.int_type()->matches(*types.int_type()), IsTrue());
+      AssertThat(types.int_type()->matches(*types.float_type()), IsFalse());
+    });
+
+    it("makes pointer types once", [&]() {
+      type_context types;
+
+      auto p1 = types.pointer_to(types.char_type());
+      auto p2 = types.pointer_to(types.char_type());
+      auto pp = types.pointer_to(p1);
+
+      AssertThat(p1 == p2, IsTrue());
+      AssertThat(p1->kind, Equals(type_kind::POINTER));
+      AssertThat(p1->matches(*types.pointer_to(types.int_type())), IsFalse());
+      AssertThat(pp == types.pointer_to(p2), IsTrue());
+    });
+
+    it("shares types between parses", [&]() {
+      parser p1("int x = 1;");
+      parser p2("int y = 2 + 3;");
+      auto r1 = p1.parse();
+      auto r2 = p2.parse();
+
+      auto x = dynamic_cast<block_node *>(r1.ast)->table->get_var("x").value();
+      auto y = dynamic_cast<block_node *>(r2.ast)->table->get_var("y").value();
+
+      AssertThat(x->type->value == y->type->value, IsTrue());
+      AssertThat(x->type->value == type_context::global().int_type(), IsTrue());
+    });
+  });
+});
@@ -0,0 +1,126 @@
+#include "parser/facade.h"
+#include "synthesis/compiler.h"
+#include "vm/interpreter.h"
+#include "vm/io.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <sys/resource.h>
+#endif
+
+// Parses, compiles and runs programs nested a million deep, like generated
+// ones can be, with little stack and a fixed amount of memory. Anything that
+// still recurses on the tree overflows the stack here instead of in a user's
+// browser. Not part of `run`, since it takes a while:
+//
+//   stress [depth]
+
+const std::uint64_t stack_budget = 1 << 20;
+const std::uint64_t memory_budget = 3ull << 30;
+
+struct stress_case {
+  std::string name;
+  // Nesting scale, since some take much more memory a level than others
+  int divisor;
+  std::function<std::string(int)> make;
+  std::int64_t expected;
+};
+
+static std::string repeat(const std::string &s, int times) {
+  std::string repeated;
+  repeated.reserve(s.size() * times);
+
+  for (int i = 0; i < times; ++i) {
+    repeated += s;
+  }
+
+  return repeated;
+}
+
+static std::vector<stress_case> cases() {
+  return {
+      {"parentheses", 1,
+       [](int depth) {
+         return "int x = " + repeat("(", depth) + "1" + repeat(")", depth) +
+                "; write x;";
+       },
+       1},
+      {"sums", 1,
+       [](int depth) {
+         // Left to right, so each sum is under the next
+         return "int x = " + repeat("1 + ", depth) + "0 - " +
+                std::to_string(depth) + "; write x;";
+       },
+       0},
+      {"blocks", 1,
+       [](int depth) {
+         return repeat("{", depth) + "write 1;" + repeat("}", depth);
+       },
+       1},
+      {"while loops", 1,
+       [](int depth) {
+         return "int x = 0;" + repeat("while (x > 0) ", depth) +
+                "x = 1; write 2;";
+       },
+       2},
+      {"else if chains", 2,
+       [](int depth) {
+         return "int x = 3;" +
+                repeat("if (x == 0) { write 0; } else ", depth) + "write 3;";
+       },
+       3},
+  };
+}
+
+static bool run_case(const stress_case &c, int depth) {
+  auto source = c.make(depth / c.divisor);
+
+  parser p(source);
+  auto parsed = p.parse();
+
+  if (!parsed.success) {
+    std::cout << c.name << ": " << parsed.message << '\n';
+    return false;
+  }
+
+  compiler comp;
+  auto prog = comp.compile(parsed.ast);
+
+  buffered_io io;
+  interpreter vm(prog, io);
+  vm.run();
+
+  if (io.output != std::vector<std::int64_t>{c.expected}) {
+    std::cout << c.name << ": wrong output\n";
+    return false;
+  }
+
+  std::cout << c.name << ": ok, " << prog.code.size() << " instructions\n";
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  auto depth = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+#ifndef __EMSCRIPTEN__
+  // The main thread's stack grows up to the limit at the time, so lowering it
+  // now still counts
+  rlimit stack{stack_budget, stack_budget};
+  rlimit memory{memory_budget, memory_budget};
+  setrlimit(RLIMIT_STACK, &stack);
+  setrlimit(RLIMIT_AS, &memory);
+#endif
+
+  auto failed = 0;
+
+  for (auto &c : cases()) {
+    if (!run_case(c, depth)) {
+      failed++;
+    }
+  }
+
+  return failed == 0 ? 0 : 1;
+}
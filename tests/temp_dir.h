@@ -0,0 +1,41 @@
+#ifndef TEMP_DIR_H
+#define TEMP_DIR_H
+
+#include <filesystem>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string>
+
+// A fresh directory for a test's files, removed with everything in it when the
+// test leaves by any path. Unique even when several test runs share /tmp
+class temp_dir {
+private:
+  std::filesystem::path path;
+
+public:
+  temp_dir(const std::string &prefix) {
+    auto pattern =
+        (std::filesystem::temp_directory_path() / (prefix + "XXXXXX")).string();
+
+    if (mkdtemp(pattern.data()) == nullptr) {
+      throw std::runtime_error("Can't create a directory like " + pattern);
+    }
+
+    this->path = pattern;
+  }
+
+  temp_dir(const temp_dir &) = delete;
+  temp_dir &operator=(const temp_dir &) = delete;
+
+  ~temp_dir() {
+    std::error_code ignored;
+    std::filesystem::remove_all(this->path, ignored);
+  }
+
+  const std::filesystem::path &get() const { return this->path; }
+  std::filesystem::path operator/(const std::string &name) const {
+    return this->path / name;
+  }
+};
+
+#endif /* TEMP_DIR_H */
@@ -0,0 +1,97 @@
+#ifndef TESTS_VM_PROGRAMS_H
+#define TESTS_VM_PROGRAMS_H
+
+#include "parser/facade.h"
+#include "synthesis/compiler.h"
+#include "vm/interpreter.h"
+
+// Example programs from the README, shared by the execution tests
+
+const std::string collatz_source = "\
+int number;\n\
+read number;\n\
+\n\
+int count = 0;\n\
+\n\
+while (number != 1) {\n\
+  if (number % 2 == 0) {\n\
+    number /= 2;\n\
+  } else {\n\
+    number = number * 3 + 1;\n\
+  }\n\
+\n\
+  count += 1;\n\
+}\n\
+\n\
+write count;\n\
+";
+
+const std::string prime_source = "\
+int x;\n\
+read x;\n\
+\n\
+int i = 2;\n\
+int primo = 1;\n\
+\n\
+if (x == 1) {\n\
+  primo = 0;\n\
+  goto end;\n\
+}\n\
+\n\
+while (i <= x / 2) {\n\
+  if (x % i == 0) {\n\
+    primo = 0;\n\
+    goto end;\n\
+  }\n\
+\n\
+  i += 1;\n\
+}\n\
+\n\
+end:\n\
+write primo;\n\
+";
+
+inline program compile_source(std::string source) {
+  parser p(source);
+  auto presult = p.parse();
+
+  compiler c;
+  return c.compile(presult.ast);
+}
+
+inline instruction_with_operands make_instruction(op operation,
+                                                  std::uint64_t operand = 0) {
+  instruction_with_operands instruction;
+  instruction.operation = operation;
+  instruction.operands[0] = operand;
+  return instruction;
+}
+
+// Runs each input alone with the interpreter
+inline std::vector<run_result>
+run_each(const program &prog,
+         const std::vector<std::vector<std::int64_t>> &inputs,
+         std::uint64_t fuel = unlimited_fuel) {
+  std::vector<run_result> results;
+
+  for (auto &input : inputs) {
+    buffered_io io(input);
+    interpreter vm(prog, io);
+    run_result result;
+
+    try {
+      result.reason = vm.run(fuel);
+    } catch (execution_error &e) {
+      result.reason = exit_reason::HALTED;
+      result.error.emplace(e);
+    }
+
+    result.output = io.output;
+    result.executed = vm.get_state().executed;
+    results.push_back(std::move(result));
+  }
+
+  return results;
+}
+
+#endif /* TESTS_VM_PROGRAMS_H */
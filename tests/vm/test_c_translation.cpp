@@ -0,0 +1,91 @@
+#include "programs.h"
+#include "temp_dir.h"
+#include "vm/c_translation.h"
+#include "vm/interpreter.h"
+#include <bandit/bandit.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+using namespace snowhouse;
+using namespace bandit;
+
+#ifndef __EMSCRIPTEN__
+
+// Compiles the translation with the host C compiler and runs it. Empty if
+// there is no compiler around
+static std::optional<std::vector<std::int64_t>>
+run_translated(const program &prog, const std::vector<std::int64_t> &inputs) {
+  if (std::system("cc --version > /dev/null 2>&1") != 0) {
+    return std::nullopt;
+  }
+
+  temp_dir dir("tokiwen_c_");
+  auto source = (dir / "translated.c").string();
+  auto binary = (dir / "translated").string();
+
+  std::ofstream(source) << translate_to_c(prog);
+
+  auto compile = "cc -O1 -o " + binary + " " + source;
+  if (std::system(compile.c_str()) != 0) {
+    return std::vector<std::int64_t>();
+  }
+
+  std::string input_text;
+  for (auto input : inputs) {
+    input_text += std::to_string(input) + " ";
+  }
+
+  auto command = "echo '" + input_text + "' | " + binary;
+  auto pipe = popen(command.c_str(), "r");
+
+  std::vector<std::int64_t> outputs;
+  long long value;
+
+  while (std::fscanf(pipe, "%lld", &value) == 1) {
+    outputs.push_back(value);
+  }
+
+  pclose(pipe);
+  return outputs;
+}
+
+#endif
+
+go_bandit([]() {
+  describe("c translation", []() {
+    it("uses labels and gotos", [&]() {
+      auto prog = compile_source(collatz_source);
+      auto source = translate_to_c(prog);
+
+      AssertThat(source.find("i0: ") != std::string::npos, IsTrue());
+      AssertThat(source.find("goto ") != std::string::npos, IsTrue());
+      AssertThat(source.find("int main(void)") != std::string::npos,
+                 IsTrue());
+    });
+
+#ifndef __EMSCRIPTEN__
+    it("writes the same as the interpreter", [&]() {
+      std::vector<std::pair<std::string, std::int64_t>> cases = {
+          {collatz_source, 27}, {prime_source, 97}, {prime_source, 100}};
+
+      for (auto &[source, input] : cases) {
+        auto prog = compile_source(source);
+
+        buffered_io io({input});
+        interpreter vm(prog, io);
+        vm.run();
+
+        auto outputs = run_translated(prog, {input});
+
+        if (!outputs.has_value()) {
+          return;
+        }
+
+        AssertThat(outputs.value() == io.output, IsTrue());
+      }
+    });
+#endif
+  });
+});
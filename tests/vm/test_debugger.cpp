@@ -0,0 +1,94 @@
+#include "programs.h"
+#include "vm/debugger.h"
+#include <algorithm>
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("debugger", []() {
+    it("stops at breakpoints", [&]() {
+      auto prog = compile_source(collatz_source);
+      debugger d(prog);
+      d.give_input(6);
+
+      // Wherever the division by 2 is
+      std::uint64_t divide = 0;
+      while (prog.code[divide].operation != op::DIVIDE_I &&
+             prog.code[divide].operation != op::DIVIDE) {
+        ++divide;
+      }
+
+      // 6 -> 3 -> 10 -> 5 -> 16 -> 8 -> 4 -> 2 -> 1, halved 6 times
+      int stops = 0;
+      while (d.run_until({divide}) == exit_reason::BREAKPOINT) {
+        AssertThat(d.get_state().pc, Equals(divide));
+        ++stops;
+      }
+
+      AssertThat(stops, Equals(6));
+      AssertThat(d.get_state().pc, IsGreaterThanOrEqualTo(prog.code.size()));
+      AssertThat(d.take_output()[0], Equals(8));
+    });
+
+    it("runs the same instructions as the interpreter", [&]() {
+      auto prog = compile_source(prime_source);
+      debugger d(prog);
+      d.give_input(91);
+
+      std::vector<std::uint64_t> breakpoints;
+      for (std::uint64_t pc = 0; pc < prog.code.size(); pc += 3) {
+        breakpoints.push_back(pc);
+      }
+
+      while (d.run_until(breakpoints) == exit_reason::BREAKPOINT) {
+      }
+
+      buffered_io io({91});
+      interpreter vm(prog, io);
+      vm.run();
+
+      AssertThat(d.get_state().executed, Equals(vm.get_state().executed));
+      AssertThat(d.take_output() == io.output, IsTrue());
+    });
+
+    it("runs one statement at a time", [&]() {
+      auto prog = compile_source(collatz_source);
+      debugger d(prog);
+      d.give_input(3);
+
+      auto &boundaries = prog.metadata.statement_boundaries;
+
+      while (d.run_one_statement() == exit_reason::BREAKPOINT) {
+        auto pc = d.get_state().pc;
+        AssertThat(std::find(boundaries.begin(), boundaries.end(), pc) !=
+                       boundaries.end(),
+                   IsTrue());
+      }
+
+      AssertThat(d.get_state().pc, IsGreaterThanOrEqualTo(prog.code.size()));
+    });
+
+    it("stops for input and budget", [&]() {
+      auto prog = compile_source(collatz_source);
+      debugger d(prog);
+
+      AssertThat(d.run_until({}, 1000),
+                 Equals(exit_reason::WAITING_FOR_INPUT));
+
+      d.give_input(27);
+      AssertThat(d.run_until({}, 10), Equals(exit_reason::OUT_OF_FUEL));
+
+      auto executed = d.get_state().executed;
+      AssertThat(d.run_until({}, 10), Equals(exit_reason::OUT_OF_FUEL));
+      AssertThat(d.get_state().executed, Equals(executed + 10));
+
+      AssertThat(d.run_until({}), Equals(exit_reason::HALTED));
+      AssertThat(d.take_output()[0], Equals(111));
+
+      d.reset();
+      AssertThat(d.get_state().executed, Equals(0u));
+    });
+  });
+});
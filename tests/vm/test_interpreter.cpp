@@ -0,0 +1,121 @@
+#include "programs.h"
+#include "vm/interpreter.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("interpreter", []() {
+    it("runs the collatz example", [&]() {
+      auto prog = compile_source(collatz_source);
+      buffered_io io({27});
+      interpreter vm(prog, io);
+
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output.size(), Equals(1));
+      AssertThat(io.output[0], Equals(111));
+    });
+
+    it("runs the prime example", [&]() {
+      auto prog = compile_source(prime_source);
+
+      std::vector<std::int64_t> inputs = {1, 2, 7, 9, 97, 100};
+      std::vector<std::int64_t> expected = {0, 1, 1, 0, 1, 0};
+
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        buffered_io io({inputs[i]});
+        interpreter vm(prog, io);
+
+        AssertThat(vm.run(), Equals(exit_reason::HALTED));
+        AssertThat(io.output.size(), Equals(1));
+        AssertThat(io.output[0], Equals(expected[i]));
+      }
+    });
+
+    it("runs programs from a reused parser and compiler", [&]() {
+      parser p("");
+      compiler c;
+
+      for (int round = 0; round < 2; ++round) {
+        p.reset(collatz_source);
+        auto collatz = c.compile(p.parse().ast);
+
+        p.reset(prime_source);
+        auto prime = c.compile(p.parse().ast);
+
+        AssertThat(collatz.code.size(),
+                   Equals(compile_source(collatz_source).code.size()));
+
+        buffered_io collatz_io({27});
+        interpreter collatz_vm(collatz, collatz_io);
+        AssertThat(collatz_vm.run(), Equals(exit_reason::HALTED));
+        AssertThat(collatz_io.output[0], Equals(111));
+
+        buffered_io prime_io({97});
+        interpreter prime_vm(prime, prime_io);
+        AssertThat(prime_vm.run(), Equals(exit_reason::HALTED));
+        AssertThat(prime_io.output[0], Equals(1));
+      }
+    });
+
+    it("stops when out of fuel and resumes", [&]() {
+      auto prog = compile_source(collatz_source);
+      buffered_io io({27});
+      interpreter vm(prog, io);
+
+      AssertThat(vm.run(10), Equals(exit_reason::OUT_OF_FUEL));
+      AssertThat(vm.get_state().executed, Equals(10));
+
+      while (vm.run(10) == exit_reason::OUT_OF_FUEL) {
+      }
+
+      AssertThat(io.output[0], Equals(111));
+    });
+
+    it("waits for input", [&]() {
+      auto prog = compile_source(collatz_source);
+      buffered_io io;
+      interpreter vm(prog, io);
+
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+      auto pc = vm.get_state().pc;
+      AssertThat(prog.code[pc].operation, Equals(op::INTERRUPT));
+
+      io.input.push_back(6);
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output[0], Equals(8));
+    });
+
+    it("wraps arithmetic around", [&]() {
+      program prog;
+      prog.data.resize(8);
+      prog.code.push_back(make_instruction(op::LOAD_I, INT64_MAX));
+      prog.code.push_back(make_instruction(op::ADD_I, 1));
+      prog.code.push_back(
+          make_instruction(op::INTERRUPT, code_of_syscall(sys_call::WRITE)));
+
+      buffered_io io;
+      interpreter vm(prog, io);
+      vm.run();
+
+      AssertThat(io.output[0], Equals(INT64_MIN));
+    });
+
+    it("fails on division by zero", [&]() {
+      auto prog = compile_source("int x = 0; int y = 10 / x;");
+      buffered_io io;
+      interpreter vm(prog, io);
+
+      AssertThrows(execution_error, vm.run());
+    });
+
+    it("rejects out of bounds addresses when loading", [&]() {
+      program prog;
+      prog.code.push_back(make_instruction(op::LOAD, default_memory_size));
+
+      buffered_io io;
+      AssertThrows(execution_error, interpreter(prog, io));
+    });
+  });
+});
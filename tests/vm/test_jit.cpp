@@ -0,0 +1,183 @@
+#include "programs.h"
+#include "vm/interpreter.h"
+#include "vm/jit.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("jit", []() {
+    it("runs the prime example many times from the same code", [&]() {
+      auto prog = compile_source(prime_source);
+      jit_program code(prog);
+
+      std::vector<std::int64_t> inputs = {1, 2, 7, 9, 97, 100};
+      std::vector<std::int64_t> expected = {0, 1, 1, 0, 1, 0};
+
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        buffered_io io({inputs[i]});
+        jit_interpreter vm(code, io);
+
+        AssertThat(vm.run(), Equals(exit_reason::HALTED));
+        AssertThat(io.output.size(), Equals(1));
+        AssertThat(io.output[0], Equals(expected[i]));
+      }
+    });
+
+    it("computes the same as the interpreter", [&]() {
+      std::vector<std::int64_t> values = {
+          0, 1, -1, 2, -7, 13, INT64_MAX, INT64_MIN, (std::int64_t)1 << 40};
+      std::vector<op> memory_ops = {
+          op::ADD, op::SUBTRACT, op::MULTIPLY, op::DIVIDE, op::REMAINDER,
+          op::OR,  op::AND,      op::XOR,      op::GT,     op::LT,
+          op::GTEQ, op::LTEQ,   op::EQUALS};
+      std::vector<op> immediate_ops = {
+          op::ADD_I,       op::SUBTRACT_I, op::MULTIPLY_I, op::DIVIDE_I,
+          op::REMAINDER_I, op::OR_I,       op::AND_I,      op::XOR_I};
+      std::vector<op> unary_ops = {op::NEGATE, op::INVERT, op::NOT,
+                                   op::F_ADD};
+
+      auto write = make_instruction(op::INTERRUPT,
+                                    code_of_syscall(sys_call::WRITE));
+      program prog;
+      prog.data.resize(8);
+
+      for (auto a : values) {
+        for (auto b : values) {
+          for (auto operation : memory_ops) {
+            if (b == 0 && (operation == op::DIVIDE ||
+                           operation == op::REMAINDER)) {
+              continue;
+            }
+
+            prog.code.push_back(make_instruction(op::LOAD_I, a));
+            prog.code.push_back(make_instruction(op::SET, 0));
+            prog.code.push_back(make_instruction(op::LOAD_I, b));
+            prog.code.push_back(make_instruction(operation, 0));
+            prog.code.push_back(write);
+          }
+
+          for (auto operation : immediate_ops) {
+            if (b == 0 && (operation == op::DIVIDE_I ||
+                           operation == op::REMAINDER_I)) {
+              continue;
+            }
+
+            prog.code.push_back(make_instruction(op::LOAD_I, a));
+            prog.code.push_back(make_instruction(operation, b));
+            prog.code.push_back(write);
+          }
+        }
+
+        for (auto operation : unary_ops) {
+          prog.code.push_back(make_instruction(op::LOAD_I, a));
+          prog.code.push_back(make_instruction(operation));
+          prog.code.push_back(write);
+        }
+      }
+
+      buffered_io io1;
+      interpreter reference(prog, io1);
+      reference.run();
+
+      jit_program code(prog);
+      buffered_io io2;
+      jit_interpreter vm(code, io2);
+      vm.run();
+
+      AssertThat(io2.output.size(), Equals(io1.output.size()));
+      AssertThat(io2.output == io1.output, IsTrue());
+    });
+
+    it("stops after exactly as much fuel as given", [&]() {
+      auto prog = compile_source(collatz_source);
+      jit_program code(prog);
+
+      buffered_io io1({27});
+      interpreter reference(prog, io1);
+
+      buffered_io io2({27});
+      jit_interpreter vm(code, io2);
+
+      for (std::uint64_t fuel = 1; fuel < 40; ++fuel) {
+        AssertThat(vm.run(fuel), Equals(reference.run(fuel)));
+        AssertThat(vm.get_state().pc, Equals(reference.get_state().pc));
+        AssertThat(vm.get_state().executed,
+                   Equals(reference.get_state().executed));
+      }
+
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io2.output[0], Equals(111));
+    });
+
+    it("counts the same instructions as the interpreter", [&]() {
+      auto prog = compile_source(collatz_source);
+      jit_program code(prog);
+
+      buffered_io io1({27});
+      interpreter reference(prog, io1);
+      reference.run();
+
+      buffered_io io2({27});
+      jit_interpreter vm(code, io2);
+      vm.run();
+
+      AssertThat(io2.output[0], Equals(io1.output[0]));
+      AssertThat(vm.get_state().executed,
+                 Equals(reference.get_state().executed));
+    });
+
+    it("waits for input", [&]() {
+      auto prog = compile_source(collatz_source);
+      jit_program code(prog);
+      buffered_io io;
+      jit_interpreter vm(code, io);
+
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+      auto pc = vm.get_state().pc;
+      AssertThat(prog.code[pc].operation, Equals(op::INTERRUPT));
+
+      io.input.push_back(6);
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output[0], Equals(8));
+    });
+
+    it("reports division by zero at the right line", [&]() {
+      auto prog = compile_source("int x = 0;\nint y = 10 / x;");
+      jit_program code(prog);
+      buffered_io io;
+      jit_interpreter vm(code, io);
+
+      std::string message;
+
+      try {
+        vm.run();
+      } catch (execution_error &e) {
+        message = e.what();
+      }
+
+      AssertThat(message, Equals(format_division_by_zero(
+                              prog, vm.get_state().pc)));
+      AssertThat(prog.metadata.source_line_map[vm.get_state().pc],
+                 Equals(2));
+    });
+
+    it("maps native code back to instructions", [&]() {
+      auto prog = compile_source(collatz_source);
+      jit_program code(prog);
+
+      if (code.native == nullptr) {
+        return;
+      }
+
+      for (std::uint64_t pc = 0; pc < prog.code.size(); ++pc) {
+        auto address = code.native + code.native_of_pc[pc];
+        auto found = code.pc_of_native(address);
+
+        // Instructions with no code of their own share it with the next
+        AssertThat(code.native_of_pc[found], Equals(code.native_of_pc[pc]));
+      }
+    });
+  });
+});
@@ -0,0 +1,104 @@
+#include "programs.h"
+#include "vm/lockstep.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+static void assert_same(const std::vector<run_result> &results,
+                        const std::vector<run_result> &expected) {
+  AssertThat(results.size(), Equals(expected.size()));
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    AssertThat(results[i].reason, Equals(expected[i].reason));
+    AssertThat(results[i].output == expected[i].output, IsTrue());
+    AssertThat(results[i].executed, Equals(expected[i].executed));
+    AssertThat(results[i].error.has_value(),
+               Equals(expected[i].error.has_value()));
+  }
+}
+
+go_bandit([]() {
+  describe("lockstep runner", []() {
+    it("runs the collatz example over many inputs", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 50; ++i) {
+        inputs.push_back({i});
+      }
+
+      lockstep_runner runner(prog);
+      assert_same(runner.run(inputs), run_each(prog, inputs));
+    });
+
+    it("runs the prime example over many inputs", [&]() {
+      auto prog = compile_source(prime_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 37; ++i) {
+        inputs.push_back({i * 7 + 1});
+      }
+
+      lockstep_runner runner(prog);
+      auto results = runner.run(inputs);
+      assert_same(results, run_each(prog, inputs));
+
+      AssertThat(results[0].output[0], Equals(0));
+      AssertThat(results[1].output[0], Equals(0));
+      AssertThat(results[2].output[0], Equals(0));
+      AssertThat(results[5].output[0], Equals(1));
+    });
+
+    it("uses bytes that aren't word aligned", [&]() {
+      auto prog = compile_source("\
+char c;\n\
+boolean b;\n\
+int i;\n\
+read i;\n\
+b = i > 3;\n\
+c = 'a';\n\
+write i;\n\
+write b;\n\
+");
+
+      std::vector<std::vector<std::int64_t>> inputs = {{1}, {5}, {-3}, {9}};
+      lockstep_runner runner(prog);
+      assert_same(runner.run(inputs), run_each(prog, inputs));
+    });
+
+    it("stops instances separately", [&]() {
+      auto prog = compile_source("\
+int x;\n\
+read x;\n\
+write 100 / x;\n\
+read x;\n\
+write x;\n\
+");
+
+      std::vector<std::vector<std::int64_t>> inputs = {
+          {5, 1}, {0, 1}, {4}, {-1, 7}};
+      lockstep_runner runner(prog);
+      auto results = runner.run(inputs);
+      assert_same(results, run_each(prog, inputs));
+
+      AssertThat(results[1].error.has_value(), IsTrue());
+      AssertThat(results[2].reason, Equals(exit_reason::WAITING_FOR_INPUT));
+    });
+
+    it("stops after exactly as much fuel as given", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 9; ++i) {
+        inputs.push_back({i});
+      }
+
+      lockstep_runner runner(prog);
+
+      for (std::uint64_t fuel : {1, 7, 30, 100}) {
+        assert_same(runner.run(inputs, fuel), run_each(prog, inputs, fuel));
+      }
+    });
+  });
+});
@@ -0,0 +1,111 @@
+#include "programs.h"
+#include "vm/parallel.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("work stealing pool", []() {
+    it("runs every task", [&]() {
+      work_stealing_pool pool(4);
+      std::atomic<int> sum = 0;
+
+      for (int i = 1; i <= 1000; ++i) {
+        pool.submit([&sum, i]() { sum += i; });
+      }
+
+      pool.wait();
+      AssertThat(sum.load(), Equals(500500));
+    });
+
+    it("runs tasks submitted by other tasks", [&]() {
+      work_stealing_pool pool(3);
+      std::atomic<int> count = 0;
+
+      for (int i = 0; i < 10; ++i) {
+        pool.submit([&]() {
+          for (int j = 0; j < 10; ++j) {
+            pool.submit([&]() { ++count; });
+          }
+        });
+      }
+
+      pool.wait();
+      AssertThat(count.load(), Equals(100));
+    });
+
+    it("runs on the waiting thread if it has no threads", [&]() {
+      work_stealing_pool pool(0);
+      int count = 0;
+
+      for (int i = 0; i < 10; ++i) {
+        pool.submit([&]() { ++count; });
+      }
+
+      pool.wait();
+      AssertThat(count, Equals(10));
+    });
+  });
+
+  describe("parallel runner", []() {
+    auto assert_same = [](const std::vector<timed_run_result> &results,
+                          const std::vector<run_result> &expected) {
+      AssertThat(results.size(), Equals(expected.size()));
+
+      for (size_t i = 0; i < results.size(); ++i) {
+        AssertThat(results[i].reason, Equals(expected[i].reason));
+        AssertThat(results[i].output == expected[i].output, IsTrue());
+        AssertThat(results[i].executed, Equals(expected[i].executed));
+        AssertThat(results[i].error.has_value(),
+                   Equals(expected[i].error.has_value()));
+      }
+    };
+
+    it("runs the collatz example over many inputs", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 200; ++i) {
+        inputs.push_back({i});
+      }
+
+      parallel_runner runner(prog, default_memory_size, 4);
+      assert_same(runner.run(inputs), run_each(prog, inputs));
+    });
+
+    it("keeps runs apart", [&]() {
+      auto prog = compile_source("\
+int x;\n\
+read x;\n\
+write 100 / x;\n\
+read x;\n\
+write x;\n\
+");
+
+      std::vector<std::vector<std::int64_t>> inputs = {
+          {5, 1}, {0, 1}, {4}, {-1, 7}};
+      parallel_runner runner(prog, default_memory_size, 2);
+      auto results = runner.run(inputs);
+      assert_same(results, run_each(prog, inputs));
+
+      AssertThat(results[1].error.has_value(), IsTrue());
+      AssertThat(results[2].reason, Equals(exit_reason::WAITING_FOR_INPUT));
+    });
+
+    it("stops each run after as much fuel as given", [&]() {
+      auto prog = compile_source(prime_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 20; ++i) {
+        inputs.push_back({i * 13});
+      }
+
+      parallel_runner runner(prog, default_memory_size, 3);
+
+      for (std::uint64_t fuel : {1, 20, 150}) {
+        assert_same(runner.run(inputs, fuel), run_each(prog, inputs, fuel));
+      }
+    });
+  });
+});
@@ -0,0 +1,97 @@
+#include "programs.h"
+#include "vm/profiler.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("profiler", []() {
+    it("counts every instruction run", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      buffered_io io({27});
+      profiling_interpreter vm(prog, io);
+      vm.run();
+
+      auto &prof = vm.get_profile();
+      AssertThat(prof.total(), Equals(vm.get_state().executed));
+
+      // Everything before the loop runs once
+      AssertThat(prof.counts[0], Equals(1u));
+
+      buffered_io plain_io({27});
+      interpreter plain(prog, plain_io);
+      plain.run();
+      AssertThat(plain_io.output == io.output, IsTrue());
+    });
+
+    it("keeps counting when resumed", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      buffered_io io({27});
+      profiling_interpreter vm(prog, io);
+
+      while (vm.run(13) == exit_reason::OUT_OF_FUEL) {
+      }
+
+      AssertThat(vm.get_profile().total(), Equals(vm.get_state().executed));
+    });
+
+    it("doesn't count instructions that didn't run", [&]() {
+      auto prog = compile_source("\
+int x;\n\
+read x;\n\
+write 10 / x;\n\
+read x;\n\
+");
+
+      buffered_io io({5});
+      profiling_interpreter vm(prog, io);
+
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+      AssertThat(vm.get_profile().total(), Equals(vm.get_state().executed));
+
+      vm.reset();
+      vm.get_profile().clear();
+      io.input = {0};
+
+      AssertThrows(execution_error, vm.run());
+      AssertThat(vm.get_profile().total(), Equals(vm.get_state().executed));
+    });
+
+    it("finds the hottest line and statement", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      buffered_io io({27});
+      profiling_interpreter vm(prog, io);
+      vm.run();
+
+      auto &prof = vm.get_profile();
+      auto lines = prof.by_line();
+      auto statements = prof.by_statement();
+
+      std::uint64_t line_total = 0;
+      for (auto &line : lines) {
+        line_total += line.executed;
+      }
+
+      std::uint64_t statement_total = 0;
+      for (auto &statement : statements) {
+        statement_total += statement.executed;
+      }
+
+      AssertThat(line_total, Equals(prof.total()));
+      AssertThat(statement_total, Equals(prof.total()));
+
+      // The loop
+      AssertThat(lines[0].line, IsGreaterThanOrEqualTo(6u));
+      AssertThat(lines[0].line, IsLessThanOrEqualTo(13u));
+      AssertThat(lines[0].executed, IsGreaterThan(lines.back().executed));
+
+      AssertThat(statements[0].line, IsGreaterThanOrEqualTo(6u));
+      AssertThat(statements[0].line, IsLessThanOrEqualTo(13u));
+      AssertThat(statements[0].entered, IsGreaterThan(1u));
+    });
+  });
+});
@@ -0,0 +1,113 @@
+#include "programs.h"
+#include "vm/scheduler.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+const std::string forever_source = "\
+int a = 0;\n\
+while (a == 0) {\n\
+  a = 0;\n\
+}\n\
+";
+
+go_bandit([]() {
+  describe("scheduler", []() {
+    it("gives the same results as running each alone", [&]() {
+      auto collatz = compile_source(collatz_source);
+      auto prime = compile_source(prime_source);
+
+      std::vector<std::vector<std::int64_t>> inputs;
+      for (std::int64_t i = 1; i <= 40; ++i) {
+        inputs.push_back({i * 11});
+      }
+
+      auto expected_collatz = run_each(collatz, inputs);
+      auto expected_prime = run_each(prime, inputs);
+
+      scheduler s(7, unlimited_fuel, 3);
+      for (auto &input : inputs) {
+        s.add(collatz, input);
+        s.add(prime, input);
+      }
+
+      s.run();
+
+      std::uint64_t total = 0;
+
+      for (std::size_t i = 0; i < inputs.size(); ++i) {
+        auto &a = s.result(i * 2);
+        auto &b = s.result(i * 2 + 1);
+
+        AssertThat(a.reason, Equals(exit_reason::HALTED));
+        AssertThat(a.output == expected_collatz[i].output, IsTrue());
+        AssertThat(a.executed, Equals(expected_collatz[i].executed));
+        AssertThat(a.slices, Equals((a.executed + 6) / 7));
+
+        AssertThat(b.output == expected_prime[i].output, IsTrue());
+        AssertThat(b.executed, Equals(expected_prime[i].executed));
+
+        total += a.executed + b.executed;
+      }
+
+      AssertThat(s.total_executed(), Equals(total));
+    });
+
+    it("preempts instances that don't stop", [&]() {
+      auto forever = compile_source(forever_source);
+      auto collatz = compile_source(collatz_source);
+
+      scheduler s(50, unlimited_fuel, 1);
+      auto looping = s.add(forever, {}, 10000);
+      auto stopping = s.add(collatz, {27});
+      s.run();
+
+      AssertThat(s.result(looping).reason, Equals(exit_reason::OUT_OF_FUEL));
+      AssertThat(s.result(looping).executed, Equals(10000u));
+      AssertThat(s.result(looping).slices, Equals(200u));
+
+      AssertThat(s.result(stopping).reason, Equals(exit_reason::HALTED));
+      AssertThat(s.result(stopping).output[0], Equals(111));
+    });
+
+    it("stops everything after the total fuel", [&]() {
+      auto forever = compile_source(forever_source);
+
+      scheduler s(64, 5000, 4);
+      for (int i = 0; i < 10; ++i) {
+        s.add(forever, {});
+      }
+
+      s.run();
+
+      std::uint64_t total = 0;
+      for (std::size_t i = 0; i < s.size(); ++i) {
+        AssertThat(s.result(i).reason, Equals(exit_reason::OUT_OF_FUEL));
+        total += s.result(i).executed;
+      }
+
+      AssertThat(total, Equals(5000u));
+      AssertThat(s.total_executed(), Equals(5000u));
+    });
+
+    it("keeps errors to their instance", [&]() {
+      auto prog = compile_source("\
+int x;\n\
+read x;\n\
+write 10 / x;\n\
+");
+
+      scheduler s(2, unlimited_fuel, 2);
+      s.add(prog, {0});
+      s.add(prog, {5});
+      s.add(prog, {});
+      s.run();
+
+      AssertThat(s.result(0).error.has_value(), IsTrue());
+      AssertThat(s.result(1).error.has_value(), IsFalse());
+      AssertThat(s.result(1).output[0], Equals(2));
+      AssertThat(s.result(2).reason, Equals(exit_reason::WAITING_FOR_INPUT));
+    });
+  });
+});
@@ -0,0 +1,124 @@
+#include "programs.h"
+#include "vm/interpreter.h"
+#include "vm/threaded.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+go_bandit([]() {
+  describe("threaded interpreter", []() {
+    it("runs the prime example many times from the same code", [&]() {
+      auto prog = compile_source(prime_source);
+      threaded_program code(prog);
+
+      std::vector<std::int64_t> inputs = {1, 2, 7, 9, 97, 100};
+      std::vector<std::int64_t> expected = {0, 1, 1, 0, 1, 0};
+
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        buffered_io io({inputs[i]});
+        threaded_interpreter vm(code, io);
+
+        AssertThat(vm.run(), Equals(exit_reason::HALTED));
+        AssertThat(io.output.size(), Equals(1));
+        AssertThat(io.output[0], Equals(expected[i]));
+      }
+    });
+
+    it("splits the code in basic blocks", [&]() {
+      auto prog = compile_source(collatz_source);
+      threaded_program code(prog);
+
+      AssertThat(code.blocks.is_start(0), IsTrue());
+
+      for (std::uint64_t pc = 0; pc < prog.code.size(); ++pc) {
+        auto operation = prog.code[pc].operation;
+
+        if (operation == op::JUMP || operation == op::BRANCH_IF_ZERO ||
+            operation == op::BRANCH_IF_NOT_ZERO) {
+          AssertThat(code.blocks.end(pc), Equals(pc + 1));
+        }
+      }
+    });
+
+    it("counts the same instructions as the interpreter", [&]() {
+      auto prog = compile_source(collatz_source);
+      threaded_program code(prog);
+
+      buffered_io io1({27});
+      interpreter reference(prog, io1);
+      reference.run();
+
+      buffered_io io2({27});
+      threaded_interpreter vm(code, io2);
+      vm.run();
+
+      AssertThat(io2.output[0], Equals(io1.output[0]));
+      AssertThat(vm.get_state().executed,
+                 Equals(reference.get_state().executed));
+      AssertThat(vm.get_state().x, Equals(reference.get_state().x));
+    });
+
+    it("stops after exactly as much fuel as given", [&]() {
+      auto prog = compile_source(collatz_source);
+      threaded_program code(prog);
+
+      buffered_io io1({27});
+      interpreter reference(prog, io1);
+
+      buffered_io io2({27});
+      threaded_interpreter vm(code, io2);
+
+      // Every amount up to a few blocks, so that it stops in the middle of
+      // them too
+      for (std::uint64_t fuel = 1; fuel < 40; ++fuel) {
+        AssertThat(vm.run(fuel), Equals(reference.run(fuel)));
+        AssertThat(vm.get_state().pc, Equals(reference.get_state().pc));
+        AssertThat(vm.get_state().executed,
+                   Equals(reference.get_state().executed));
+      }
+
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io2.output[0], Equals(111));
+    });
+
+    it("waits for input", [&]() {
+      auto prog = compile_source(collatz_source);
+      threaded_program code(prog);
+      buffered_io io;
+      threaded_interpreter vm(code, io);
+
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+      auto pc = vm.get_state().pc;
+      AssertThat(prog.code[pc].operation, Equals(op::INTERRUPT));
+
+      io.input.push_back(6);
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output[0], Equals(8));
+    });
+
+    it("replaces float operations", [&]() {
+      program prog;
+      prog.data.resize(8);
+      prog.code.push_back(make_instruction(op::F_ADD_I, 1));
+      prog.code.push_back(
+          make_instruction(op::INTERRUPT, code_of_syscall(sys_call::WRITE)));
+
+      threaded_program code(prog);
+      buffered_io io;
+      threaded_interpreter vm(code, io);
+      vm.run();
+
+      AssertThat(io.output[0], Equals(0xBAD));
+    });
+
+    it("fails on division by zero", [&]() {
+      auto prog = compile_source("int x = 0; int y = 10 / x;");
+      threaded_program code(prog);
+      buffered_io io;
+      threaded_interpreter vm(code, io);
+
+      AssertThrows(execution_error, vm.run());
+    });
+  });
+});
@@ -0,0 +1,147 @@
+#include "programs.h"
+#include "vm/time_travel.h"
+#include <bandit/bandit.h>
+
+using namespace snowhouse;
+using namespace bandit;
+
+const std::string sum_source = "\
+int n;\n\
+int sum = 0;\n\
+read n;\n\
+\n\
+while (n != 0) {\n\
+  sum += n;\n\
+  read n;\n\
+}\n\
+\n\
+write sum;\n\
+";
+
+// Where the plain interpreter is after `fuel` instructions
+static machine_state state_after(const program &prog,
+                                 std::vector<std::int64_t> input,
+                                 std::uint64_t fuel) {
+  buffered_io io(input);
+  interpreter vm(prog, io);
+  vm.run(fuel);
+  return vm.get_state();
+}
+
+static void assert_same_state(machine_state &state,
+                              const machine_state &expected) {
+  AssertThat(state.executed, Equals(expected.executed));
+  AssertThat(state.pc, Equals(expected.pc));
+  AssertThat(state.x, Equals(expected.x));
+  AssertThat(state.memory == expected.memory, IsTrue());
+}
+
+go_bandit([]() {
+  describe("time travel interpreter", []() {
+    it("goes back to the same state as running less", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      buffered_io io({27});
+      time_travel_interpreter vm(prog, io, 16);
+      vm.run();
+
+      auto end = vm.get_state().executed;
+
+      for (std::uint64_t back : {1, 5, 16, 17, 100, 1000}) {
+        vm.run();
+        vm.step_back(back);
+        assert_same_state(vm.get_state(),
+                          state_after(prog, {27}, end - back));
+      }
+
+      vm.step_back(end * 2);
+      assert_same_state(vm.get_state(), state_after(prog, {27}, 0));
+    });
+
+    it("only keeps a checkpoint every so often", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      buffered_io io({27});
+      time_travel_interpreter vm(prog, io, 64);
+      vm.run();
+
+      auto executed = vm.get_state().executed;
+      AssertThat(vm.checkpoint_count(), Equals(executed / 64 + 1));
+    });
+
+    it("replays input and doesn't repeat output", [&]() {
+      auto prog = compile_source(sum_source);
+
+      buffered_io io({3, 4, 5, 0});
+      time_travel_interpreter vm(prog, io, 8);
+
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output.size(), Equals(1u));
+      AssertThat(io.output[0], Equals(12));
+
+      vm.step_back(vm.get_state().executed);
+
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output.size(), Equals(1u));
+      AssertThat(vm.get_state().executed,
+                 Equals(state_after(prog, {3, 4, 5, 0}, unlimited_fuel)
+                            .executed));
+    });
+
+    it("asks for more input after the recorded one", [&]() {
+      auto prog = compile_source(sum_source);
+
+      buffered_io io({3, 4});
+      time_travel_interpreter vm(prog, io, 4);
+
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+
+      vm.step_back(3);
+      AssertThat(vm.run(), Equals(exit_reason::WAITING_FOR_INPUT));
+
+      io.input = {10, 0};
+      AssertThat(vm.run(), Equals(exit_reason::HALTED));
+      AssertThat(io.output.size(), Equals(1u));
+      AssertThat(io.output[0], Equals(17));
+    });
+
+    it("goes back one statement at a time", [&]() {
+      auto prog = compile_source(collatz_source);
+
+      std::vector<bool> is_start(prog.code.size(), false);
+      for (auto pc : prog.metadata.statement_boundaries) {
+        if (pc < is_start.size()) {
+          is_start[pc] = true;
+        }
+      }
+
+      buffered_io io({6});
+      time_travel_interpreter vm(prog, io, 8);
+      vm.run();
+
+      // Every point where a statement started, from the interpreter
+      std::vector<std::uint64_t> starts;
+      {
+        buffered_io io({6});
+        interpreter reference(prog, io);
+
+        while (reference.get_state().pc < prog.code.size()) {
+          if (is_start[reference.get_state().pc]) {
+            starts.push_back(reference.get_state().executed);
+          }
+          reference.run(1);
+        }
+      }
+
+      AssertThat(starts.size(), IsGreaterThan(10u));
+
+      for (auto it = starts.rbegin(); it != starts.rend(); ++it) {
+        vm.step_back_statement();
+        AssertThat(vm.get_state().executed, Equals(*it));
+      }
+
+      vm.step_back_statement();
+      AssertThat(vm.get_state().executed, Equals(0u));
+    });
+  });
+});
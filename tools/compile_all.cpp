@@ -0,0 +1,41 @@
+#include "driver/batch.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Compiles every file in a directory, such as a semester of submissions, and
+// says which ones failed and why:
+//
+//   compile_all <directory> [threads]
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " <directory> [threads]\n";
+    return 2;
+  }
+
+  auto threads = argc == 3 ? std::stoul(argv[2]) : default_thread_count();
+  batch_compiler batch(threads);
+
+  auto start = std::chrono::steady_clock::now();
+  auto paths = files_in(argv[1]);
+  auto results = batch.compile_files(paths);
+  auto end = std::chrono::steady_clock::now();
+
+  std::size_t failed = 0;
+
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    if (results[i].success) {
+      std::cout << paths[i] << ": " << results[i].prog.code.size()
+                << " instructions\n";
+    } else {
+      failed++;
+      std::cout << paths[i] << ": " << results[i].message << '\n';
+    }
+  }
+
+  auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cerr << results.size() << " files, " << failed << " failed, in " << ms
+            << " ms on " << batch.thread_count() << " threads\n";
+
+  return failed == 0 ? 0 : 1;
+}
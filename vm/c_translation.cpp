@@ -0,0 +1,293 @@
+#include "vm/c_translation.h"
+#include <algorithm>
+#include <sstream>
+
+// Everything the translated instructions need. `memory` and `MEMORY_SIZE` are
+// declared before this
+static const char *const prelude = R"(
+static inline int64_t load(uint64_t address) {
+  int64_t value;
+  memcpy(&value, memory + address, sizeof(value));
+  return value;
+}
+
+static inline void store(uint64_t address, int64_t value) {
+  memcpy(memory + address, &value, sizeof(value));
+}
+
+/* Arithmetic wraps around, which signed overflow doesn't do by itself */
+#define ADD(a, b) ((int64_t)((uint64_t)(a) + (uint64_t)(b)))
+#define SUBTRACT(a, b) ((int64_t)((uint64_t)(a) - (uint64_t)(b)))
+#define MULTIPLY(a, b) ((int64_t)((uint64_t)(a) * (uint64_t)(b)))
+
+static inline int64_t divide(int64_t a, int64_t b) {
+  return b == -1 ? SUBTRACT(0, a) : a / b;
+}
+
+static inline int64_t remainder_of(int64_t a, int64_t b) {
+  return b == -1 ? 0 : a % b;
+}
+
+static inline void fail(const char *message) {
+  fflush(stdout);
+  fprintf(stderr, "%s\n", message);
+  exit(1);
+}
+
+static inline void read_input(int64_t address, unsigned long long pc) {
+  long long value;
+
+  if (scanf("%lld", &value) != 1) {
+    fflush(stdout);
+    fprintf(stderr, "Out of input.\n");
+    exit(2);
+  }
+
+  if ((uint64_t)address > MEMORY_SIZE - sizeof(int64_t)) {
+    fflush(stdout);
+    fprintf(stderr, "Address %llu out of bounds at instruction %llu.\n",
+            (unsigned long long)address, pc);
+    exit(1);
+  }
+
+  store(address, value);
+}
+
+static inline void write_output(int64_t value) {
+  printf("%lld\n", (long long)value);
+}
+)";
+
+// As a C string literal
+static std::string quote(const std::string &text) {
+  std::string result = "\"";
+
+  for (auto c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+
+  return result + "\"";
+}
+
+static std::string label(std::uint64_t pc, std::uint64_t size) {
+  return pc >= size ? "end" : "i" + std::to_string(pc);
+}
+
+// Operands are written as unsigned so that INT64_MIN doesn't need special
+// care, then cast back
+static std::string immediate(std::uint64_t operand) {
+  return "(int64_t)" + std::to_string(operand) + "ULL";
+}
+
+static std::string memory_operand(std::uint64_t address) {
+  return "load(" + std::to_string(address) + ")";
+}
+
+static void translate_instruction(std::ostream &o, const program &prog,
+                                  std::uint64_t pc) {
+  auto &instruction = prog.code[pc];
+  auto size = prog.code.size();
+  auto operand = instruction.operands[0];
+  auto m = memory_operand(operand);
+  auto i = immediate(operand);
+
+  auto division_check = [&](const std::string &divisor) {
+    o << "if (" << divisor << " == 0) fail("
+      << quote(format_division_by_zero(prog, pc)) << "); ";
+  };
+
+  switch (instruction.operation) {
+  // Not supported at the moment, same as in the editor
+  case op::NOOP:
+  case op::LOAD_BP:
+  case op::PUSH:
+  case op::POP:
+  case op::CALL:
+  case op::RET:
+    o << ";";
+    break;
+
+  case op::LOAD:
+    o << "x = " << m << ";";
+    break;
+  case op::SET:
+    o << "store(" << operand << ", x);";
+    break;
+  case op::LOAD_I:
+    o << "x = " << i << ";";
+    break;
+
+  case op::NEGATE:
+    o << "x = SUBTRACT(0, x);";
+    break;
+  case op::ADD:
+    o << "x = ADD(" << m << ", x);";
+    break;
+  case op::SUBTRACT:
+    o << "x = SUBTRACT(" << m << ", x);";
+    break;
+  case op::MULTIPLY:
+    o << "x = MULTIPLY(" << m << ", x);";
+    break;
+  case op::DIVIDE:
+    division_check("x");
+    o << "x = divide(" << m << ", x);";
+    break;
+  case op::REMAINDER:
+    division_check("x");
+    o << "x = remainder_of(" << m << ", x);";
+    break;
+
+  case op::ADD_I:
+    o << "x = ADD(x, " << i << ");";
+    break;
+  case op::SUBTRACT_I:
+    o << "x = SUBTRACT(x, " << i << ");";
+    break;
+  case op::MULTIPLY_I:
+    o << "x = MULTIPLY(x, " << i << ");";
+    break;
+  case op::DIVIDE_I:
+    division_check(i);
+    o << "x = divide(x, " << i << ");";
+    break;
+  case op::REMAINDER_I:
+    division_check(i);
+    o << "x = remainder_of(x, " << i << ");";
+    break;
+
+  // Not supported at the moment, same as in the editor
+  case op::F_NEGATE:
+  case op::F_ADD:
+  case op::F_SUBTRACT:
+  case op::F_MULTIPLY:
+  case op::F_DIVIDE:
+  case op::F_ADD_I:
+  case op::F_SUBTRACT_I:
+  case op::F_MULTIPLY_I:
+  case op::F_DIVIDE_I:
+    o << "x = 0xBAD;";
+    break;
+
+  case op::OR:
+    o << "x = " << m << " | x;";
+    break;
+  case op::AND:
+    o << "x = " << m << " & x;";
+    break;
+  case op::XOR:
+    o << "x = " << m << " ^ x;";
+    break;
+  case op::INVERT:
+    o << "x = ~x;";
+    break;
+
+  case op::GT:
+    o << "x = " << m << " > x;";
+    break;
+  case op::LT:
+    o << "x = " << m << " < x;";
+    break;
+  case op::GTEQ:
+    o << "x = " << m << " >= x;";
+    break;
+  case op::LTEQ:
+    o << "x = " << m << " <= x;";
+    break;
+  case op::EQUALS:
+    o << "x = " << m << " == x;";
+    break;
+  case op::NOT:
+    o << "x = x == 0;";
+    break;
+
+  case op::OR_I:
+    o << "x = x | " << i << ";";
+    break;
+  case op::AND_I:
+    o << "x = x & " << i << ";";
+    break;
+  case op::XOR_I:
+    o << "x = x ^ " << i << ";";
+    break;
+
+  case op::JUMP:
+    o << "goto " << label(operand, size) << ";";
+    break;
+  case op::BRANCH_IF_ZERO:
+    o << "if (x == 0) goto " << label(operand, size) << ";";
+    break;
+  case op::BRANCH_IF_NOT_ZERO:
+    o << "if (x != 0) goto " << label(operand, size) << ";";
+    break;
+
+  case op::INTERRUPT:
+    if (operand == code_of_syscall(sys_call::READ)) {
+      o << "read_input(x, " << pc << ");";
+    } else if (operand == code_of_syscall(sys_call::WRITE)) {
+      o << "write_output(x);";
+    } else {
+      o << ";";
+    }
+    break;
+  }
+}
+
+std::string translate_to_c(const program &prog, std::uint64_t memory_size) {
+  auto size = std::max<std::uint64_t>(memory_size,
+                                      prog.data.size() + sizeof(std::int64_t));
+  check_addresses(prog, size);
+
+  std::ostringstream o;
+
+  o << "/* Translated by tokiwen */\n"
+    << "#include <stdint.h>\n"
+    << "#include <stdio.h>\n"
+    << "#include <stdlib.h>\n"
+    << "#include <string.h>\n"
+    << "\n"
+    << "#define MEMORY_SIZE " << size << "ULL\n"
+    << "\n"
+    << "static uint8_t memory[MEMORY_SIZE] = {";
+
+  // C doesn't allow empty initializers
+  if (prog.data.empty()) {
+    o << "0";
+  }
+
+  for (size_t i = 0; i < prog.data.size(); ++i) {
+    o << (i == 0 ? "" : ",") << (i % 16 == 0 ? "\n  " : " ")
+      << (unsigned)prog.data[i];
+  }
+
+  o << "\n};\n" << prelude << "\n";
+
+  // Labels that are never jumped to are expected
+  o << "#pragma GCC diagnostic ignored \"-Wunused-label\"\n"
+    << "\n"
+    << "int main(void) {\n"
+    << "  int64_t x = 0;\n"
+    << "\n";
+
+  auto &lines = prog.metadata.source_line_map;
+
+  for (std::uint64_t pc = 0; pc < prog.code.size(); ++pc) {
+    o << label(pc, prog.code.size()) << ": ";
+    translate_instruction(o, prog, pc);
+
+    o << " /* " << prog.code[pc];
+    if (pc < lines.size()) {
+      o << ", line " << lines[pc];
+    }
+    o << " */\n";
+  }
+
+  o << "end:\n"
+    << "  return 0;\n"
+    << "}\n";
+
+  return o.str();
+}
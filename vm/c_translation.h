@@ -0,0 +1,19 @@
+#ifndef C_TRANSLATION_H
+#define C_TRANSLATION_H
+
+#include "synthesis/program.h"
+#include "vm/machine.h"
+#include <string>
+
+// Translates `prog` into a standalone C program so that the host compiler can
+// optimize it as a whole. Each instruction gets a label and jumps become
+// gotos.
+//
+// The result reads one integer from stdin for each READ and prints one line
+// to stdout for each WRITE, the same as the interpreter would output. Errors
+// are printed to stderr with the same messages and exit with status 1. Running
+// out of input exits with status 2.
+std::string translate_to_c(const program &prog,
+                           std::uint64_t memory_size = default_memory_size);
+
+#endif /* C_TRANSLATION_H */
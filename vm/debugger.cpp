@@ -0,0 +1,68 @@
+#include "vm/debugger.h"
+#include "vm/interpreter.h"
+
+debugger::debugger(const program &prog, std::uint64_t memory_size)
+    : prog(prog), state(prog, memory_size) {
+  check_addresses(prog, this->state.memory.size());
+
+  auto size = prog.code.size();
+  this->breakpoints.resize(size, 0);
+  this->statement_starts.resize(size, 0);
+
+  for (auto pc : prog.metadata.statement_boundaries) {
+    if (pc < size) {
+      this->statement_starts[pc] = 1;
+    }
+  }
+}
+
+void debugger::reset() {
+  this->state.load(this->prog);
+  this->io.input.clear();
+  this->io.output.clear();
+}
+
+exit_reason debugger::run_until(const std::vector<std::uint64_t> &breakpoints,
+                                std::uint64_t max_instructions) {
+  auto size = this->prog.code.size();
+
+  for (auto pc : breakpoints) {
+    if (pc < size) {
+      this->breakpoints[pc] = 1;
+    }
+  }
+
+  // Cleared even if it fails, for the next call
+  struct clear_breakpoints {
+    std::vector<std::uint8_t> &mask;
+    const std::vector<std::uint64_t> &pcs;
+
+    ~clear_breakpoints() {
+      for (auto pc : this->pcs) {
+        if (pc < this->mask.size()) {
+          this->mask[pc] = 0;
+        }
+      }
+    }
+  } clear{this->breakpoints, breakpoints};
+
+  return execute_until(this->prog, this->state, this->io, max_instructions,
+                       this->breakpoints.data());
+}
+
+exit_reason debugger::run_one_statement(std::uint64_t max_instructions) {
+  return execute_until(this->prog, this->state, this->io, max_instructions,
+                       this->statement_starts.data());
+}
+
+void debugger::give_input(std::int64_t value) {
+  this->io.input.push_back(value);
+}
+
+std::vector<std::int64_t> debugger::take_output() {
+  std::vector<std::int64_t> output;
+  std::swap(output, this->io.output);
+  return output;
+}
+
+machine_state &debugger::get_state() { return this->state; }
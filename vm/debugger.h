@@ -0,0 +1,44 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+// Runs a program for the editor in as few calls as possible: each one goes on
+// until a breakpoint, the start of a statement, a READ without input or the
+// end of its budget, and then the editor looks at the state once.
+class debugger {
+private:
+  const program &prog;
+  machine_state state;
+  buffered_io io;
+
+  // By pc. Breakpoints are only set during `run_until`
+  std::vector<std::uint8_t> breakpoints;
+  std::vector<std::uint8_t> statement_starts;
+
+public:
+  debugger(const program &prog,
+           std::uint64_t memory_size = default_memory_size);
+
+  // Back to the state right after loading, without any input or output
+  void reset();
+
+  // Stops with `BREAKPOINT` when about to run any of `breakpoints`. Throws
+  // `execution_error` if the program does something illegal
+  exit_reason run_until(const std::vector<std::uint64_t> &breakpoints,
+                        std::uint64_t max_instructions = unlimited_fuel);
+
+  // Stops with `BREAKPOINT` when about to start the next statement
+  exit_reason run_one_statement(std::uint64_t max_instructions = unlimited_fuel);
+
+  // For READ
+  void give_input(std::int64_t value);
+  // Whatever WRITE output since the last call
+  std::vector<std::int64_t> take_output();
+
+  machine_state &get_state();
+};
+
+#endif /* DEBUGGER_H */
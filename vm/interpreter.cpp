@@ -0,0 +1,289 @@
+#include "vm/interpreter.h"
+
+interpreter::interpreter(const program &prog, io_device &io,
+                         std::uint64_t memory_size)
+    : prog(prog), io(io), state(prog, memory_size) {
+  check_addresses(prog, this->state.memory.size());
+}
+
+void interpreter::reset() { this->state.load(this->prog); }
+
+machine_state &interpreter::get_state() { return this->state; }
+
+exit_reason interpreter::run(std::uint64_t fuel) {
+  return execute(this->prog, this->state, this->io, fuel);
+}
+
+// Every handler ends by jumping straight into the next one, so there is no
+// central `switch` for the branch predictor to choke on. When `profiling`, it
+// also counts each instruction in `counts`, and when `breaking` it stops
+// before any instruction marked in `stops`. Running without them costs
+// nothing extra
+template <bool profiling, bool breaking>
+static exit_reason run_program(const program &prog, machine_state &state,
+                               io_device &io, std::uint64_t fuel,
+                               std::uint64_t *counts,
+                               const std::uint8_t *stops) {
+#define X(Opcode, Enum, Operands) &&op_##Enum,
+  static void *const dispatch_table[] = {OPERATIONS};
+#undef X
+
+  const auto *code = prog.code.data();
+  const std::uint64_t code_size = prog.code.size();
+  auto *memory = state.memory.data();
+  const std::uint64_t memory_size = state.memory.size();
+
+  std::uint64_t pc = state.pc;
+  std::int64_t x = state.x;
+  std::uint64_t remaining = fuel;
+  exit_reason reason;
+
+#define DISPATCH()                                                             \
+  do {                                                                         \
+    if (pc >= code_size) {                                                     \
+      reason = exit_reason::HALTED;                                            \
+      goto stop;                                                               \
+    }                                                                          \
+    if constexpr (breaking) {                                                  \
+      if (stops[pc]) {                                                         \
+        reason = exit_reason::BREAKPOINT;                                      \
+        goto stop;                                                             \
+      }                                                                        \
+    }                                                                          \
+    if (remaining == 0) {                                                      \
+      reason = exit_reason::OUT_OF_FUEL;                                       \
+      goto stop;                                                               \
+    }                                                                          \
+    --remaining;                                                               \
+    if constexpr (profiling) {                                                 \
+      ++counts[pc];                                                            \
+    }                                                                          \
+    goto *dispatch_table[(size_t)code[pc].operation];                          \
+  } while (0)
+
+#define NEXT()                                                                 \
+  ++pc;                                                                        \
+  DISPATCH()
+
+#define OPERAND ((std::int64_t)code[pc].operands[0])
+#define MEMORY_OPERAND read_memory(memory, code[pc].operands[0])
+
+  DISPATCH();
+
+  // Not supported at the moment, same as in the editor
+op_NOOP:
+op_LOAD_BP:
+op_PUSH:
+op_POP:
+op_CALL:
+op_RET:
+  NEXT();
+
+op_LOAD:
+  x = MEMORY_OPERAND;
+  NEXT();
+op_SET:
+  write_memory(memory, code[pc].operands[0], x);
+  NEXT();
+op_LOAD_I:
+  x = OPERAND;
+  NEXT();
+
+op_NEGATE:
+  x = wrapping_subtract(0, x);
+  NEXT();
+op_ADD:
+  x = wrapping_add(MEMORY_OPERAND, x);
+  NEXT();
+op_SUBTRACT:
+  x = wrapping_subtract(MEMORY_OPERAND, x);
+  NEXT();
+op_MULTIPLY:
+  x = wrapping_multiply(MEMORY_OPERAND, x);
+  NEXT();
+op_DIVIDE:
+  if (x == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_divide(MEMORY_OPERAND, x);
+  NEXT();
+op_REMAINDER:
+  if (x == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_remainder(MEMORY_OPERAND, x);
+  NEXT();
+
+op_ADD_I:
+  x = wrapping_add(x, OPERAND);
+  NEXT();
+op_SUBTRACT_I:
+  x = wrapping_subtract(x, OPERAND);
+  NEXT();
+op_MULTIPLY_I:
+  x = wrapping_multiply(x, OPERAND);
+  NEXT();
+op_DIVIDE_I:
+  if (OPERAND == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_divide(x, OPERAND);
+  NEXT();
+op_REMAINDER_I:
+  if (OPERAND == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_remainder(x, OPERAND);
+  NEXT();
+
+  // Not supported at the moment, same as in the editor
+op_F_NEGATE:
+op_F_ADD:
+op_F_SUBTRACT:
+op_F_MULTIPLY:
+op_F_DIVIDE:
+op_F_ADD_I:
+op_F_SUBTRACT_I:
+op_F_MULTIPLY_I:
+op_F_DIVIDE_I:
+  x = 0xBAD;
+  NEXT();
+
+op_OR:
+  x = MEMORY_OPERAND | x;
+  NEXT();
+op_AND:
+  x = MEMORY_OPERAND & x;
+  NEXT();
+op_XOR:
+  x = MEMORY_OPERAND ^ x;
+  NEXT();
+op_INVERT:
+  x = ~x;
+  NEXT();
+
+op_GT:
+  x = MEMORY_OPERAND > x ? 1 : 0;
+  NEXT();
+op_LT:
+  x = MEMORY_OPERAND < x ? 1 : 0;
+  NEXT();
+op_GTEQ:
+  x = MEMORY_OPERAND >= x ? 1 : 0;
+  NEXT();
+op_LTEQ:
+  x = MEMORY_OPERAND <= x ? 1 : 0;
+  NEXT();
+op_EQUALS:
+  x = MEMORY_OPERAND == x ? 1 : 0;
+  NEXT();
+op_NOT:
+  x = x == 0 ? 1 : 0;
+  NEXT();
+
+op_OR_I:
+  x = x | OPERAND;
+  NEXT();
+op_AND_I:
+  x = x & OPERAND;
+  NEXT();
+op_XOR_I:
+  x = x ^ OPERAND;
+  NEXT();
+
+op_JUMP:
+  pc = code[pc].operands[0];
+  DISPATCH();
+op_BRANCH_IF_ZERO:
+  pc = x == 0 ? code[pc].operands[0] : pc + 1;
+  DISPATCH();
+op_BRANCH_IF_NOT_ZERO:
+  pc = x != 0 ? code[pc].operands[0] : pc + 1;
+  DISPATCH();
+
+op_INTERRUPT:
+  switch ((sys_call)code[pc].operands[0]) {
+  case sys_call::READ: {
+    std::int64_t value;
+
+    if (!io.read(&value)) {
+      // Try again when resumed
+      ++remaining;
+      if constexpr (profiling) {
+        --counts[pc];
+      }
+      reason = exit_reason::WAITING_FOR_INPUT;
+      goto stop;
+    }
+
+    if ((std::uint64_t)x > memory_size - sizeof(std::int64_t)) {
+      goto out_of_bounds;
+    }
+
+    write_memory(memory, x, value);
+    break;
+  }
+  case sys_call::WRITE:
+    io.write(x);
+    break;
+  }
+  NEXT();
+
+#undef MEMORY_OPERAND
+#undef OPERAND
+#undef NEXT
+#undef DISPATCH
+
+stop:
+  state.pc = pc;
+  state.x = x;
+  state.executed += fuel - remaining;
+  return reason;
+
+  // The faulting instruction is not counted as executed
+division_by_zero:
+  if constexpr (profiling) {
+    --counts[pc];
+  }
+  state.pc = pc;
+  state.x = x;
+  state.executed += fuel - remaining - 1;
+  throw execution_error(format_division_by_zero(prog, pc), pc);
+
+out_of_bounds:
+  if constexpr (profiling) {
+    --counts[pc];
+  }
+  state.pc = pc;
+  state.x = x;
+  state.executed += fuel - remaining - 1;
+  throw execution_error(format_out_of_bounds(x, pc), pc);
+}
+
+exit_reason execute(const program &prog, machine_state &state, io_device &io,
+                    std::uint64_t fuel) {
+  return run_program<false, false>(prog, state, io, fuel, nullptr, nullptr);
+}
+
+exit_reason execute_profiled(const program &prog, machine_state &state,
+                             io_device &io, std::uint64_t fuel,
+                             std::uint64_t *counts) {
+  return run_program<true, false>(prog, state, io, fuel, counts, nullptr);
+}
+
+exit_reason execute_until(const program &prog, machine_state &state,
+                          io_device &io, std::uint64_t fuel,
+                          const std::uint8_t *stops) {
+  if (fuel == 0) {
+    return exit_reason::OUT_OF_FUEL;
+  }
+
+  // Otherwise it would never get past a stop once there
+  auto reason = execute(prog, state, io, 1);
+
+  if (reason != exit_reason::OUT_OF_FUEL || fuel == 1) {
+    return reason;
+  }
+
+  return run_program<false, true>(prog, state, io, fuel - 1, nullptr, stops);
+}
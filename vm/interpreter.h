@@ -0,0 +1,47 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+// Runs `prog` from wherever `state` is for at most `fuel` instructions.
+// Addresses must have been checked with `check_addresses` beforehand
+exit_reason execute(const program &prog, machine_state &state, io_device &io,
+                    std::uint64_t fuel);
+
+// Same, also adding one to `counts[pc]` for each instruction run. There must
+// be a count for each instruction
+exit_reason execute_profiled(const program &prog, machine_state &state,
+                             io_device &io, std::uint64_t fuel,
+                             std::uint64_t *counts);
+
+// Same as `execute`, but stops with `BREAKPOINT` before running an instruction
+// whose `stops[pc]` is set, other than the one it starts at
+exit_reason execute_until(const program &prog, machine_state &state,
+                          io_device &io, std::uint64_t fuel,
+                          const std::uint8_t *stops);
+
+// Native counterpart to the editor's `Cpu`. Runs the program's code as is,
+// dispatching with computed gotos.
+class interpreter {
+private:
+  const program &prog;
+  io_device &io;
+  machine_state state;
+
+public:
+  interpreter(const program &prog, io_device &io,
+              std::uint64_t memory_size = default_memory_size);
+
+  // Back to the state right after loading
+  void reset();
+
+  // Runs at most `fuel` instructions. May be called again to resume.
+  // Throws `execution_error` if the program does something illegal
+  exit_reason run(std::uint64_t fuel = unlimited_fuel);
+
+  machine_state &get_state();
+};
+
+#endif /* INTERPRETER_H */
@@ -0,0 +1,18 @@
+#include "vm/io.h"
+
+buffered_io::buffered_io() {}
+
+buffered_io::buffered_io(std::vector<std::int64_t> input)
+    : input(input.begin(), input.end()) {}
+
+bool buffered_io::read(std::int64_t *value) {
+  if (this->input.empty()) {
+    return false;
+  }
+
+  *value = this->input.front();
+  this->input.pop_front();
+  return true;
+}
+
+void buffered_io::write(std::int64_t value) { this->output.push_back(value); }
@@ -0,0 +1,30 @@
+#ifndef VM_IO_H
+#define VM_IO_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// What the READ and WRITE syscalls talk to
+class io_device {
+public:
+  // Should return false if there is no input available at the moment, in
+  // which case the machine stops before the READ and may be resumed later
+  virtual bool read(std::int64_t *value) = 0;
+  virtual void write(std::int64_t value) = 0;
+};
+
+// Input is given upfront and output is collected
+class buffered_io : public io_device {
+public:
+  std::deque<std::int64_t> input;
+  std::vector<std::int64_t> output;
+
+  buffered_io();
+  buffered_io(std::vector<std::int64_t> input);
+
+  virtual bool read(std::int64_t *value);
+  virtual void write(std::int64_t value);
+};
+
+#endif /* VM_IO_H */
@@ -0,0 +1,801 @@
+#include "vm/jit.h"
+#include "vm/interpreter.h"
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+// Shared with the generated code, which keeps a pointer to it in r14. Only
+// plain data so that the offsets are well defined
+struct jit_frame {
+  std::int64_t x;
+  std::uint64_t remaining;
+  std::uint64_t pc;
+  std::uint8_t *memory;
+
+  std::uint64_t memory_size;
+  io_device *io;
+  std::exception_ptr *error;
+
+  std::int32_t (*read)(jit_frame *frame, std::int64_t address);
+  std::int32_t (*write)(jit_frame *frame, std::int64_t value);
+};
+
+// Why the generated code returned. `frame.pc` says where
+enum class jit_exit : std::int32_t {
+  CONTINUE,
+  HALTED,
+  OUT_OF_FUEL,
+  WAITING_FOR_INPUT,
+  DIVISION_BY_ZERO,
+  OUT_OF_BOUNDS,
+  // Thrown by the io device. Exceptions can't unwind through generated code
+  IO_ERROR,
+  // Reached a block that wasn't compiled
+  INTERPRET,
+};
+
+static std::int32_t jit_read(jit_frame *frame, std::int64_t address) {
+  std::int64_t value;
+
+  try {
+    if (!frame->io->read(&value)) {
+      return (std::int32_t)jit_exit::WAITING_FOR_INPUT;
+    }
+  } catch (...) {
+    *frame->error = std::current_exception();
+    return (std::int32_t)jit_exit::IO_ERROR;
+  }
+
+  if ((std::uint64_t)address > frame->memory_size - sizeof(std::int64_t)) {
+    return (std::int32_t)jit_exit::OUT_OF_BOUNDS;
+  }
+
+  write_memory(frame->memory, address, value);
+  return (std::int32_t)jit_exit::CONTINUE;
+}
+
+static std::int32_t jit_write(jit_frame *frame, std::int64_t value) {
+  try {
+    frame->io->write(value);
+  } catch (...) {
+    *frame->error = std::current_exception();
+    return (std::int32_t)jit_exit::IO_ERROR;
+  }
+
+  return (std::int32_t)jit_exit::CONTINUE;
+}
+
+#ifdef JIT_SUPPORTED
+
+// Called with the frame and the address to start at
+using jit_entry = std::int32_t (*)(jit_frame *frame, const void *target);
+
+class assembler {
+public:
+  std::vector<std::uint8_t> bytes;
+
+  void emit(std::initializer_list<std::uint8_t> values) {
+    this->bytes.insert(this->bytes.end(), values);
+  }
+
+  void emit32(std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      this->bytes.push_back((value >> (i * 8)) & 0xFF);
+    }
+  }
+
+  void emit64(std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      this->bytes.push_back((value >> (i * 8)) & 0xFF);
+    }
+  }
+
+  std::size_t here() const { return this->bytes.size(); }
+
+  // For a rel32 to be filled in later. Returns where it is
+  std::size_t placeholder32() {
+    auto at = this->here();
+    this->emit32(0);
+    return at;
+  }
+
+  void patch32(std::size_t at, std::size_t target) {
+    auto relative = (std::uint32_t)(target - (at + 4));
+
+    for (int i = 0; i < 4; ++i) {
+      this->bytes[at + i] = (relative >> (i * 8)) & 0xFF;
+    }
+  }
+
+  std::size_t placeholder8() {
+    auto at = this->here();
+    this->emit({0});
+    return at;
+  }
+
+  void patch8(std::size_t at, std::size_t target) {
+    this->bytes[at] = (std::uint8_t)(target - (at + 1));
+  }
+};
+
+static bool fits_int32(std::int64_t value) {
+  return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// Registers:
+//   rbx: X
+//   r12: memory
+//   r13: remaining fuel
+//   r14: the `jit_frame`
+//   rax, rcx, rdx, rsi, rdi: scratch
+const std::uint8_t RAX = 0;
+const std::uint8_t RBX = 3;
+
+class code_generator {
+private:
+  const program &prog;
+  const basic_blocks &blocks;
+  assembler a;
+
+  std::size_t exit_label;
+
+  // Conditional exits are emitted out of the way, after everything else
+  struct stub {
+    std::size_t site;
+    std::uint64_t pc;
+    jit_exit reason;
+  };
+  std::vector<stub> stubs;
+
+  struct jump {
+    std::size_t site;
+    std::uint64_t target;
+  };
+  std::vector<jump> jumps;
+
+public:
+  std::vector<std::uint32_t> native_of_pc;
+  std::vector<bool> is_compiled;
+
+  code_generator(const program &prog, const basic_blocks &blocks)
+      : prog(prog), blocks(blocks) {}
+
+  std::vector<std::uint8_t> generate();
+
+private:
+  bool can_compile(std::uint64_t start, std::uint64_t end);
+
+  void prologue();
+  void exit_sequence();
+  void exit_now(std::uint64_t pc, jit_exit reason);
+  void exit_if(std::initializer_list<std::uint8_t> jcc, std::uint64_t pc,
+               jit_exit reason);
+  void jump_to(std::initializer_list<std::uint8_t> jcc, std::uint64_t target);
+
+  void memory_op(std::initializer_list<std::uint8_t> opcode, std::uint8_t reg,
+                 std::uint64_t address);
+  void immediate_op(std::uint8_t digit, std::uint8_t register_opcode,
+                    std::int64_t value);
+  void load_immediate(std::int64_t value);
+  void compare(std::uint8_t setcc);
+  void divide(std::uint64_t pc, std::uint64_t address, bool remainder);
+  void divide_immediate(std::uint64_t pc, std::int64_t value, bool remainder);
+  void call(std::size_t callback_offset, std::uint64_t pc);
+
+  void instruction(std::uint64_t pc);
+  void block(std::uint64_t start, std::uint64_t end);
+};
+
+bool code_generator::can_compile(std::uint64_t start, std::uint64_t end) {
+  for (std::uint64_t pc = start; pc < end; ++pc) {
+    auto &instruction = this->prog.code[pc];
+
+    // Addresses go in 32 bit displacements
+    if (operand_is_address(instruction.operation) &&
+        instruction.operands[0] > INT32_MAX) {
+      return false;
+    }
+  }
+
+  return end - start <= INT32_MAX;
+}
+
+// int32_t entry(jit_frame *frame, const void *target)
+void code_generator::prologue() {
+  auto &a = this->a;
+
+  a.emit({0x55});             // push rbp
+  a.emit({0x53});             // push rbx
+  a.emit({0x41, 0x54});       // push r12
+  a.emit({0x41, 0x55});       // push r13
+  a.emit({0x41, 0x56});       // push r14
+  a.emit({0x41, 0x57});       // push r15
+  a.emit({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8 (keeps calls aligned)
+  a.emit({0x49, 0x89, 0xFE}); // mov r14, rdi
+
+  a.emit({0x49, 0x8B, 0x5E, offsetof(jit_frame, x)}); // mov rbx, [r14 + x]
+  a.emit({0x4D, 0x8B, 0x6E, offsetof(jit_frame, remaining)}); // mov r13, ...
+  a.emit({0x4D, 0x8B, 0x66, offsetof(jit_frame, memory)}); // mov r12, ...
+
+  a.emit({0xFF, 0xE6}); // jmp rsi
+}
+
+// Expects the pc in edx and the reason in eax
+void code_generator::exit_sequence() {
+  auto &a = this->a;
+  this->exit_label = a.here();
+
+  a.emit({0x49, 0x89, 0x5E, offsetof(jit_frame, x)}); // mov [r14 + x], rbx
+  a.emit({0x4D, 0x89, 0x6E, offsetof(jit_frame, remaining)}); // mov ..., r13
+  a.emit({0x49, 0x89, 0x56, offsetof(jit_frame, pc)}); // mov ..., rdx
+
+  a.emit({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+  a.emit({0x41, 0x5F});             // pop r15
+  a.emit({0x41, 0x5E});             // pop r14
+  a.emit({0x41, 0x5D});             // pop r13
+  a.emit({0x41, 0x5C});             // pop r12
+  a.emit({0x5B});                   // pop rbx
+  a.emit({0x5D});                   // pop rbp
+  a.emit({0xC3});                   // ret
+}
+
+void code_generator::exit_now(std::uint64_t pc, jit_exit reason) {
+  auto &a = this->a;
+
+  a.emit({0xBA}); // mov edx, pc
+  a.emit32(pc);
+
+  // Callbacks leave their reason in eax already
+  if (reason != jit_exit::CONTINUE) {
+    a.emit({0xB8}); // mov eax, reason
+    a.emit32((std::uint32_t)reason);
+  }
+
+  a.emit({0xE9}); // jmp exit
+  a.patch32(a.placeholder32(), this->exit_label);
+}
+
+void code_generator::exit_if(std::initializer_list<std::uint8_t> jcc,
+                             std::uint64_t pc, jit_exit reason) {
+  this->a.emit(jcc);
+  this->stubs.push_back({this->a.placeholder32(), pc, reason});
+}
+
+void code_generator::jump_to(std::initializer_list<std::uint8_t> jcc,
+                             std::uint64_t target) {
+  this->a.emit(jcc);
+  this->jumps.push_back({this->a.placeholder32(), target});
+}
+
+// op reg, [r12 + address]
+void code_generator::memory_op(std::initializer_list<std::uint8_t> opcode,
+                               std::uint8_t reg, std::uint64_t address) {
+  auto &a = this->a;
+
+  a.emit({0x49});
+  a.emit(opcode);
+  a.emit({(std::uint8_t)(0x80 | reg << 3 | 0x04), 0x24});
+  a.emit32(address);
+}
+
+// op rbx, value. `digit` is the opcode extension for the 81 form and
+// `register_opcode` the opcode for op r/m64, r64
+void code_generator::immediate_op(std::uint8_t digit,
+                                  std::uint8_t register_opcode,
+                                  std::int64_t value) {
+  auto &a = this->a;
+
+  if (fits_int32(value)) {
+    a.emit({0x48, 0x81, (std::uint8_t)(0xC0 | digit << 3 | RBX)});
+    a.emit32(value);
+    return;
+  }
+
+  a.emit({0x48, 0xB8}); // mov rax, value
+  a.emit64(value);
+  a.emit({0x48, register_opcode, 0xC3}); // op rbx, rax
+}
+
+// mov rbx, value
+void code_generator::load_immediate(std::int64_t value) {
+  auto &a = this->a;
+
+  if (fits_int32(value)) {
+    a.emit({0x48, 0xC7, 0xC3});
+    a.emit32(value);
+    return;
+  }
+
+  a.emit({0x48, 0xBB});
+  a.emit64(value);
+}
+
+// rbx = setcc ? 1 : 0, after a comparison
+void code_generator::compare(std::uint8_t setcc) {
+  this->a.emit({0x0F, setcc, 0xC0});       // setcc al
+  this->a.emit({0x0F, 0xB6, 0xD8});        // movzx ebx, al
+}
+
+// X = [address] / X
+void code_generator::divide(std::uint64_t pc, std::uint64_t address,
+                            bool remainder) {
+  auto &a = this->a;
+
+  a.emit({0x48, 0x85, 0xDB}); // test rbx, rbx
+  this->exit_if({0x0F, 0x84}, pc, jit_exit::DIVISION_BY_ZERO); // jz
+
+  this->memory_op({0x8B}, RAX, address); // mov rax, [address]
+
+  // idiv faults on INT64_MIN / -1, which should wrap instead
+  a.emit({0x48, 0x83, 0xFB, 0xFF}); // cmp rbx, -1
+  a.emit({0x75});                   // jne
+  auto not_minus_one = a.placeholder8();
+
+  if (remainder) {
+    a.emit({0x31, 0xC0}); // xor eax, eax
+  } else {
+    a.emit({0x48, 0xF7, 0xD8}); // neg rax
+  }
+
+  a.emit({0xEB}); // jmp
+  auto done = a.placeholder8();
+
+  a.patch8(not_minus_one, a.here());
+  a.emit({0x48, 0x99});       // cqo
+  a.emit({0x48, 0xF7, 0xFB}); // idiv rbx
+
+  if (remainder) {
+    a.emit({0x48, 0x89, 0xD0}); // mov rax, rdx
+  }
+
+  a.patch8(done, a.here());
+  a.emit({0x48, 0x89, 0xC3}); // mov rbx, rax
+}
+
+// X = X / value
+void code_generator::divide_immediate(std::uint64_t pc, std::int64_t value,
+                                      bool remainder) {
+  auto &a = this->a;
+
+  if (value == 0) {
+    this->exit_if({0xE9}, pc, jit_exit::DIVISION_BY_ZERO); // jmp
+    return;
+  }
+
+  if (value == -1) {
+    if (remainder) {
+      a.emit({0x31, 0xDB}); // xor ebx, ebx
+    } else {
+      a.emit({0x48, 0xF7, 0xDB}); // neg rbx
+    }
+    return;
+  }
+
+  a.emit({0x48, 0x89, 0xD8}); // mov rax, rbx
+  a.emit({0x48, 0x99});       // cqo
+
+  if (fits_int32(value)) {
+    a.emit({0x48, 0xC7, 0xC1}); // mov rcx, value
+    a.emit32(value);
+  } else {
+    a.emit({0x48, 0xB9});
+    a.emit64(value);
+  }
+
+  a.emit({0x48, 0xF7, 0xF9}); // idiv rcx
+
+  if (remainder) {
+    a.emit({0x48, 0x89, 0xD3}); // mov rbx, rdx
+  } else {
+    a.emit({0x48, 0x89, 0xC3}); // mov rbx, rax
+  }
+}
+
+// Calls back with the frame and X, leaving if it returns something other than
+// `CONTINUE`
+void code_generator::call(std::size_t callback_offset, std::uint64_t pc) {
+  auto &a = this->a;
+
+  a.emit({0x4C, 0x89, 0xF7}); // mov rdi, r14
+  a.emit({0x48, 0x89, 0xDE}); // mov rsi, rbx
+  a.emit({0x41, 0xFF, 0x56, (std::uint8_t)callback_offset}); // call [r14 + ...]
+  a.emit({0x85, 0xC0});                                      // test eax, eax
+  this->exit_if({0x0F, 0x85}, pc, jit_exit::CONTINUE);       // jnz
+}
+
+void code_generator::instruction(std::uint64_t pc) {
+  auto &a = this->a;
+  auto &instruction = this->prog.code[pc];
+  auto operand = instruction.operands[0];
+  auto immediate = (std::int64_t)operand;
+
+  switch (instruction.operation) {
+  // Not supported at the moment, same as in the editor
+  case op::NOOP:
+  case op::LOAD_BP:
+  case op::PUSH:
+  case op::POP:
+  case op::CALL:
+  case op::RET:
+    break;
+
+  case op::LOAD:
+    this->memory_op({0x8B}, RBX, operand);
+    break;
+  case op::SET:
+    this->memory_op({0x89}, RBX, operand);
+    break;
+  case op::LOAD_I:
+    this->load_immediate(immediate);
+    break;
+
+  case op::NEGATE:
+    a.emit({0x48, 0xF7, 0xDB}); // neg rbx
+    break;
+  case op::ADD:
+    this->memory_op({0x03}, RBX, operand);
+    break;
+  case op::SUBTRACT:
+    this->memory_op({0x8B}, RAX, operand);
+    a.emit({0x48, 0x29, 0xD8}); // sub rax, rbx
+    a.emit({0x48, 0x89, 0xC3}); // mov rbx, rax
+    break;
+  case op::MULTIPLY:
+    this->memory_op({0x0F, 0xAF}, RBX, operand);
+    break;
+  case op::DIVIDE:
+    this->divide(pc, operand, false);
+    break;
+  case op::REMAINDER:
+    this->divide(pc, operand, true);
+    break;
+
+  case op::ADD_I:
+    this->immediate_op(0, 0x01, immediate);
+    break;
+  case op::SUBTRACT_I:
+    this->immediate_op(5, 0x29, immediate);
+    break;
+  case op::MULTIPLY_I:
+    if (fits_int32(immediate)) {
+      a.emit({0x48, 0x69, 0xDB}); // imul rbx, rbx, value
+      a.emit32(immediate);
+    } else {
+      a.emit({0x48, 0xB8}); // mov rax, value
+      a.emit64(immediate);
+      a.emit({0x48, 0x0F, 0xAF, 0xD8}); // imul rbx, rax
+    }
+    break;
+  case op::DIVIDE_I:
+    this->divide_immediate(pc, immediate, false);
+    break;
+  case op::REMAINDER_I:
+    this->divide_immediate(pc, immediate, true);
+    break;
+
+  // Not supported at the moment, same as in the editor
+  case op::F_NEGATE:
+  case op::F_ADD:
+  case op::F_SUBTRACT:
+  case op::F_MULTIPLY:
+  case op::F_DIVIDE:
+  case op::F_ADD_I:
+  case op::F_SUBTRACT_I:
+  case op::F_MULTIPLY_I:
+  case op::F_DIVIDE_I:
+    this->load_immediate(0xBAD);
+    break;
+
+  case op::OR:
+    this->memory_op({0x0B}, RBX, operand);
+    break;
+  case op::AND:
+    this->memory_op({0x23}, RBX, operand);
+    break;
+  case op::XOR:
+    this->memory_op({0x33}, RBX, operand);
+    break;
+  case op::INVERT:
+    a.emit({0x48, 0xF7, 0xD3}); // not rbx
+    break;
+
+  // cmp rbx, [address] compares the other way around
+  case op::GT:
+    this->memory_op({0x3B}, RBX, operand);
+    this->compare(0x9C); // setl
+    break;
+  case op::LT:
+    this->memory_op({0x3B}, RBX, operand);
+    this->compare(0x9F); // setg
+    break;
+  case op::GTEQ:
+    this->memory_op({0x3B}, RBX, operand);
+    this->compare(0x9E); // setle
+    break;
+  case op::LTEQ:
+    this->memory_op({0x3B}, RBX, operand);
+    this->compare(0x9D); // setge
+    break;
+  case op::EQUALS:
+    this->memory_op({0x3B}, RBX, operand);
+    this->compare(0x94); // sete
+    break;
+  case op::NOT:
+    a.emit({0x48, 0x85, 0xDB}); // test rbx, rbx
+    this->compare(0x94);        // sete
+    break;
+
+  case op::OR_I:
+    this->immediate_op(1, 0x09, immediate);
+    break;
+  case op::AND_I:
+    // The compiler masks every variable it loads, which for 8 byte types
+    // does nothing
+    if (operand != UINT64_MAX) {
+      this->immediate_op(4, 0x21, immediate);
+    }
+    break;
+  case op::XOR_I:
+    this->immediate_op(6, 0x31, immediate);
+    break;
+
+  case op::JUMP:
+    this->jump_to({0xE9}, operand); // jmp
+    break;
+  case op::BRANCH_IF_ZERO:
+    a.emit({0x48, 0x85, 0xDB});           // test rbx, rbx
+    this->jump_to({0x0F, 0x84}, operand); // jz
+    break;
+  case op::BRANCH_IF_NOT_ZERO:
+    a.emit({0x48, 0x85, 0xDB});           // test rbx, rbx
+    this->jump_to({0x0F, 0x85}, operand); // jnz
+    break;
+
+  case op::INTERRUPT:
+    if (operand == code_of_syscall(sys_call::READ)) {
+      this->call(offsetof(jit_frame, read), pc);
+    } else if (operand == code_of_syscall(sys_call::WRITE)) {
+      this->call(offsetof(jit_frame, write), pc);
+    }
+    break;
+  }
+}
+
+void code_generator::block(std::uint64_t start, std::uint64_t end) {
+  auto &a = this->a;
+
+  if (!this->can_compile(start, end)) {
+    for (std::uint64_t pc = start; pc < end; ++pc) {
+      this->native_of_pc[pc] = a.here();
+    }
+
+    this->exit_now(start, jit_exit::INTERPRET);
+    return;
+  }
+
+  this->native_of_pc[start] = a.here();
+  this->is_compiled[start] = true;
+
+  // Charge the whole block up front, or let the interpreter run what's left
+  a.emit({0x49, 0x81, 0xFD}); // cmp r13, length
+  a.emit32(end - start);
+  this->exit_if({0x0F, 0x82}, start, jit_exit::OUT_OF_FUEL); // jb
+  a.emit({0x49, 0x81, 0xED}); // sub r13, length
+  a.emit32(end - start);
+
+  for (std::uint64_t pc = start; pc < end; ++pc) {
+    if (pc != start) {
+      this->native_of_pc[pc] = a.here();
+    }
+
+    this->instruction(pc);
+  }
+}
+
+std::vector<std::uint8_t> code_generator::generate() {
+  auto &a = this->a;
+  auto size = this->prog.code.size();
+  auto &starts = this->blocks.starts;
+
+  this->native_of_pc.resize(size + 1);
+  this->is_compiled.resize(size + 1, false);
+
+  this->prologue();
+  this->exit_sequence();
+
+  for (size_t i = 0; i < starts.size(); ++i) {
+    auto end = i + 1 < starts.size() ? starts[i + 1] : size;
+    this->block(starts[i], end);
+  }
+
+  this->native_of_pc[size] = a.here();
+  this->exit_now(size, jit_exit::HALTED);
+
+  for (auto &stub : this->stubs) {
+    a.patch32(stub.site, a.here());
+    this->exit_now(stub.pc, stub.reason);
+  }
+
+  for (auto &jump : this->jumps) {
+    auto target = std::min<std::uint64_t>(jump.target, size);
+    a.patch32(jump.site, this->native_of_pc[target]);
+  }
+
+  return std::move(a.bytes);
+}
+
+#endif
+
+jit_program::jit_program(const program &prog, std::uint64_t memory_size)
+    : prog(prog), blocks(prog) {
+  this->memory_size = std::max<std::uint64_t>(
+      memory_size, prog.data.size() + sizeof(std::int64_t));
+  check_addresses(this->prog, this->memory_size);
+
+#ifdef JIT_SUPPORTED
+  // pcs go in 32 bit immediates
+  if (prog.code.size() > INT32_MAX) {
+    return;
+  }
+
+  code_generator generator(this->prog, this->blocks);
+  auto bytes = generator.generate();
+
+  void *memory = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (memory == MAP_FAILED) {
+    return;
+  }
+
+  std::copy(bytes.begin(), bytes.end(), (std::uint8_t *)memory);
+
+  if (mprotect(memory, bytes.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, bytes.size());
+    return;
+  }
+
+  this->native = (std::uint8_t *)memory;
+  this->native_size = bytes.size();
+  this->native_of_pc = std::move(generator.native_of_pc);
+  this->is_compiled = std::move(generator.is_compiled);
+#endif
+}
+
+jit_program::~jit_program() {
+#ifdef JIT_SUPPORTED
+  if (this->native != nullptr) {
+    munmap(this->native, this->native_size);
+  }
+#endif
+}
+
+std::uint64_t jit_program::pc_of_native(const void *address) const {
+  auto size = this->prog.code.size();
+  auto offset = (const std::uint8_t *)address - this->native;
+
+  if (this->native == nullptr || offset < 0 ||
+      (std::size_t)offset >= this->native_size) {
+    return size;
+  }
+
+  // The first instruction whose code starts after it, minus one. Elided
+  // instructions share their offset with the next one
+  auto next = std::upper_bound(this->native_of_pc.begin(),
+                               this->native_of_pc.end(), offset);
+
+  if (next == this->native_of_pc.begin()) {
+    return size;
+  }
+
+  auto pc = (std::uint64_t)(next - this->native_of_pc.begin()) - 1;
+  return std::min(pc, size);
+}
+
+jit_interpreter::jit_interpreter(const jit_program &code, io_device &io)
+    : code(code), io(io), state(code.prog, code.memory_size) {}
+
+void jit_interpreter::reset() { this->state.load(this->code.prog); }
+
+machine_state &jit_interpreter::get_state() { return this->state; }
+
+exit_reason jit_interpreter::run(std::uint64_t fuel) {
+  return execute(this->code, this->state, this->io, fuel);
+}
+
+exit_reason execute(const jit_program &code, machine_state &state,
+                    io_device &io, std::uint64_t fuel) {
+  if (code.native == nullptr) {
+    return execute(code.prog, state, io, fuel);
+  }
+
+#ifdef JIT_SUPPORTED
+  auto size = code.prog.code.size();
+  auto entry = (jit_entry)code.native;
+  std::exception_ptr error;
+
+  while (true) {
+    if (state.pc >= size) {
+      return exit_reason::HALTED;
+    }
+
+    if (!code.blocks.is_start(state.pc) || !code.is_compiled[state.pc]) {
+      // Get to the next block the slow way
+      auto to_block_end = std::min(fuel, code.blocks.end(state.pc) - state.pc);
+      auto reason = execute(code.prog, state, io, to_block_end);
+
+      if (reason != exit_reason::OUT_OF_FUEL || to_block_end == fuel) {
+        return reason;
+      }
+
+      fuel -= to_block_end;
+      continue;
+    }
+
+    jit_frame frame = {
+        .x = state.x,
+        .remaining = fuel,
+        .pc = state.pc,
+        .memory = state.memory.data(),
+        .memory_size = state.memory.size(),
+        .io = &io,
+        .error = &error,
+        .read = jit_read,
+        .write = jit_write,
+    };
+
+    auto reason =
+        (jit_exit)entry(&frame, code.native + code.native_of_pc[state.pc]);
+
+    auto pc = frame.pc;
+    auto charged = fuel - frame.remaining;
+    // The whole block was charged for, but it only ran up to `pc`
+    auto refund = pc < size ? code.blocks.end(pc) - pc : 0;
+
+    state.pc = pc;
+    state.x = frame.x;
+
+    switch (reason) {
+    case jit_exit::HALTED:
+      state.executed += charged;
+      return exit_reason::HALTED;
+
+    case jit_exit::OUT_OF_FUEL:
+      // Not enough for the whole block, so run what's left of it one
+      // instruction at a time
+      state.executed += charged;
+      return execute(code.prog, state, io, frame.remaining);
+
+    case jit_exit::WAITING_FOR_INPUT:
+      // READ is always the last of its block
+      state.executed += charged - 1;
+      return exit_reason::WAITING_FOR_INPUT;
+
+    case jit_exit::DIVISION_BY_ZERO:
+      state.executed += charged - refund;
+      throw execution_error(format_division_by_zero(code.prog, pc), pc);
+
+    case jit_exit::OUT_OF_BOUNDS:
+      state.executed += charged - refund;
+      throw execution_error(format_out_of_bounds(state.x, pc), pc);
+
+    case jit_exit::IO_ERROR:
+      state.executed += charged - refund;
+      std::rethrow_exception(error);
+
+    case jit_exit::INTERPRET:
+    case jit_exit::CONTINUE:
+      state.executed += charged;
+      fuel = frame.remaining;
+      break;
+    }
+  }
+#else
+  return execute(code.prog, state, io, fuel);
+#endif
+}
@@ -0,0 +1,63 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+// A program compiled to x86-64 machine code by pasting a fixed snippet for
+// each instruction. X lives in a host register, memory is addressed relative
+// to another one, and READ and WRITE call back into C++.
+//
+// Fuel is charged per basic block like in `threaded_program`. Blocks that
+// can't be compiled, and everything on hosts other than x86-64 Linux, are run
+// by the interpreter instead.
+class jit_program {
+public:
+  program prog;
+  std::uint64_t memory_size;
+  basic_blocks blocks;
+
+  // Null if nothing could be compiled
+  std::uint8_t *native = nullptr;
+  std::size_t native_size = 0;
+
+  // Offset of the code for each instruction. Has one more entry for the end
+  // of the program
+  std::vector<std::uint32_t> native_of_pc;
+  // Indexed by pc, only meaningful for block starts
+  std::vector<bool> is_compiled;
+
+  jit_program(const program &prog,
+              std::uint64_t memory_size = default_memory_size);
+  ~jit_program();
+
+  jit_program(const jit_program &) = delete;
+  jit_program &operator=(const jit_program &) = delete;
+
+  // Which instruction some address in the native code belongs to, so that
+  // things like `source_line_map` may still be used. Code shared by all
+  // instructions counts as the end of the program
+  std::uint64_t pc_of_native(const void *address) const;
+};
+
+// Runs a `jit_program`. Same interface as `interpreter`
+class jit_interpreter {
+private:
+  const jit_program &code;
+  io_device &io;
+  machine_state state;
+
+public:
+  jit_interpreter(const jit_program &code, io_device &io);
+
+  void reset();
+  exit_reason run(std::uint64_t fuel = unlimited_fuel);
+
+  machine_state &get_state();
+};
+
+exit_reason execute(const jit_program &code, machine_state &state,
+                    io_device &io, std::uint64_t fuel);
+
+#endif /* JIT_H */
@@ -0,0 +1,623 @@
+#include "vm/lockstep.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+// Four lanes at a time. With AVX2 that's one register, otherwise the compiler
+// splits them in SSE ones
+typedef std::int64_t lanes __attribute__((vector_size(32)));
+typedef std::uint64_t ulanes __attribute__((vector_size(32)));
+const std::size_t lanes_per_vector = 4;
+
+// The ifunc that picks a clone runs before ThreadSanitizer's runtime is up,
+// and crashes any program linking this, so those get the default only
+#if defined(__SANITIZE_THREAD__)
+#define NO_TARGET_CLONES
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define NO_TARGET_CLONES
+#endif
+#endif
+
+#if defined(__x86_64__) && defined(__linux__) && !defined(NO_TARGET_CLONES)
+#define VECTOR_TARGETS __attribute__((target_clones("avx2", "default")))
+#else
+#define VECTOR_TARGETS
+#endif
+
+// Vectors are passed differently with and without AVX, so everything that
+// takes them must be inlined into the function that was compiled for it
+#define VECTOR_INLINE inline __attribute__((always_inline))
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Lanes are stored as plain integers, since how aligned vectors are also
+// depends on the target
+static VECTOR_INLINE lanes get(const std::int64_t *at) {
+  lanes value;
+  std::memcpy(&value, at, sizeof(value));
+  return value;
+}
+
+static VECTOR_INLINE void put(std::int64_t *at, lanes value) {
+  std::memcpy(at, &value, sizeof(value));
+}
+
+static VECTOR_INLINE lanes blend(lanes mask, lanes a, lanes b) {
+  return (a & mask) | (b & ~mask);
+}
+
+static VECTOR_INLINE bool any(lanes mask) {
+  return (mask[0] | mask[1] | mask[2] | mask[3]) != 0;
+}
+
+// Lanes that are at the same pc
+struct group {
+  std::uint64_t pc;
+  // All ones for the lanes in the group
+  std::vector<std::int64_t> active;
+
+  // Instructions run since the lanes' counts were last updated
+  std::uint64_t steps = 0;
+  // How many more may run before some lane runs out of fuel
+  std::uint64_t budget = 0;
+};
+
+class lockstep_machine {
+public:
+  const program &prog;
+  std::uint64_t memory_size;
+  std::uint64_t fuel;
+
+  std::size_t count;
+  // Rounded up to whole vectors
+  std::size_t width;
+
+  std::vector<std::int64_t> x;
+  // Word by word, each with all lanes
+  std::vector<std::int64_t> memory;
+  // Lanes that took the last branch, kept so branches don't allocate
+  std::vector<std::int64_t> taken;
+
+  std::vector<std::deque<std::int64_t>> input;
+  std::vector<std::uint64_t> executed;
+  std::vector<run_result> results;
+
+  std::vector<group> groups;
+
+  lockstep_machine(const program &prog, std::uint64_t memory_size,
+                   std::uint64_t fuel,
+                   const std::vector<std::vector<std::int64_t>> &inputs);
+
+  void run();
+
+private:
+  bool is_empty(const group &g);
+
+  void flush(group &g);
+  void refuel(group &g);
+  void finish(group &g, exit_reason reason);
+  void fail(group &g, std::size_t lane, std::string message);
+
+  void write_lane(std::uint64_t address, std::size_t lane, std::int64_t value);
+
+  std::optional<group> step(group &g, std::uint64_t limit);
+  void merge();
+};
+
+lockstep_machine::lockstep_machine(
+    const program &prog, std::uint64_t memory_size, std::uint64_t fuel,
+    const std::vector<std::vector<std::int64_t>> &inputs)
+    : prog(prog), memory_size(memory_size), fuel(fuel) {
+  this->count = inputs.size();
+  this->width = (this->count + lanes_per_vector - 1) / lanes_per_vector *
+                lanes_per_vector;
+
+  auto words = (memory_size + sizeof(std::int64_t) - 1) / sizeof(std::int64_t);
+
+  this->x.resize(this->width, 0);
+  this->memory.resize(words * this->width, 0);
+  this->taken.resize(this->width, 0);
+
+  // Same initial data everywhere
+  for (std::size_t word = 0; word * 8 < prog.data.size(); ++word) {
+    std::int64_t value = 0;
+    auto bytes = std::min<std::size_t>(8, prog.data.size() - word * 8);
+    std::memcpy(&value, prog.data.data() + word * 8, bytes);
+
+    std::fill_n(this->memory.begin() + word * this->width, this->width, value);
+  }
+
+  for (auto &lane_input : inputs) {
+    this->input.emplace_back(lane_input.begin(), lane_input.end());
+  }
+
+  this->executed.resize(this->count, 0);
+  this->results.resize(this->count);
+
+  if (this->count == 0) {
+    return;
+  }
+
+  group all;
+  all.pc = 0;
+  all.active.resize(this->width, 0);
+  std::fill_n(all.active.begin(), this->count, -1);
+
+  this->refuel(all);
+  this->groups.push_back(std::move(all));
+}
+
+bool lockstep_machine::is_empty(const group &g) {
+  return std::all_of(g.active.begin(), g.active.end(),
+                     [](std::int64_t mask) { return mask == 0; });
+}
+
+void lockstep_machine::flush(group &g) {
+  if (g.steps == 0) {
+    return;
+  }
+
+  for (std::size_t lane = 0; lane < this->count; ++lane) {
+    if (g.active[lane]) {
+      this->executed[lane] += g.steps;
+    }
+  }
+
+  g.budget -= g.steps;
+  g.steps = 0;
+}
+
+// Stops lanes that have no fuel left and finds out how long the rest may go
+void lockstep_machine::refuel(group &g) {
+  this->flush(g);
+
+  std::uint64_t most_executed = 0;
+
+  for (std::size_t lane = 0; lane < this->count; ++lane) {
+    if (!g.active[lane]) {
+      continue;
+    }
+
+    if (this->executed[lane] >= this->fuel) {
+      this->results[lane].reason = exit_reason::OUT_OF_FUEL;
+      this->results[lane].executed = this->executed[lane];
+      g.active[lane] = 0;
+      continue;
+    }
+
+    most_executed = std::max(most_executed, this->executed[lane]);
+  }
+
+  g.budget = this->fuel - most_executed;
+}
+
+void lockstep_machine::finish(group &g, exit_reason reason) {
+  this->flush(g);
+
+  for (std::size_t lane = 0; lane < this->count; ++lane) {
+    if (g.active[lane]) {
+      this->results[lane].reason = reason;
+      this->results[lane].executed = this->executed[lane];
+      g.active[lane] = 0;
+    }
+  }
+}
+
+// The faulting instruction is not counted as executed
+void lockstep_machine::fail(group &g, std::size_t lane, std::string message) {
+  auto &result = this->results[lane];
+
+  result.reason = exit_reason::HALTED;
+  result.executed = this->executed[lane] + g.steps - 1;
+  result.error.emplace(message, g.pc);
+  g.active[lane] = 0;
+}
+
+void lockstep_machine::write_lane(std::uint64_t address, std::size_t lane,
+                                  std::int64_t value) {
+  std::uint8_t bytes[16] = {};
+  auto word = address / 8;
+  auto words = this->memory.size() / this->width;
+
+  for (std::size_t i = 0; i < 2 && word + i < words; ++i) {
+    auto &cell = this->memory[(word + i) * this->width + lane];
+    std::memcpy(bytes + i * 8, &cell, 8);
+  }
+
+  std::memcpy(bytes + address % 8, &value, 8);
+
+  for (std::size_t i = 0; i < 2 && word + i < words; ++i) {
+    auto &cell = this->memory[(word + i) * this->width + lane];
+    std::memcpy(&cell, bytes + i * 8, 8);
+  }
+}
+
+// Runs `g` until it gets to `limit`, where another group is waiting, or until
+// it ends. Returns the lanes that took a branch if the group split
+VECTOR_TARGETS
+std::optional<group> lockstep_machine::step(group &g, std::uint64_t limit) {
+  auto &code = this->prog.code;
+  auto size = code.size();
+  auto width = this->width;
+
+  auto *x = this->x.data();
+  auto *memory = this->memory.data();
+  auto *active = g.active.data();
+  auto *taken = this->taken.data();
+
+  // 8 byte accesses at any byte address, so possibly across two words
+  auto load = [&](std::uint64_t address,
+                  std::size_t lane) __attribute__((always_inline)) -> lanes {
+    auto word = address / 8;
+    auto shift = (address % 8) * 8;
+    auto low = (ulanes)get(memory + word * width + lane);
+
+    if (shift == 0) {
+      return (lanes)low;
+    }
+
+    auto high = (ulanes)get(memory + (word + 1) * width + lane);
+    return (lanes)((low >> shift) | (high << (64 - shift)));
+  };
+
+  auto store = [&](std::uint64_t address, std::size_t lane,
+                   lanes value) __attribute__((always_inline)) {
+    auto word = address / 8;
+    auto shift = (address % 8) * 8;
+    auto mask = get(active + lane);
+    auto *low = memory + word * width + lane;
+
+    if (shift == 0) {
+      put(low, blend(mask, value, get(low)));
+      return;
+    }
+
+    auto *high = memory + (word + 1) * width + lane;
+    auto kept = (((ulanes){} + 1) << shift) - 1;
+
+    auto new_low = ((ulanes)get(low) & kept) | ((ulanes)value << shift);
+    auto new_high =
+        ((ulanes)get(high) & ~kept) | ((ulanes)value >> (64 - shift));
+
+    put(low, blend(mask, (lanes)new_low, get(low)));
+    put(high, blend(mask, (lanes)new_high, get(high)));
+  };
+
+  // `lane` is the first of each vector. `X` and `ACTIVE` are its values
+#define FOR_EACH_VECTOR                                                        \
+  for (std::size_t lane = 0; lane < width; lane += lanes_per_vector)
+#define X get(x + lane)
+#define ACTIVE get(active + lane)
+#define APPLY(Expression)                                                      \
+  FOR_EACH_VECTOR { put(x + lane, blend(ACTIVE, (Expression), X)); }
+
+  // Wrapping arithmetic is done unsigned
+#define U(Value) ((ulanes)(Value))
+
+  while (g.pc < limit && g.pc < size) {
+    if (g.steps == g.budget) {
+      this->refuel(g);
+
+      if (this->is_empty(g)) {
+        return std::nullopt;
+      }
+    }
+
+    ++g.steps;
+
+    auto &instruction = code[g.pc];
+    auto operand = instruction.operands[0];
+    auto immediate = (std::int64_t)operand;
+
+    switch (instruction.operation) {
+    // Not supported at the moment, same as in the editor
+    case op::NOOP:
+    case op::LOAD_BP:
+    case op::PUSH:
+    case op::POP:
+    case op::CALL:
+    case op::RET:
+      break;
+
+    case op::LOAD:
+      APPLY(load(operand, lane));
+      break;
+    case op::SET:
+      FOR_EACH_VECTOR { store(operand, lane, X); }
+      break;
+    case op::LOAD_I:
+      APPLY((lanes){} + immediate);
+      break;
+
+    case op::NEGATE:
+      APPLY((lanes)((ulanes){} - U(X)));
+      break;
+    case op::ADD:
+      APPLY((lanes)(U(load(operand, lane)) + U(X)));
+      break;
+    case op::SUBTRACT:
+      APPLY((lanes)(U(load(operand, lane)) - U(X)));
+      break;
+    case op::MULTIPLY:
+      APPLY((lanes)(U(load(operand, lane)) * U(X)));
+      break;
+
+    case op::DIVIDE:
+    case op::REMAINDER: {
+      bool remainder = instruction.operation == op::REMAINDER;
+
+      for (std::size_t i = 0; i < this->count; ++i) {
+        if (active[i] && x[i] == 0) {
+          this->fail(g, i, format_division_by_zero(this->prog, g.pc));
+        }
+      }
+
+      FOR_EACH_VECTOR {
+        auto m = load(operand, lane);
+        auto minus_one = X == -1;
+        // Inactive lanes may have anything, and INT64_MIN / -1 traps
+        auto divisor = blend(ACTIVE & ~minus_one, X, (lanes){} + 1);
+
+        lanes result;
+        if (remainder) {
+          result = blend(minus_one, (lanes){}, m % divisor);
+        } else {
+          result = blend(minus_one, (lanes)((ulanes){} - U(m)), m / divisor);
+        }
+
+        put(x + lane, blend(ACTIVE, result, X));
+      }
+      break;
+    }
+
+    case op::ADD_I:
+      APPLY((lanes)(U(X) + (std::uint64_t)operand));
+      break;
+    case op::SUBTRACT_I:
+      APPLY((lanes)(U(X) - (std::uint64_t)operand));
+      break;
+    case op::MULTIPLY_I:
+      APPLY((lanes)(U(X) * (std::uint64_t)operand));
+      break;
+
+    case op::DIVIDE_I:
+    case op::REMAINDER_I: {
+      bool remainder = instruction.operation == op::REMAINDER_I;
+
+      if (immediate == 0) {
+        for (std::size_t i = 0; i < this->count; ++i) {
+          if (active[i]) {
+            this->fail(g, i, format_division_by_zero(this->prog, g.pc));
+          }
+        }
+      } else if (immediate == -1) {
+        if (remainder) {
+          APPLY((lanes){});
+        } else {
+          APPLY((lanes)((ulanes){} - U(X)));
+        }
+      } else if (remainder) {
+        APPLY(X % immediate);
+      } else {
+        APPLY(X / immediate);
+      }
+      break;
+    }
+
+    // Not supported at the moment, same as in the editor
+    case op::F_NEGATE:
+    case op::F_ADD:
+    case op::F_SUBTRACT:
+    case op::F_MULTIPLY:
+    case op::F_DIVIDE:
+    case op::F_ADD_I:
+    case op::F_SUBTRACT_I:
+    case op::F_MULTIPLY_I:
+    case op::F_DIVIDE_I:
+      APPLY((lanes){} + 0xBAD);
+      break;
+
+    case op::OR:
+      APPLY(load(operand, lane) | X);
+      break;
+    case op::AND:
+      APPLY(load(operand, lane) & X);
+      break;
+    case op::XOR:
+      APPLY(load(operand, lane) ^ X);
+      break;
+    case op::INVERT:
+      APPLY(~X);
+      break;
+
+    // Comparisons give all ones for true
+    case op::GT:
+      APPLY((load(operand, lane) > X) & 1);
+      break;
+    case op::LT:
+      APPLY((load(operand, lane) < X) & 1);
+      break;
+    case op::GTEQ:
+      APPLY((load(operand, lane) >= X) & 1);
+      break;
+    case op::LTEQ:
+      APPLY((load(operand, lane) <= X) & 1);
+      break;
+    case op::EQUALS:
+      APPLY((load(operand, lane) == X) & 1);
+      break;
+    case op::NOT:
+      APPLY((X == 0) & 1);
+      break;
+
+    case op::OR_I:
+      APPLY(X | immediate);
+      break;
+    case op::AND_I:
+      APPLY(X & immediate);
+      break;
+    case op::XOR_I:
+      APPLY(X ^ immediate);
+      break;
+
+    case op::JUMP:
+      g.pc = operand;
+      continue;
+
+    case op::BRANCH_IF_ZERO:
+    case op::BRANCH_IF_NOT_ZERO: {
+      bool if_zero = instruction.operation == op::BRANCH_IF_ZERO;
+      bool some_taken = false;
+      bool some_not_taken = false;
+
+      FOR_EACH_VECTOR {
+        auto zero = X == 0;
+        auto lanes_taken = ACTIVE & (if_zero ? zero : ~zero);
+        put(taken + lane, lanes_taken);
+
+        some_taken |= any(lanes_taken);
+        some_not_taken |= any(ACTIVE & ~lanes_taken);
+      }
+
+      if (!some_not_taken) {
+        g.pc = operand;
+        continue;
+      }
+
+      if (!some_taken) {
+        break;
+      }
+
+      // Diverged. Both halves have run the same so far
+      this->flush(g);
+
+      group branch;
+      branch.pc = operand;
+      branch.active.assign(taken, taken + width);
+      branch.budget = g.budget;
+
+      for (std::size_t i = 0; i < width; ++i) {
+        active[i] &= ~branch.active[i];
+      }
+
+      ++g.pc;
+      return branch;
+    }
+
+    case op::INTERRUPT:
+      if (operand == code_of_syscall(sys_call::READ)) {
+        for (std::size_t i = 0; i < this->count; ++i) {
+          if (!active[i]) {
+            continue;
+          }
+
+          auto &lane_input = this->input[i];
+
+          if (lane_input.empty()) {
+            auto &result = this->results[i];
+            result.reason = exit_reason::WAITING_FOR_INPUT;
+            result.executed = this->executed[i] + g.steps - 1;
+            active[i] = 0;
+            continue;
+          }
+
+          auto address = (std::uint64_t)x[i];
+
+          if (address > this->memory_size - sizeof(std::int64_t)) {
+            this->fail(g, i, format_out_of_bounds(address, g.pc));
+            continue;
+          }
+
+          this->write_lane(address, i, lane_input.front());
+          lane_input.pop_front();
+        }
+      } else if (operand == code_of_syscall(sys_call::WRITE)) {
+        for (std::size_t i = 0; i < this->count; ++i) {
+          if (active[i]) {
+            this->results[i].output.push_back(x[i]);
+          }
+        }
+      }
+      break;
+    }
+
+    ++g.pc;
+  }
+
+#undef U
+#undef APPLY
+#undef ACTIVE
+#undef X
+#undef FOR_EACH_VECTOR
+
+  return std::nullopt;
+}
+
+// Groups that got to the same pc run together again
+void lockstep_machine::merge() {
+  auto &groups = this->groups;
+
+  std::sort(groups.begin(), groups.end(),
+            [](const group &a, const group &b) { return a.pc < b.pc; });
+
+  std::vector<group> merged;
+
+  for (auto &g : groups) {
+    if (this->is_empty(g)) {
+      continue;
+    }
+
+    if (!merged.empty() && merged.back().pc == g.pc) {
+      auto &into = merged.back();
+      this->flush(into);
+      this->flush(g);
+
+      for (std::size_t i = 0; i < this->width; ++i) {
+        into.active[i] |= g.active[i];
+      }
+
+      this->refuel(into);
+      continue;
+    }
+
+    merged.push_back(std::move(g));
+  }
+
+  groups = std::move(merged);
+}
+
+void lockstep_machine::run() {
+  auto size = this->prog.code.size();
+
+  while (!this->groups.empty()) {
+    // Sorted by pc after merging, so the first one is furthest behind
+    auto limit = this->groups.size() > 1 ? this->groups[1].pc : UINT64_MAX;
+    auto branch = this->step(this->groups[0], limit);
+
+    if (this->groups[0].pc >= size) {
+      this->finish(this->groups[0], exit_reason::HALTED);
+    }
+
+    if (branch.has_value()) {
+      this->groups.push_back(std::move(branch.value()));
+    }
+
+    this->merge();
+  }
+}
+
+lockstep_runner::lockstep_runner(const program &prog,
+                                 std::uint64_t memory_size)
+    : prog(prog) {
+  this->memory_size = std::max<std::uint64_t>(
+      memory_size, prog.data.size() + sizeof(std::int64_t));
+  check_addresses(prog, this->memory_size);
+}
+
+std::vector<run_result>
+lockstep_runner::run(const std::vector<std::vector<std::int64_t>> &inputs,
+                     std::uint64_t fuel) {
+  lockstep_machine machine(this->prog, this->memory_size, fuel, inputs);
+  machine.run();
+  return std::move(machine.results);
+}
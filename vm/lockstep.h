@@ -0,0 +1,32 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "synthesis/program.h"
+#include "vm/machine.h"
+
+// Runs one program over many inputs at once. There is no indirect addressing
+// other than READ, so instances only differ in their data and may share each
+// instruction for as long as their branches agree. X and memory are stored
+// lane by lane, so that an instruction is a few vector operations for all of
+// them.
+//
+// Instances whose branches disagree are split into groups. The group furthest
+// behind always runs first, so they meet again at the same pc and are merged
+// back.
+class lockstep_runner {
+private:
+  const program &prog;
+  std::uint64_t memory_size;
+
+public:
+  lockstep_runner(const program &prog,
+                  std::uint64_t memory_size = default_memory_size);
+
+  // One result for each input, in the same order. Each instance runs at most
+  // `fuel` instructions
+  std::vector<run_result>
+  run(const std::vector<std::vector<std::int64_t>> &inputs,
+      std::uint64_t fuel = unlimited_fuel);
+};
+
+#endif /* LOCKSTEP_H */
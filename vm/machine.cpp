@@ -0,0 +1,146 @@
+#include "vm/machine.h"
+#include <algorithm>
+
+#define X(Enum, Name) Name,
+char const *exit_reason_names[] = {EXIT_REASONS};
+#undef X
+
+std::ostream &operator<<(std::ostream &o, const exit_reason &a) {
+  return o << exit_reason_names[(size_t)a];
+}
+
+execution_error::execution_error(std::string message, std::uint64_t pc)
+    : std::runtime_error(message), pc(pc) {}
+
+machine_state::machine_state() : pc(0), x(0), executed(0) {}
+
+machine_state::machine_state(const program &prog, std::uint64_t memory_size)
+    : pc(0), x(0), executed(0) {
+  // Accesses are 8 bytes wide, so the last variable may spill a little
+  auto minimum_size = prog.data.size() + sizeof(std::int64_t);
+  this->memory.resize(std::max(memory_size, minimum_size));
+  load(prog);
+}
+
+void machine_state::load(const program &prog) {
+  this->pc = 0;
+  this->x = 0;
+  this->executed = 0;
+
+  std::fill(this->memory.begin(), this->memory.end(), 0);
+  std::copy(prog.data.begin(), prog.data.end(), this->memory.begin());
+}
+
+bool operand_is_address(op operation) {
+  switch (operation) {
+  case op::LOAD:
+  case op::SET:
+  case op::ADD:
+  case op::SUBTRACT:
+  case op::MULTIPLY:
+  case op::DIVIDE:
+  case op::REMAINDER:
+  case op::OR:
+  case op::AND:
+  case op::XOR:
+  case op::GT:
+  case op::LT:
+  case op::GTEQ:
+  case op::LTEQ:
+  case op::EQUALS:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// There is no indirect addressing other than in READ, so once this passes
+// executors don't need to check bounds on every access
+void check_addresses(const program &prog, std::uint64_t memory_size) {
+  for (std::uint64_t pc = 0; pc < prog.code.size(); ++pc) {
+    auto &instruction = prog.code[pc];
+
+    if (!operand_is_address(instruction.operation)) {
+      continue;
+    }
+
+    auto address = instruction.operands[0];
+
+    if (address > memory_size - sizeof(std::int64_t)) {
+      throw execution_error(format_out_of_bounds(address, pc), pc);
+    }
+  }
+}
+
+std::string format_division_by_zero(const program &prog, std::uint64_t pc) {
+  auto &lines = prog.metadata.source_line_map;
+  auto message = "Division by zero! at instruction " + std::to_string(pc);
+
+  if (pc < lines.size()) {
+    message += ", line " + std::to_string(lines[pc]);
+  }
+
+  return message + ".";
+}
+
+std::string format_out_of_bounds(std::uint64_t address, std::uint64_t pc) {
+  return "Address " + std::to_string(address) +
+         " out of bounds at instruction " + std::to_string(pc) + ".";
+}
+
+bool is_jump(op operation) {
+  switch (operation) {
+  case op::JUMP:
+  case op::BRANCH_IF_ZERO:
+  case op::BRANCH_IF_NOT_ZERO:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool is_read(const instruction_with_operands &instruction) {
+  return instruction.operation == op::INTERRUPT &&
+         instruction.operands[0] == code_of_syscall(sys_call::READ);
+}
+
+basic_blocks::basic_blocks(const program &prog)
+    : code_size(prog.code.size()) {
+  auto &code = prog.code;
+  auto size = code.size();
+
+  std::vector<bool> starts_block(size + 1, false);
+  starts_block[0] = true;
+
+  for (std::uint64_t pc = 0; pc < size; ++pc) {
+    auto &instruction = code[pc];
+
+    if (is_jump(instruction.operation)) {
+      starts_block[std::min(instruction.operands[0], size)] = true;
+    }
+
+    if (is_jump(instruction.operation) || is_read(instruction)) {
+      starts_block[pc + 1] = true;
+    }
+  }
+
+  for (std::uint64_t pc = 0; pc < size; ++pc) {
+    if (starts_block[pc]) {
+      this->starts.push_back(pc);
+    }
+  }
+}
+
+bool basic_blocks::is_start(std::uint64_t pc) const {
+  return std::binary_search(this->starts.begin(), this->starts.end(), pc);
+}
+
+std::uint64_t basic_blocks::end(std::uint64_t pc) const {
+  auto next = std::upper_bound(this->starts.begin(), this->starts.end(), pc);
+
+  if (next == this->starts.end()) {
+    return this->code_size;
+  }
+
+  return *next;
+}
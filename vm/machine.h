@@ -0,0 +1,137 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include "synthesis/program.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+// Same as the editor's memory
+const std::uint64_t default_memory_size = 1 << 16;
+const std::uint64_t unlimited_fuel = UINT64_MAX;
+
+// Why did the machine stop
+#define EXIT_REASONS                                                           \
+  X(HALTED, "HALTED")                                                          \
+  X(OUT_OF_FUEL, "OUT_OF_FUEL")                                                \
+  X(WAITING_FOR_INPUT, "WAITING_FOR_INPUT")                                    \
+  X(BREAKPOINT, "BREAKPOINT")
+
+#define X(Enum, Name) Enum,
+enum class exit_reason { EXIT_REASONS };
+#undef X
+
+std::ostream &operator<<(std::ostream &o, const exit_reason &a);
+
+class execution_error : public std::runtime_error {
+public:
+  const std::uint64_t pc;
+
+  execution_error(std::string message, std::uint64_t pc);
+};
+
+// Everything that changes while a program runs. The code itself is kept
+// elsewhere so it may be shared between many runs
+struct machine_state {
+  std::uint64_t pc;
+  std::int64_t x;
+  std::vector<std::uint8_t> memory;
+
+  // Instructions executed so far
+  std::uint64_t executed;
+
+  machine_state();
+  machine_state(const program &prog, std::uint64_t memory_size);
+
+  void load(const program &prog);
+};
+
+// How a run over some given input ended, for executors that run many at once
+struct run_result {
+  exit_reason reason;
+  std::vector<std::int64_t> output;
+  std::uint64_t executed;
+
+  // Set if the program did something illegal, instead of throwing it
+  std::optional<execution_error> error;
+};
+
+static_assert(std::endian::native == std::endian::little,
+              "Memory accesses assume a little endian host");
+
+// Memory accesses always move 8 bytes. Inline since they are in every hot loop
+inline std::int64_t read_memory(const std::uint8_t *memory,
+                                std::uint64_t address) {
+  std::int64_t value;
+  std::memcpy(&value, memory + address, sizeof(value));
+  return value;
+}
+
+inline void write_memory(std::uint8_t *memory, std::uint64_t address,
+                         std::int64_t value) {
+  std::memcpy(memory + address, &value, sizeof(value));
+}
+
+// Arithmetic wraps around like in the editor (`BigInt.asIntN(64, ...)`),
+// which signed overflow in C++ doesn't do by itself
+inline std::int64_t wrapping_add(std::int64_t a, std::int64_t b) {
+  return (std::int64_t)((std::uint64_t)a + (std::uint64_t)b);
+}
+
+inline std::int64_t wrapping_subtract(std::int64_t a, std::int64_t b) {
+  return (std::int64_t)((std::uint64_t)a - (std::uint64_t)b);
+}
+
+inline std::int64_t wrapping_multiply(std::int64_t a, std::int64_t b) {
+  return (std::int64_t)((std::uint64_t)a * (std::uint64_t)b);
+}
+
+// Division by zero must be checked beforehand
+inline std::int64_t wrapping_divide(std::int64_t a, std::int64_t b) {
+  if (b == -1) {
+    return wrapping_subtract(0, a);
+  }
+
+  return a / b;
+}
+
+inline std::int64_t wrapping_remainder(std::int64_t a, std::int64_t b) {
+  if (b == -1) {
+    return 0;
+  }
+
+  return a % b;
+}
+
+// Every instruction operand that is a memory address, to be checked only once
+// when loading the program
+bool operand_is_address(op operation);
+void check_addresses(const program &prog, std::uint64_t memory_size);
+
+std::string format_division_by_zero(const program &prog, std::uint64_t pc);
+std::string format_out_of_bounds(std::uint64_t address, std::uint64_t pc);
+
+// Straight runs of instructions that are only ever entered from the top. Jumps
+// end them, and so does READ, so that waiting for input always happens at the
+// end of one
+class basic_blocks {
+public:
+  // Sorted. The program's end is not included
+  std::vector<std::uint64_t> starts;
+  std::uint64_t code_size;
+
+  basic_blocks(const program &prog);
+
+  bool is_start(std::uint64_t pc) const;
+  // The first pc after the block containing `pc`
+  std::uint64_t end(std::uint64_t pc) const;
+};
+
+bool is_jump(op operation);
+bool is_read(const instruction_with_operands &instruction);
+
+#endif /* MACHINE_H */
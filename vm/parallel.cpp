@@ -0,0 +1,53 @@
+#include "vm/parallel.h"
+#include "vm/interpreter.h"
+#include "vm/io.h"
+#include <algorithm>
+
+parallel_runner::parallel_runner(const program &prog,
+                                 std::uint64_t memory_size,
+                                 std::size_t thread_count)
+    : prog(prog), pool(thread_count) {
+  this->memory_size = std::max<std::uint64_t>(
+      memory_size, prog.data.size() + sizeof(std::int64_t));
+  check_addresses(prog, this->memory_size);
+}
+
+static void run_one(const program &prog, std::uint64_t memory_size,
+                    const std::vector<std::int64_t> &input, std::uint64_t fuel,
+                    timed_run_result &result) {
+  auto start = std::chrono::steady_clock::now();
+
+  machine_state state(prog, memory_size);
+  buffered_io io(input);
+
+  try {
+    result.reason = execute(prog, state, io, fuel);
+  } catch (execution_error &e) {
+    result.reason = exit_reason::HALTED;
+    result.error.emplace(e);
+  }
+
+  result.output = std::move(io.output);
+  result.executed = state.executed;
+  result.wall_time = std::chrono::steady_clock::now() - start;
+}
+
+std::vector<timed_run_result>
+parallel_runner::run(const std::vector<std::vector<std::int64_t>> &inputs,
+                     std::uint64_t fuel) {
+  std::vector<timed_run_result> results(inputs.size());
+
+  // Each task only touches its own result
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    this->pool.submit([this, &inputs, &results, fuel, i]() {
+      run_one(this->prog, this->memory_size, inputs[i], fuel, results[i]);
+    });
+  }
+
+  this->pool.wait();
+  return results;
+}
+
+std::size_t parallel_runner::thread_count() {
+  return this->pool.thread_count();
+}
@@ -0,0 +1,36 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "synthesis/program.h"
+#include "vm/machine.h"
+#include "vm/thread_pool.h"
+#include <chrono>
+
+struct timed_run_result : run_result {
+  std::chrono::nanoseconds wall_time;
+};
+
+// Runs one program over many inputs, each on its own machine, spread over a
+// pool of threads. The code is only read, so all of them share it and only
+// the data is copied for each run.
+class parallel_runner {
+private:
+  const program &prog;
+  std::uint64_t memory_size;
+  work_stealing_pool pool;
+
+public:
+  parallel_runner(const program &prog,
+                  std::uint64_t memory_size = default_memory_size,
+                  std::size_t thread_count = default_thread_count());
+
+  // One result for each input, in the same order. Each run executes at most
+  // `fuel` instructions
+  std::vector<timed_run_result>
+  run(const std::vector<std::vector<std::int64_t>> &inputs,
+      std::uint64_t fuel = unlimited_fuel);
+
+  std::size_t thread_count();
+};
+
+#endif /* PARALLEL_H */
@@ -0,0 +1,110 @@
+#include "vm/profiler.h"
+#include "vm/interpreter.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+profile::profile(const program &prog)
+    : prog(prog), counts(prog.code.size(), 0) {}
+
+void profile::clear() { std::fill(this->counts.begin(), this->counts.end(), 0); }
+
+std::uint64_t profile::total() {
+  return std::accumulate(this->counts.begin(), this->counts.end(),
+                         (std::uint64_t)0);
+}
+
+std::vector<line_profile> profile::by_line() {
+  auto &lines = this->prog.metadata.source_line_map;
+  std::map<std::uint64_t, std::uint64_t> per_line;
+
+  for (std::uint64_t pc = 0; pc < this->counts.size(); ++pc) {
+    if (this->counts[pc] == 0) {
+      continue;
+    }
+
+    auto line = pc < lines.size() ? lines[pc] : 0;
+    per_line[line] += this->counts[pc];
+  }
+
+  std::vector<line_profile> result;
+  for (auto &[line, executed] : per_line) {
+    result.push_back({.line = line, .executed = executed});
+  }
+
+  // Lines in order when tied
+  std::stable_sort(result.begin(), result.end(),
+                   [](const line_profile &a, const line_profile &b) {
+                     return a.executed > b.executed;
+                   });
+
+  return result;
+}
+
+std::vector<statement_profile> profile::by_statement() {
+  auto &lines = this->prog.metadata.source_line_map;
+  auto size = this->counts.size();
+
+  // Not in order in the metadata
+  std::vector<std::uint64_t> starts = {0};
+  for (auto pc : this->prog.metadata.statement_boundaries) {
+    if (pc < size) {
+      starts.push_back(pc);
+    }
+  }
+
+  std::sort(starts.begin(), starts.end());
+  starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+  std::vector<statement_profile> result;
+
+  for (std::size_t i = 0; i < starts.size(); ++i) {
+    auto start = starts[i];
+    auto end = i + 1 < starts.size() ? starts[i + 1] : size;
+
+    if (start >= end) {
+      continue;
+    }
+
+    statement_profile statement = {
+        .start = start,
+        .end = end,
+        .line = start < lines.size() ? lines[start] : 0,
+        .executed = 0,
+        .entered = this->counts[start],
+    };
+
+    for (auto pc = start; pc < end; ++pc) {
+      statement.executed += this->counts[pc];
+    }
+
+    if (statement.executed > 0) {
+      result.push_back(statement);
+    }
+  }
+
+  std::stable_sort(result.begin(), result.end(),
+                   [](const statement_profile &a, const statement_profile &b) {
+                     return a.executed > b.executed;
+                   });
+
+  return result;
+}
+
+profiling_interpreter::profiling_interpreter(const program &prog,
+                                             io_device &io,
+                                             std::uint64_t memory_size)
+    : prog(prog), io(io), state(prog, memory_size), prof(prog) {
+  check_addresses(prog, this->state.memory.size());
+}
+
+void profiling_interpreter::reset() { this->state.load(this->prog); }
+
+exit_reason profiling_interpreter::run(std::uint64_t fuel) {
+  return execute_profiled(this->prog, this->state, this->io, fuel,
+                          this->prof.counts.data());
+}
+
+machine_state &profiling_interpreter::get_state() { return this->state; }
+
+profile &profiling_interpreter::get_profile() { return this->prof; }
@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+struct line_profile {
+  std::uint64_t line;
+  std::uint64_t executed;
+};
+
+// Instructions from one statement boundary up to the next
+struct statement_profile {
+  std::uint64_t start;
+  std::uint64_t end;
+  // Where the first instruction came from
+  std::uint64_t line;
+
+  // Instructions run in it, and how many times it was entered
+  std::uint64_t executed;
+  std::uint64_t entered;
+};
+
+// How many times each instruction ran
+class profile {
+public:
+  const program &prog;
+  std::vector<std::uint64_t> counts;
+
+  profile(const program &prog);
+
+  void clear();
+  std::uint64_t total();
+
+  // Hottest first
+  std::vector<line_profile> by_line();
+  std::vector<statement_profile> by_statement();
+};
+
+// Same as the interpreter, but counts every instruction it runs
+class profiling_interpreter {
+private:
+  const program &prog;
+  io_device &io;
+  machine_state state;
+  class profile prof;
+
+public:
+  profiling_interpreter(const program &prog, io_device &io,
+                        std::uint64_t memory_size = default_memory_size);
+
+  // Back to the state right after loading. Counts are kept
+  void reset();
+
+  exit_reason run(std::uint64_t fuel = unlimited_fuel);
+
+  machine_state &get_state();
+  class profile &get_profile();
+};
+
+#endif /* PROFILER_H */
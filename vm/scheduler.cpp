@@ -0,0 +1,104 @@
+#include "vm/scheduler.h"
+#include "vm/interpreter.h"
+#include <algorithm>
+
+scheduler::scheduler(std::uint64_t slice_fuel, std::uint64_t total_fuel,
+                     std::size_t thread_count)
+    : slice_fuel(std::max<std::uint64_t>(slice_fuel, 1)),
+      fuel_left(total_fuel), executed(0), pool(thread_count) {}
+
+std::size_t scheduler::add(const program &prog,
+                           std::vector<std::int64_t> input, std::uint64_t fuel,
+                           std::uint64_t memory_size) {
+  auto i = std::make_unique<instance>(instance{
+      .prog = &prog,
+      .state = machine_state(prog, memory_size),
+      .io = buffered_io(input),
+      .fuel = fuel,
+      .result = {},
+      .scheduled = false,
+  });
+
+  check_addresses(prog, i->state.memory.size());
+
+  i->result.reason = exit_reason::OUT_OF_FUEL;
+  i->result.executed = 0;
+  i->result.slices = 0;
+  i->result.running_time = std::chrono::nanoseconds(0);
+
+  this->instances.push_back(std::move(i));
+  return this->instances.size() - 1;
+}
+
+// Up to `wanted` of what is left overall
+std::uint64_t scheduler::take_fuel(std::uint64_t wanted) {
+  auto left = this->fuel_left.load();
+  std::uint64_t taken;
+
+  do {
+    taken = std::min(wanted, left);
+  } while (!this->fuel_left.compare_exchange_weak(left, left - taken));
+
+  return taken;
+}
+
+void scheduler::run_slice(instance &i) {
+  auto &state = i.state;
+  auto &result = i.result;
+
+  auto fuel =
+      this->take_fuel(std::min(this->slice_fuel, i.fuel - state.executed));
+  auto before = state.executed;
+  auto start = std::chrono::steady_clock::now();
+  exit_reason reason = exit_reason::OUT_OF_FUEL;
+
+  if (fuel > 0) {
+    try {
+      reason = execute(*i.prog, state, i.io, fuel);
+    } catch (execution_error &e) {
+      reason = exit_reason::HALTED;
+      result.error.emplace(e);
+    }
+
+    ++result.slices;
+    result.running_time += std::chrono::steady_clock::now() - start;
+  }
+
+  auto used = state.executed - before;
+  this->fuel_left += fuel - used;
+  this->executed += used;
+
+  result.executed = state.executed;
+
+  // Preempted, to the back of the line
+  if (reason == exit_reason::OUT_OF_FUEL && fuel > 0 &&
+      state.executed < i.fuel) {
+    this->pool.defer([this, &i]() { this->run_slice(i); });
+    return;
+  }
+
+  result.reason = reason;
+  result.output = std::move(i.io.output);
+}
+
+void scheduler::run() {
+  for (auto &i : this->instances) {
+    // Finished in an earlier run
+    if (i->scheduled) {
+      continue;
+    }
+
+    i->scheduled = true;
+    this->pool.submit([this, &i = *i]() { this->run_slice(i); });
+  }
+
+  this->pool.wait();
+}
+
+const scheduled_run_result &scheduler::result(std::size_t index) {
+  return this->instances[index]->result;
+}
+
+std::size_t scheduler::size() { return this->instances.size(); }
+
+std::uint64_t scheduler::total_executed() { return this->executed.load(); }
@@ -0,0 +1,70 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+#include "vm/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+const std::uint64_t default_slice_fuel = 100000;
+
+struct scheduled_run_result : run_result {
+  // How many times it got to run
+  std::uint64_t slices;
+  // Spent running, not waiting for its turn
+  std::chrono::nanoseconds running_time;
+};
+
+// Runs many machines at once over a few threads. Each one runs for
+// `slice_fuel` instructions at a time and then goes to the back of the queue,
+// so one that never stops doesn't keep the others from running.
+//
+// Each instance may have its own limit, and all of them together stop once
+// `total_fuel` instructions have run.
+class scheduler {
+private:
+  struct instance {
+    const program *prog;
+    machine_state state;
+    buffered_io io;
+    std::uint64_t fuel;
+    scheduled_run_result result;
+    bool scheduled;
+  };
+
+  std::uint64_t slice_fuel;
+  std::vector<std::unique_ptr<instance>> instances;
+
+  // What is left of `total_fuel`
+  std::atomic<std::uint64_t> fuel_left;
+  std::atomic<std::uint64_t> executed;
+
+  work_stealing_pool pool;
+
+  std::uint64_t take_fuel(std::uint64_t wanted);
+  void run_slice(instance &i);
+
+public:
+  scheduler(std::uint64_t slice_fuel = default_slice_fuel,
+            std::uint64_t total_fuel = unlimited_fuel,
+            std::size_t thread_count = default_thread_count());
+
+  // Returns its index in the results. `prog` must outlive the scheduler
+  std::size_t add(const program &prog, std::vector<std::int64_t> input,
+                  std::uint64_t fuel = unlimited_fuel,
+                  std::uint64_t memory_size = default_memory_size);
+
+  // Until every instance added so far stops
+  void run();
+
+  const scheduled_run_result &result(std::size_t index);
+  std::size_t size();
+
+  // By all instances so far. May be read while running
+  std::uint64_t total_executed();
+};
+
+#endif /* SCHEDULER_H */
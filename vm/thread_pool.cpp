@@ -0,0 +1,165 @@
+#include "vm/thread_pool.h"
+#include <algorithm>
+#include <optional>
+
+// Which pool the current thread works for, if any, and its queue there
+static thread_local const work_stealing_pool *current_pool = nullptr;
+static thread_local std::size_t current_queue = 0;
+
+std::size_t default_thread_count() {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  return 0;
+#else
+  return std::max(1u, std::thread::hardware_concurrency());
+#endif
+}
+
+work_stealing_pool::work_stealing_pool(std::size_t thread_count)
+    : pending(0), queued(0), next_queue(0), stopping(false) {
+  // The last queue is for everyone else
+  for (std::size_t i = 0; i <= thread_count; ++i) {
+    this->queues.push_back(std::make_unique<queue>());
+  }
+
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    this->threads.emplace_back([this, i]() { this->work(i); });
+  }
+}
+
+work_stealing_pool::~work_stealing_pool() {
+  {
+    std::lock_guard lock(this->sleep_mutex);
+    this->stopping = true;
+  }
+
+  this->wake.notify_all();
+
+  for (auto &thread : this->threads) {
+    thread.join();
+  }
+}
+
+std::size_t work_stealing_pool::own_queue() {
+  if (current_pool == this) {
+    return current_queue;
+  }
+
+  // Spread outside submissions so that there's less to steal at first
+  return this->next_queue++ % this->queues.size();
+}
+
+void work_stealing_pool::submit(task t) { this->push(std::move(t), false); }
+
+void work_stealing_pool::defer(task t) { this->push(std::move(t), true); }
+
+// The owner takes from the back, so the front is what it gets to last
+void work_stealing_pool::push(task t, bool to_front) {
+  auto &q = *this->queues[this->own_queue()];
+
+  {
+    // Counted first, so that it can't finish before. Under the lock so that
+    // a thread about to sleep doesn't miss it
+    std::lock_guard lock(this->sleep_mutex);
+    ++this->pending;
+    ++this->queued;
+  }
+
+  {
+    std::lock_guard lock(q.mutex);
+
+    if (to_front) {
+      q.tasks.push_front(std::move(t));
+    } else {
+      q.tasks.push_back(std::move(t));
+    }
+  }
+
+  this->wake.notify_one();
+  // Someone waiting may help with it
+  this->done.notify_all();
+}
+
+// Runs one task, from the back of queue `from` or else stolen from the front
+// of another one. False if there was none
+bool work_stealing_pool::try_run(std::size_t from) {
+  std::optional<task> t;
+  auto count = this->queues.size();
+
+  {
+    auto &q = *this->queues[from];
+    std::lock_guard lock(q.mutex);
+
+    if (!q.tasks.empty()) {
+      t.emplace(std::move(q.tasks.back()));
+      q.tasks.pop_back();
+    }
+  }
+
+  for (std::size_t i = 1; i < count && !t.has_value(); ++i) {
+    auto &q = *this->queues[(from + i) % count];
+    std::lock_guard lock(q.mutex);
+
+    if (!q.tasks.empty()) {
+      t.emplace(std::move(q.tasks.front()));
+      q.tasks.pop_front();
+    }
+  }
+
+  if (!t.has_value()) {
+    return false;
+  }
+
+  --this->queued;
+
+  (*t)();
+
+  bool finished;
+  {
+    std::lock_guard lock(this->sleep_mutex);
+    finished = --this->pending == 0;
+  }
+
+  if (finished) {
+    this->done.notify_all();
+  }
+
+  return true;
+}
+
+void work_stealing_pool::work(std::size_t index) {
+  current_pool = this;
+  current_queue = index;
+
+  while (true) {
+    if (this->try_run(index)) {
+      continue;
+    }
+
+    std::unique_lock lock(this->sleep_mutex);
+
+    this->wake.wait(lock, [this]() {
+      return this->stopping || this->queued > 0;
+    });
+
+    if (this->stopping) {
+      return;
+    }
+  }
+}
+
+void work_stealing_pool::wait() {
+  auto index = current_pool == this ? current_queue : this->queues.size() - 1;
+
+  while (this->pending > 0) {
+    if (this->try_run(index)) {
+      continue;
+    }
+
+    std::unique_lock lock(this->sleep_mutex);
+    this->done.wait(lock, [this]() {
+      return this->pending == 0 || this->queued > 0;
+    });
+  }
+}
+
+std::size_t work_stealing_pool::thread_count() { return this->threads.size(); }
@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Default number of threads for the pool, one per core
+std::size_t default_thread_count();
+
+// Runs tasks on a fixed set of threads. Each thread has its own queue: tasks
+// submitted from a worker go to the back of its queue and it takes from the
+// back too, while idle threads steal from the front of the others.
+//
+// `wait` also runs tasks on the calling thread, so a pool with no threads
+// (such as where there's no threading support) still works
+class work_stealing_pool {
+public:
+  typedef std::function<void()> task;
+
+private:
+  struct queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  // One per thread plus one for the threads that are not part of the pool
+  std::vector<std::unique_ptr<queue>> queues;
+  std::vector<std::thread> threads;
+
+  // Submitted and not yet finished
+  std::atomic<std::size_t> pending;
+  // Submitted and still in some queue
+  std::atomic<std::size_t> queued;
+  // Where the next outside submission goes
+  std::atomic<std::size_t> next_queue;
+
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool stopping;
+
+  std::size_t own_queue();
+  void push(task t, bool to_front);
+  bool try_run(std::size_t from);
+  void work(std::size_t index);
+
+public:
+  work_stealing_pool(std::size_t thread_count = default_thread_count());
+  ~work_stealing_pool();
+
+  work_stealing_pool(const work_stealing_pool &) = delete;
+  work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+  void submit(task t);
+
+  // Like `submit`, but after everything that's already in the queue, for
+  // tasks that give way to the others
+  void defer(task t);
+
+  // Until every submitted task is finished, helping along the way. Tasks
+  // should not throw
+  void wait();
+
+  std::size_t thread_count();
+};
+
+#endif /* THREAD_POOL_H */
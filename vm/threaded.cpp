@@ -0,0 +1,477 @@
+#include "vm/threaded.h"
+#include "vm/interpreter.h"
+#include <algorithm>
+#include <optional>
+
+// Handlers in threaded code. Mostly the same as the instructions, but with
+// the syscalls split and with no instructions that do nothing
+#define THREADED_OPERATIONS                                                    \
+  X(BLOCK)                                                                     \
+  X(HALT)                                                                      \
+                                                                               \
+  X(LOAD)                                                                      \
+  X(SET)                                                                       \
+  X(LOAD_I)                                                                    \
+                                                                               \
+  X(NEGATE)                                                                    \
+  X(ADD)                                                                       \
+  X(SUBTRACT)                                                                  \
+  X(MULTIPLY)                                                                  \
+  X(DIVIDE)                                                                    \
+  X(REMAINDER)                                                                 \
+                                                                               \
+  X(ADD_I)                                                                     \
+  X(SUBTRACT_I)                                                                \
+  X(MULTIPLY_I)                                                                \
+  X(DIVIDE_I)                                                                  \
+  X(REMAINDER_I)                                                               \
+                                                                               \
+  X(OR)                                                                        \
+  X(AND)                                                                       \
+  X(XOR)                                                                       \
+  X(INVERT)                                                                    \
+                                                                               \
+  X(GT)                                                                        \
+  X(LT)                                                                        \
+  X(GTEQ)                                                                      \
+  X(LTEQ)                                                                      \
+  X(EQUALS)                                                                    \
+  X(NOT)                                                                       \
+                                                                               \
+  X(OR_I)                                                                      \
+  X(AND_I)                                                                     \
+  X(XOR_I)                                                                     \
+                                                                               \
+  X(JUMP)                                                                      \
+  X(BRANCH_IF_ZERO)                                                            \
+  X(BRANCH_IF_NOT_ZERO)                                                        \
+                                                                               \
+  X(READ)                                                                      \
+  X(WRITE)
+
+#define X(Enum) Enum,
+enum class threaded_op { THREADED_OPERATIONS };
+#undef X
+
+// Labels only exist inside the function that uses them, so when decoding we
+// call it with no code just to get their addresses
+static exit_reason run_threaded(const threaded_program *code,
+                                machine_state *state, io_device *io,
+                                std::uint64_t fuel,
+                                const void *const **table_out);
+
+static const void *const *handler_table() {
+  const void *const *table;
+  run_threaded(nullptr, nullptr, nullptr, 0, &table);
+  return table;
+}
+
+// Empty if the instruction has no effect other than being counted
+static std::optional<threaded_op>
+translate(const instruction_with_operands &instruction) {
+  switch (instruction.operation) {
+  case op::NOOP:
+  case op::LOAD_BP:
+  case op::PUSH:
+  case op::POP:
+  case op::CALL:
+  case op::RET:
+    return std::nullopt;
+
+  // Not supported at the moment, same as in the editor. Becomes a LOAD_I
+  case op::F_NEGATE:
+  case op::F_ADD:
+  case op::F_SUBTRACT:
+  case op::F_MULTIPLY:
+  case op::F_DIVIDE:
+  case op::F_ADD_I:
+  case op::F_SUBTRACT_I:
+  case op::F_MULTIPLY_I:
+  case op::F_DIVIDE_I:
+    return threaded_op::LOAD_I;
+
+  // The compiler masks every variable it loads, which for 8 byte types does
+  // nothing
+  case op::AND_I:
+    if (instruction.operands[0] == UINT64_MAX) {
+      return std::nullopt;
+    }
+    return threaded_op::AND_I;
+
+  case op::INTERRUPT:
+    if (instruction.operands[0] == code_of_syscall(sys_call::READ)) {
+      return threaded_op::READ;
+    }
+    if (instruction.operands[0] == code_of_syscall(sys_call::WRITE)) {
+      return threaded_op::WRITE;
+    }
+    return std::nullopt;
+
+#define X(Enum)                                                                \
+  case op::Enum:                                                               \
+    return threaded_op::Enum;
+
+    X(LOAD)
+    X(SET)
+    X(LOAD_I)
+    X(NEGATE)
+    X(ADD)
+    X(SUBTRACT)
+    X(MULTIPLY)
+    X(DIVIDE)
+    X(REMAINDER)
+    X(ADD_I)
+    X(SUBTRACT_I)
+    X(MULTIPLY_I)
+    X(DIVIDE_I)
+    X(REMAINDER_I)
+    X(OR)
+    X(AND)
+    X(XOR)
+    X(INVERT)
+    X(GT)
+    X(LT)
+    X(GTEQ)
+    X(LTEQ)
+    X(EQUALS)
+    X(NOT)
+    X(OR_I)
+    X(XOR_I)
+    X(JUMP)
+    X(BRANCH_IF_ZERO)
+    X(BRANCH_IF_NOT_ZERO)
+#undef X
+  }
+
+  return std::nullopt;
+}
+
+static bool has_operand(threaded_op operation) {
+  switch (operation) {
+  case threaded_op::HALT:
+  case threaded_op::NEGATE:
+  case threaded_op::INVERT:
+  case threaded_op::NOT:
+  case threaded_op::READ:
+  case threaded_op::WRITE:
+    return false;
+  default:
+    return true;
+  }
+}
+
+threaded_program::threaded_program(const program &prog,
+                                   std::uint64_t memory_size)
+    : prog(prog), blocks(prog) {
+  auto table = handler_table();
+  auto &code = this->prog.code;
+  auto size = code.size();
+
+  this->memory_size = std::max<std::uint64_t>(
+      memory_size, prog.data.size() + sizeof(std::int64_t));
+  check_addresses(this->prog, this->memory_size);
+
+  this->cell_of_pc.resize(size + 1);
+
+  auto push_handler = [&](threaded_op operation, std::uint64_t pc) {
+    this->cells.push_back({.handler = table[(size_t)operation]});
+    this->pc_of_cell.push_back(pc);
+  };
+
+  auto push_operand = [&](std::uint64_t operand, std::uint64_t pc) {
+    this->cells.push_back({.operand = operand});
+    this->pc_of_cell.push_back(pc);
+  };
+
+  for (std::uint64_t pc = 0; pc < size; ++pc) {
+    this->cell_of_pc[pc] = this->cells.size();
+
+    if (this->blocks.is_start(pc)) {
+      push_handler(threaded_op::BLOCK, pc);
+      push_operand(this->blocks.end(pc) - pc, pc);
+    }
+
+    auto &instruction = code[pc];
+    auto translated = translate(instruction);
+
+    if (!translated.has_value()) {
+      continue;
+    }
+
+    push_handler(translated.value(), pc);
+
+    if (!has_operand(translated.value())) {
+      continue;
+    }
+
+    auto operand = instruction.operands[0];
+
+    if (translated.value() == threaded_op::LOAD_I &&
+        instruction.operation != op::LOAD_I) {
+      // F_ ops
+      operand = 0xBAD;
+    }
+
+    push_operand(operand, pc);
+  }
+
+  this->cell_of_pc[size] = this->cells.size();
+  push_handler(threaded_op::HALT, size);
+
+  // Now that every cell is in place jumps can point to them
+  for (std::uint64_t pc = 0; pc < size; ++pc) {
+    auto &instruction = code[pc];
+
+    if (!is_jump(instruction.operation)) {
+      continue;
+    }
+
+    auto target = std::min(instruction.operands[0], size);
+    auto cell = this->cell_of_pc[pc] + (this->blocks.is_start(pc) ? 2 : 0);
+    this->cells[cell + 1].operand = this->cell_of_pc[target];
+  }
+}
+
+threaded_interpreter::threaded_interpreter(const threaded_program &code,
+                                           io_device &io)
+    : code(code), io(io), state(code.prog, code.memory_size) {}
+
+void threaded_interpreter::reset() { this->state.load(this->code.prog); }
+
+machine_state &threaded_interpreter::get_state() { return this->state; }
+
+exit_reason threaded_interpreter::run(std::uint64_t fuel) {
+  return execute(this->code, this->state, this->io, fuel);
+}
+
+exit_reason execute(const threaded_program &code, machine_state &state,
+                    io_device &io, std::uint64_t fuel) {
+  auto size = code.prog.code.size();
+
+  if (state.pc < size && !code.blocks.is_start(state.pc)) {
+    // Stopped in the middle of a block, so get to the next one the slow way
+    auto to_block_end = std::min(fuel, code.blocks.end(state.pc) - state.pc);
+    auto reason = execute(code.prog, state, io, to_block_end);
+
+    if (reason != exit_reason::OUT_OF_FUEL || to_block_end == fuel) {
+      return reason;
+    }
+
+    fuel -= to_block_end;
+  }
+
+  return run_threaded(&code, &state, &io, fuel, nullptr);
+}
+
+static exit_reason run_threaded(const threaded_program *code,
+                                machine_state *state, io_device *io,
+                                std::uint64_t fuel,
+                                const void *const **table_out) {
+#define X(Enum) &&t_##Enum,
+  static const void *const handlers[] = {THREADED_OPERATIONS};
+#undef X
+
+  if (code == nullptr) {
+    *table_out = handlers;
+    return exit_reason::HALTED;
+  }
+
+  const threaded_cell *base = code->cells.data();
+  auto *memory = state->memory.data();
+  const std::uint64_t memory_size = state->memory.size();
+
+  auto size = code->prog.code.size();
+  const threaded_cell *ip = base + code->cell_of_pc[std::min(state->pc, size)];
+  std::int64_t x = state->x;
+  std::uint64_t remaining = fuel;
+  std::uint64_t pc;
+  std::uint64_t refund;
+
+#define DISPATCH() goto *ip->handler
+#define OPERAND ((std::int64_t)ip[1].operand)
+#define MEMORY_OPERAND read_memory(memory, ip[1].operand)
+#define NEXT_1()                                                               \
+  ip += 1;                                                                     \
+  DISPATCH()
+#define NEXT_2()                                                               \
+  ip += 2;                                                                     \
+  DISPATCH()
+
+  DISPATCH();
+
+t_BLOCK:
+  if (ip[1].operand > remaining) {
+    goto partial_block;
+  }
+  remaining -= ip[1].operand;
+  NEXT_2();
+
+t_HALT:
+  state->pc = size;
+  state->x = x;
+  state->executed += fuel - remaining;
+  return exit_reason::HALTED;
+
+t_LOAD:
+  x = MEMORY_OPERAND;
+  NEXT_2();
+t_SET:
+  write_memory(memory, ip[1].operand, x);
+  NEXT_2();
+t_LOAD_I:
+  x = OPERAND;
+  NEXT_2();
+
+t_NEGATE:
+  x = wrapping_subtract(0, x);
+  NEXT_1();
+t_ADD:
+  x = wrapping_add(MEMORY_OPERAND, x);
+  NEXT_2();
+t_SUBTRACT:
+  x = wrapping_subtract(MEMORY_OPERAND, x);
+  NEXT_2();
+t_MULTIPLY:
+  x = wrapping_multiply(MEMORY_OPERAND, x);
+  NEXT_2();
+t_DIVIDE:
+  if (x == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_divide(MEMORY_OPERAND, x);
+  NEXT_2();
+t_REMAINDER:
+  if (x == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_remainder(MEMORY_OPERAND, x);
+  NEXT_2();
+
+t_ADD_I:
+  x = wrapping_add(x, OPERAND);
+  NEXT_2();
+t_SUBTRACT_I:
+  x = wrapping_subtract(x, OPERAND);
+  NEXT_2();
+t_MULTIPLY_I:
+  x = wrapping_multiply(x, OPERAND);
+  NEXT_2();
+t_DIVIDE_I:
+  if (OPERAND == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_divide(x, OPERAND);
+  NEXT_2();
+t_REMAINDER_I:
+  if (OPERAND == 0) {
+    goto division_by_zero;
+  }
+  x = wrapping_remainder(x, OPERAND);
+  NEXT_2();
+
+t_OR:
+  x = MEMORY_OPERAND | x;
+  NEXT_2();
+t_AND:
+  x = MEMORY_OPERAND & x;
+  NEXT_2();
+t_XOR:
+  x = MEMORY_OPERAND ^ x;
+  NEXT_2();
+t_INVERT:
+  x = ~x;
+  NEXT_1();
+
+t_GT:
+  x = MEMORY_OPERAND > x ? 1 : 0;
+  NEXT_2();
+t_LT:
+  x = MEMORY_OPERAND < x ? 1 : 0;
+  NEXT_2();
+t_GTEQ:
+  x = MEMORY_OPERAND >= x ? 1 : 0;
+  NEXT_2();
+t_LTEQ:
+  x = MEMORY_OPERAND <= x ? 1 : 0;
+  NEXT_2();
+t_EQUALS:
+  x = MEMORY_OPERAND == x ? 1 : 0;
+  NEXT_2();
+t_NOT:
+  x = x == 0 ? 1 : 0;
+  NEXT_1();
+
+t_OR_I:
+  x = x | OPERAND;
+  NEXT_2();
+t_AND_I:
+  x = x & OPERAND;
+  NEXT_2();
+t_XOR_I:
+  x = x ^ OPERAND;
+  NEXT_2();
+
+t_JUMP:
+  ip = base + ip[1].operand;
+  DISPATCH();
+t_BRANCH_IF_ZERO:
+  ip = x == 0 ? base + ip[1].operand : ip + 2;
+  DISPATCH();
+t_BRANCH_IF_NOT_ZERO:
+  ip = x != 0 ? base + ip[1].operand : ip + 2;
+  DISPATCH();
+
+t_READ: {
+  std::int64_t value;
+
+  if (!io->read(&value)) {
+    // READ is always the last of its block, so only it was charged for
+    state->pc = code->pc_of_cell[ip - base];
+    state->x = x;
+    state->executed += fuel - remaining - 1;
+    return exit_reason::WAITING_FOR_INPUT;
+  }
+
+  if ((std::uint64_t)x > memory_size - sizeof(std::int64_t)) {
+    goto out_of_bounds;
+  }
+
+  write_memory(memory, x, value);
+  NEXT_1();
+}
+t_WRITE:
+  io->write(x);
+  NEXT_1();
+
+#undef NEXT_2
+#undef NEXT_1
+#undef MEMORY_OPERAND
+#undef OPERAND
+#undef DISPATCH
+
+  // Not enough fuel for the whole block, so run what's left of it one
+  // instruction at a time
+partial_block:
+  state->pc = code->pc_of_cell[ip - base];
+  state->x = x;
+  state->executed += fuel - remaining;
+  return execute(code->prog, *state, *io, remaining);
+
+  // The whole block was charged for, but it only ran up to the faulting
+  // instruction
+division_by_zero:
+  pc = code->pc_of_cell[ip - base];
+  refund = code->blocks.end(pc) - pc;
+  state->pc = pc;
+  state->x = x;
+  state->executed += fuel - remaining - refund;
+  throw execution_error(format_division_by_zero(code->prog, pc), pc);
+
+out_of_bounds:
+  pc = code->pc_of_cell[ip - base];
+  refund = code->blocks.end(pc) - pc;
+  state->pc = pc;
+  state->x = x;
+  state->executed += fuel - remaining - refund;
+  throw execution_error(format_out_of_bounds(x, pc), pc);
+}
@@ -0,0 +1,58 @@
+#ifndef THREADED_H
+#define THREADED_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+// One word of direct-threaded code. Each handler address is followed by its
+// operand, if it has one
+union threaded_cell {
+  const void *handler;
+  std::uint64_t operand;
+};
+
+// A program translated once into a dense stream of handler addresses plus only
+// the operands that are actually used. It is read only after construction, so
+// one may be shared by any number of runs.
+//
+// Instructions are grouped in basic blocks. Each block starts with a header
+// cell that charges the fuel for the whole block at once, so the handlers
+// themselves don't have to count anything.
+class threaded_program {
+public:
+  // Kept for the initial data, the metadata and for running partial blocks
+  program prog;
+  std::uint64_t memory_size;
+
+  std::vector<threaded_cell> cells;
+  basic_blocks blocks;
+
+  // Has one more entry for the end of the program
+  std::vector<std::uint64_t> cell_of_pc;
+  std::vector<std::uint64_t> pc_of_cell;
+
+  threaded_program(const program &prog,
+                   std::uint64_t memory_size = default_memory_size);
+};
+
+// Runs a `threaded_program`. Same interface as `interpreter`
+class threaded_interpreter {
+private:
+  const threaded_program &code;
+  io_device &io;
+  machine_state state;
+
+public:
+  threaded_interpreter(const threaded_program &code, io_device &io);
+
+  void reset();
+  exit_reason run(std::uint64_t fuel = unlimited_fuel);
+
+  machine_state &get_state();
+};
+
+exit_reason execute(const threaded_program &code, machine_state &state,
+                    io_device &io, std::uint64_t fuel);
+
+#endif /* THREADED_H */
@@ -0,0 +1,194 @@
+#include "vm/time_travel.h"
+#include "vm/interpreter.h"
+#include <algorithm>
+
+time_travel_interpreter::replay_io::replay_io(time_travel_interpreter &owner)
+    : owner(owner) {}
+
+bool time_travel_interpreter::replay_io::read(std::int64_t *value) {
+  auto &owner = this->owner;
+
+  if (owner.next_read < owner.reads.size()) {
+    *value = owner.reads[owner.next_read++];
+    return true;
+  }
+
+  if (!owner.io.read(value)) {
+    return false;
+  }
+
+  owner.reads.push_back(*value);
+  ++owner.next_read;
+  return true;
+}
+
+void time_travel_interpreter::replay_io::write(std::int64_t value) {
+  auto &owner = this->owner;
+
+  // Already written the first time around
+  if (owner.next_write < owner.writes) {
+    ++owner.next_write;
+    return;
+  }
+
+  owner.io.write(value);
+  ++owner.writes;
+  ++owner.next_write;
+}
+
+time_travel_interpreter::time_travel_interpreter(
+    const program &prog, io_device &io, std::uint64_t checkpoint_interval,
+    std::uint64_t memory_size)
+    : prog(prog), io(io), replay(*this),
+      checkpoint_interval(std::max<std::uint64_t>(checkpoint_interval, 1)),
+      state(prog, memory_size) {
+  check_addresses(prog, this->state.memory.size());
+
+  this->is_statement_start.resize(prog.code.size(), false);
+  for (auto pc : prog.metadata.statement_boundaries) {
+    if (pc < prog.code.size()) {
+      this->is_statement_start[pc] = true;
+    }
+  }
+
+  this->reset();
+}
+
+void time_travel_interpreter::reset() {
+  this->state.load(this->prog);
+  this->checkpoints.clear();
+  this->reads.clear();
+  this->next_read = 0;
+  this->writes = 0;
+  this->next_write = 0;
+
+  this->save_checkpoint_if_due();
+}
+
+// Checkpoints are at every multiple of the interval, and positions before the
+// furthest one reached already have theirs
+void time_travel_interpreter::save_checkpoint_if_due() {
+  auto executed = this->state.executed;
+
+  if (executed % this->checkpoint_interval != 0 ||
+      executed / this->checkpoint_interval != this->checkpoints.size()) {
+    return;
+  }
+
+  auto &memory = this->state.memory;
+  auto end = memory.size();
+
+  // Most of the memory is usually never touched
+  while (end > 0 && memory[end - 1] == 0) {
+    --end;
+  }
+
+  checkpoint c;
+  c.executed = executed;
+  c.pc = this->state.pc;
+  c.x = this->state.x;
+  c.memory.assign(memory.begin(), memory.begin() + end);
+  c.reads = this->next_read;
+  c.writes = this->next_write;
+
+  this->checkpoints.push_back(std::move(c));
+}
+
+void time_travel_interpreter::restore_checkpoint(const checkpoint &c) {
+  auto &memory = this->state.memory;
+
+  this->state.pc = c.pc;
+  this->state.x = c.x;
+  this->state.executed = c.executed;
+
+  std::copy(c.memory.begin(), c.memory.end(), memory.begin());
+  std::fill(memory.begin() + c.memory.size(), memory.end(), 0);
+
+  this->next_read = c.reads;
+  this->next_write = c.writes;
+}
+
+// Somewhere that has been reached before
+void time_travel_interpreter::go_to(std::uint64_t executed) {
+  auto index = std::min<std::size_t>(executed / this->checkpoint_interval,
+                                     this->checkpoints.size() - 1);
+  auto &c = this->checkpoints[index];
+
+  this->restore_checkpoint(c);
+
+  // All of its input is recorded and it didn't fail the first time, so this
+  // runs all the way
+  execute(this->prog, this->state, this->replay, executed - c.executed);
+}
+
+exit_reason time_travel_interpreter::run(std::uint64_t fuel) {
+  auto remaining = fuel;
+
+  while (true) {
+    auto executed = this->state.executed;
+    auto until_checkpoint =
+        this->checkpoint_interval - executed % this->checkpoint_interval;
+
+    auto reason = execute(this->prog, this->state, this->replay,
+                          std::min(remaining, until_checkpoint));
+
+    remaining -= this->state.executed - executed;
+    this->save_checkpoint_if_due();
+
+    if (reason != exit_reason::OUT_OF_FUEL || remaining == 0) {
+      return reason;
+    }
+  }
+}
+
+void time_travel_interpreter::step_back(std::uint64_t count) {
+  auto executed = this->state.executed;
+  this->go_to(executed > count ? executed - count : 0);
+}
+
+void time_travel_interpreter::step_back_statement() {
+  auto now = this->state.executed;
+
+  if (now == 0) {
+    return;
+  }
+
+  // Goes through the instructions one by one from the checkpoint before,
+  // then the one before that if no statement started in between, and so on
+  auto index = std::min<std::size_t>((now - 1) / this->checkpoint_interval,
+                                     this->checkpoints.size() - 1);
+
+  while (true) {
+    this->restore_checkpoint(this->checkpoints[index]);
+
+    std::optional<std::uint64_t> found;
+
+    while (this->state.executed < now) {
+      if (this->state.pc < this->prog.code.size() &&
+          this->is_statement_start[this->state.pc]) {
+        found = this->state.executed;
+      }
+
+      execute(this->prog, this->state, this->replay, 1);
+    }
+
+    if (found.has_value()) {
+      this->go_to(found.value());
+      return;
+    }
+
+    if (index == 0) {
+      this->go_to(0);
+      return;
+    }
+
+    --index;
+    now = this->checkpoints[index + 1].executed;
+  }
+}
+
+machine_state &time_travel_interpreter::get_state() { return this->state; }
+
+std::size_t time_travel_interpreter::checkpoint_count() {
+  return this->checkpoints.size();
+}
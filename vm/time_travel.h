@@ -0,0 +1,84 @@
+#ifndef TIME_TRAVEL_H
+#define TIME_TRAVEL_H
+
+#include "synthesis/program.h"
+#include "vm/io.h"
+#include "vm/machine.h"
+
+const std::uint64_t default_checkpoint_interval = 4096;
+
+// Interpreter that can go backwards. Instead of remembering how to undo each
+// instruction, it saves the whole state every `checkpoint_interval`
+// instructions plus everything READ returned, so that any earlier point can be
+// reached by restoring the checkpoint before it and running forward again.
+//
+// After going back, running forward replays the recorded input and doesn't
+// repeat output until it gets past where it had been before.
+class time_travel_interpreter {
+private:
+  struct checkpoint {
+    std::uint64_t executed;
+    std::uint64_t pc;
+    std::int64_t x;
+    // Without the zeros at the end
+    std::vector<std::uint8_t> memory;
+
+    // How much of the input and output had gone by
+    std::size_t reads;
+    std::size_t writes;
+  };
+
+  // Between the machine and the real device
+  class replay_io : public io_device {
+  public:
+    time_travel_interpreter &owner;
+
+    replay_io(time_travel_interpreter &owner);
+
+    virtual bool read(std::int64_t *value);
+    virtual void write(std::int64_t value);
+  };
+
+  const program &prog;
+  io_device &io;
+  replay_io replay;
+  std::uint64_t checkpoint_interval;
+
+  machine_state state;
+  std::vector<checkpoint> checkpoints;
+  std::vector<bool> is_statement_start;
+
+  std::vector<std::int64_t> reads;
+  std::size_t next_read;
+  // Writes that made it to `io`
+  std::size_t writes;
+  std::size_t next_write;
+
+  void save_checkpoint_if_due();
+  void restore_checkpoint(const checkpoint &c);
+  void go_to(std::uint64_t executed);
+
+public:
+  time_travel_interpreter(
+      const program &prog, io_device &io,
+      std::uint64_t checkpoint_interval = default_checkpoint_interval,
+      std::uint64_t memory_size = default_memory_size);
+
+  // Back to the state right after loading, forgetting the history
+  void reset();
+
+  // Runs at most `fuel` instructions. May be called again to resume.
+  // Throws `execution_error` if the program does something illegal
+  exit_reason run(std::uint64_t fuel = unlimited_fuel);
+
+  // Back to where the machine was `count` instructions ago, or to the start
+  void step_back(std::uint64_t count = 1);
+
+  // Back to the start of the latest statement that began before now
+  void step_back_statement();
+
+  machine_state &get_state();
+  std::size_t checkpoint_count();
+};
+
+#endif /* TIME_TRAVEL_H */